@@ -0,0 +1,48 @@
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+
+#include "arm/media_fuzz.h"
+
+// Replays random operand sets through every batch kernel the CPU supports, for every instruction,
+// and compares them with the reference.
+//
+// Usage: arm_media_fuzz [operand sets per instruction and kernel] [seed]
+
+using namespace ARM;
+using namespace ARM::Media;
+
+int main(int argc, char** argv)
+{
+    const u64 count = argc > 1 ? strtoull(argv[1], nullptr, 0) : 1 << 20;
+    const u64 seed = argc > 2 ? strtoull(argv[2], nullptr, 0) : 0x12345678;
+
+    u64 failures = 0;
+    for (u32 k = 0; k < Pica::NUM_KERNELS; ++k) {
+        const Kernel kernel = (Kernel)k;
+        if (!Pica::IsSupported(kernel)) {
+            printf("%s: not supported, skipped\n", Pica::KernelName(kernel));
+            continue;
+        }
+
+        u64 kernel_failures = 0;
+        for (u32 o = 0; o < NUM_OPS; ++o) {
+            const Op op = (Op)o;
+            Mismatch first;
+            const u64 mismatches = Fuzz(kernel, op, seed, count, &first);
+            if (mismatches == 0)
+                continue;
+
+            printf("%s: %s: %" PRIu64 " of %" PRIu64 " operand sets differ, first: imm=%u rn=0x%08X rm=0x%08X "
+                   "ra=0x%08X: rd=0x%08X ge=0x%X, expected rd=0x%08X ge=0x%X\n",
+                   Pica::KernelName(kernel), OpName(op), mismatches, count, first.imm, first.rn, first.rm, first.ra,
+                   first.actual, first.actual_ge, first.expected, first.expected_ge);
+            kernel_failures += mismatches;
+        }
+
+        printf("%s: %u instructions, %" PRIu64 " operand sets each, %" PRIu64 " mismatches\n",
+               Pica::KernelName(kernel), NUM_OPS, count, kernel_failures);
+        failures += kernel_failures;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,292 @@
+#include "arm/media_kernels.h"
+
+namespace ARM {
+namespace Media {
+
+typedef std::int32_t s32;
+
+static const char* op_names[NUM_OPS] = {
+    "SADD16", "SASX", "SSAX", "SSUB16", "SADD8", "SSUB8",
+    "QADD16", "QASX", "QSAX", "QSUB16", "QADD8", "QSUB8",
+    "SHADD16", "SHASX", "SHSAX", "SHSUB16", "SHADD8", "SHSUB8",
+    "UADD16", "UASX", "USAX", "USUB16", "UADD8", "USUB8",
+    "UQADD16", "UQASX", "UQSAX", "UQSUB16", "UQADD8", "UQSUB8",
+    "UHADD16", "UHASX", "UHSAX", "UHSUB16", "UHADD8", "UHSUB8",
+    "USAD8", "USADA8",
+    "SXTB", "SXTH", "SXTB16", "UXTB", "UXTH", "UXTB16",
+    "SXTAB", "SXTAH", "SXTAB16", "UXTAB", "UXTAH", "UXTAB16",
+    "SEL", "PKHBT", "PKHTB", "REV", "REV16", "REVSH", "SSAT16", "USAT16",
+};
+
+const char* OpName(Op op)
+{
+    return op_names[(u32)op];
+}
+
+bool SetsGE(Op op)
+{
+    return ParallelSetsGE((u32)op);
+}
+
+bool ReadsRn(Op op)
+{
+    switch (op) {
+    case Op::SXTB: case Op::SXTH: case Op::SXTB16:
+    case Op::UXTB: case Op::UXTH: case Op::UXTB16:
+    case Op::REV: case Op::REV16: case Op::REVSH:
+        return false;
+    default:
+        return true;
+    }
+}
+
+bool ReadsRm(Op op)
+{
+    return op != Op::SSAT16 && op != Op::USAT16;
+}
+
+bool ReadsRa(Op op)
+{
+    return op == Op::USADA8 || op == Op::SEL;
+}
+
+// Lane `lane` of `value`, `bits` wide, sign or zero extended
+static s32 Lane(u32 value, u32 lane, u32 bits, bool is_signed)
+{
+    const u32 field = (value >> (lane * bits)) & ((1u << bits) - 1);
+    if (is_signed && (field >> (bits - 1)))
+        return (s32)field - (1 << bits);
+    return (s32)field;
+}
+
+static s32 Clamp(s32 value, s32 min, s32 max)
+{
+    return value < min ? min : value > max ? max : value;
+}
+
+// The ARM ARM's pseudocode for the parallel add and subtract instructions, one lane at a time:
+// every sum and difference is computed exactly, and then wrapped, saturated or halved.
+static u32 Parallel(Prefix prefix, Form form, u32 n, u32 m, u32* ge)
+{
+    const bool is_signed = prefix == PREFIX_S || prefix == PREFIX_Q || prefix == PREFIX_SH;
+    const u32 bits = (form == FORM_ADD8 || form == FORM_SUB8) ? 8 : 16;
+    const u32 lanes = 32 / bits;
+    const u32 ge_bits = 4 / lanes;
+
+    u32 result = 0;
+    u32 flags = 0;
+    for (u32 lane = 0; lane < lanes; ++lane) {
+        // ASX adds in the top halfword and subtracts in the bottom one, SAX the other way around,
+        // both with the halfwords of rm exchanged
+        const bool exchange = form == FORM_ASX || form == FORM_SAX;
+        const bool add = form == FORM_ADD16 || form == FORM_ADD8 || (form == FORM_ASX && lane == 1) ||
+                         (form == FORM_SAX && lane == 0);
+
+        const s32 a = Lane(n, lane, bits, is_signed);
+        const s32 b = Lane(m, exchange ? 1 - lane : lane, bits, is_signed);
+        s32 value = add ? a + b : a - b;
+
+        bool lane_ge = false;
+        switch (prefix) {
+        case PREFIX_S:
+            lane_ge = value >= 0;
+            break;
+        case PREFIX_U:
+            // Carry out of an addition, no borrow out of a subtraction
+            lane_ge = add ? value >= (1 << bits) : value >= 0;
+            break;
+        case PREFIX_Q:
+            value = Clamp(value, -(1 << (bits - 1)), (1 << (bits - 1)) - 1);
+            break;
+        case PREFIX_UQ:
+            value = Clamp(value, 0, (1 << bits) - 1);
+            break;
+        case PREFIX_SH:
+        case PREFIX_UH:
+            // Halved before truncating, rounding towards minus infinity
+            value = value >= 0 ? value / 2 : -((-value + 1) / 2);
+            break;
+        }
+
+        result |= ((u32)value & ((1u << bits) - 1)) << (lane * bits);
+        if (lane_ge)
+            flags |= ((1u << ge_bits) - 1) << (lane * ge_bits);
+    }
+
+    if (ge != nullptr && (prefix == PREFIX_S || prefix == PREFIX_U))
+        *ge = flags;
+    return result;
+}
+
+static u32 RotateRight(u32 value, u32 amount)
+{
+    return amount == 0 ? value : (value >> amount) | (value << (32 - amount));
+}
+
+static u32 SignExtend(u32 value, u32 bits)
+{
+    return (u32)Lane(value, 0, bits, true);
+}
+
+static u32 ByteSwap(u32 value)
+{
+    return (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24);
+}
+
+// Saturates both halfwords of `value`, signed to `bits` bits or unsigned to `bits` bits
+static u32 Saturate16(u32 value, u32 bits, bool is_signed)
+{
+    u32 result = 0;
+    for (u32 lane = 0; lane < 2; ++lane) {
+        const s32 half = Lane(value, lane, 16, true);
+        const s32 saturated = is_signed ? Clamp(half, -(1 << (bits - 1)), (1 << (bits - 1)) - 1)
+                                        : Clamp(half, 0, (1 << bits) - 1);
+        result |= ((u32)saturated & 0xFFFF) << (lane * 16);
+    }
+    return result;
+}
+
+static inline u32 Reference(Op op, u32 n, u32 m, u32 a, u32 imm, u32* ge)
+{
+    if (IsParallel((u32)op))
+        return Parallel(PrefixOf((u32)op), FormOf((u32)op), n, m, ge);
+
+    const u32 rotated = RotateRight(m, imm & 24);
+    const u32 byte0 = rotated & 0xFF;
+    const u32 byte2 = (rotated >> 16) & 0xFF;
+
+    switch (op) {
+    case Op::USAD8:
+    case Op::USADA8: {
+        u32 sum = op == Op::USADA8 ? a : 0;
+        for (u32 lane = 0; lane < 4; ++lane) {
+            const s32 difference = Lane(n, lane, 8, false) - Lane(m, lane, 8, false);
+            sum += difference < 0 ? -difference : difference;
+        }
+        return sum;
+    }
+
+    case Op::SXTB:
+        return SignExtend(rotated, 8);
+    case Op::SXTH:
+        return SignExtend(rotated, 16);
+    case Op::SXTB16:
+        return (SignExtend(byte0, 8) & 0xFFFF) | (SignExtend(byte2, 8) << 16);
+    case Op::UXTB:
+        return byte0;
+    case Op::UXTH:
+        return rotated & 0xFFFF;
+    case Op::UXTB16:
+        return byte0 | (byte2 << 16);
+    case Op::SXTAB:
+        return n + SignExtend(rotated, 8);
+    case Op::SXTAH:
+        return n + SignExtend(rotated, 16);
+    case Op::SXTAB16:
+        return ((n + SignExtend(byte0, 8)) & 0xFFFF) | (((n >> 16) + SignExtend(byte2, 8)) << 16);
+    case Op::UXTAB:
+        return n + byte0;
+    case Op::UXTAH:
+        return n + (rotated & 0xFFFF);
+    case Op::UXTAB16:
+        return ((n + byte0) & 0xFFFF) | (((n >> 16) + byte2) << 16);
+
+    case Op::SEL: {
+        u32 result = 0;
+        for (u32 lane = 0; lane < 4; ++lane)
+            result |= (((a >> lane) & 1) ? n : m) & (0xFFu << (lane * 8));
+        return result;
+    }
+    case Op::PKHBT:
+        return (n & 0xFFFF) | ((m << (imm & 31)) & 0xFFFF0000);
+    case Op::PKHTB: {
+        const u32 shift = (imm & 31) == 0 ? 32 : imm & 31;
+        const u32 shifted = shift == 32 ? (u32)((s32)m >> 31) : (u32)((s32)m >> shift);
+        return (n & 0xFFFF0000) | (shifted & 0xFFFF);
+    }
+    case Op::REV:
+        return ByteSwap(m);
+    case Op::REV16:
+        return RotateRight(ByteSwap(m), 16);
+    case Op::REVSH:
+        return SignExtend(ByteSwap(m) >> 16, 16);
+    case Op::SSAT16:
+        return Saturate16(n, ((imm - 1) & 15) + 1, true);
+    case Op::USAT16:
+        return Saturate16(n, imm & 15, false);
+    default:
+        return 0;
+    }
+}
+
+u32 Execute(Op op, u32 rn, u32 rm, u32 ra, u32 imm, u32* ge)
+{
+    return Reference(op, rn, rm, ra, imm, ge);
+}
+
+void BatchScalar(Op op, u32 imm, const u32* rn, const u32* rm, const u32* ra, u32* rd, u8* ge, size_t begin,
+                 size_t end)
+{
+    for (size_t i = begin; i < end; ++i) {
+        u32 flags = 0;
+        rd[i] = Reference(op, rn ? rn[i] : 0, rm ? rm[i] : 0, ra ? ra[i] : 0, imm, &flags);
+        if (ge != nullptr && SetsGE(op))
+            ge[i] = flags;
+    }
+}
+
+namespace {
+
+// The reference with `op` known at compile time, so that the compiler can drop the other cases
+template <u32 op>
+struct Scalar {
+    static void Run(u32 imm, const u32* rn, const u32* rm, const u32* ra, u32* rd, u8* ge, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            u32 flags = 0;
+            rd[i] = Reference((Op)op, rn ? rn[i] : 0, rm ? rm[i] : 0, ra ? ra[i] : 0, imm, &flags);
+            if (ge != nullptr && ParallelSetsGE(op))
+                ge[i] = flags;
+        }
+    }
+};
+
+} // namespace
+
+const Kernels scalar_kernels = BuildTable<Scalar>();
+
+#if !defined(__x86_64__) && !defined(__i386__)
+const Kernels* const sse41_kernels = nullptr;
+const Kernels* const avx2_kernels = nullptr;
+#endif
+
+static const Kernels* GetKernels(Kernel kernel)
+{
+    switch (kernel) {
+    case Kernel::Vector:
+        return &vector_kernels;
+    case Kernel::SSE41:
+        return sse41_kernels;
+    case Kernel::AVX2:
+        return avx2_kernels;
+    default:
+        return &scalar_kernels;
+    }
+}
+
+void ExecuteBatch(Kernel kernel, Op op, u32 imm, const u32* rn, const u32* rm, const u32* ra, u32* rd, u8* ge,
+                  size_t count)
+{
+    const Kernels* kernels = GetKernels(kernel);
+    if (kernels == nullptr)
+        kernels = &scalar_kernels;
+    kernels->ops[(u32)op](imm, rn, rm, ra, rd, ge, count);
+}
+
+void ExecuteBatch(Op op, u32 imm, const u32* rn, const u32* rm, const u32* ra, u32* rd, u8* ge, size_t count)
+{
+    ExecuteBatch(Pica::BestKernel(), op, imm, rn, rm, ra, rd, ge, count);
+}
+
+} // namespace
+} // namespace
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "pica/kernel.h"
+
+/**
+ * The ARMv6 SIMD ("media") instructions of the 3DS's ARM11, as a reference that runs on the host,
+ * checked against the results recorded by CPU::Integer in hwtests.
+ *
+ * Execute() is the reference: one instruction at a time, written for clarity. ExecuteBatch() runs
+ * one instruction over arrays of operands, with the kernels of pica/kernel.h, and gives the same
+ * results; Fuzz() in arm/media_fuzz.h compares the two.
+ *
+ * Operands are named as in the ARM ARM: "QADD16 rd, rn, rm". Instructions that do not take rn or
+ * ra ignore them. `imm` is the instruction's immediate, as written in assembly: the rotation of
+ * the extend instructions (0, 8, 16 or 24), the shift of PKHBT and PKHTB (0-31, where PKHTB's 0
+ * means ASR #32, as encoded), and the bit count of SSAT16 (1-16) and USAT16 (0-15). Values out of
+ * range are masked as the encodings would.
+ *
+ * GE flags are the four bits of the CPSR's GE field, bit 0 for the lowest byte. Instructions that
+ * set them return them through `ge`; SEL reads them from the low bits of ra. The Q flag is not
+ * modelled.
+ */
+
+namespace ARM {
+
+using Pica::u8;
+using Pica::u32;
+using Pica::u64;
+using Pica::Kernel;
+
+namespace Media {
+
+enum class Op : u32 {
+    // Parallel add and subtract: every prefix with every form, in this order
+    SADD16, SASX, SSAX, SSUB16, SADD8, SSUB8,
+    QADD16, QASX, QSAX, QSUB16, QADD8, QSUB8,
+    SHADD16, SHASX, SHSAX, SHSUB16, SHADD8, SHSUB8,
+    UADD16, UASX, USAX, USUB16, UADD8, USUB8,
+    UQADD16, UQASX, UQSAX, UQSUB16, UQADD8, UQSUB8,
+    UHADD16, UHASX, UHSAX, UHSUB16, UHADD8, UHSUB8,
+    // Sums of absolute differences
+    USAD8, USADA8,
+    // Extends, with an optional rotation of rm
+    SXTB, SXTH, SXTB16, UXTB, UXTH, UXTB16,
+    SXTAB, SXTAH, SXTAB16, UXTAB, UXTAH, UXTAB16,
+    // Everything else
+    SEL, PKHBT, PKHTB, REV, REV16, REVSH, SSAT16, USAT16,
+};
+
+static const u32 NUM_OPS = 58;
+
+const char* OpName(Op op);
+
+/// Whether `op` sets the GE flags.
+bool SetsGE(Op op);
+
+/// Runs one instruction and returns rd. If `op` sets the GE flags and `ge` is not nullptr, writes them to `*ge`.
+u32 Execute(Op op, u32 rn, u32 rm, u32 ra, u32 imm, u32* ge = nullptr);
+
+/// Which of rn, rm and ra `op` reads.
+bool ReadsRn(Op op);
+bool ReadsRm(Op op);
+bool ReadsRa(Op op);
+
+/**
+ * Runs `op` on `count` operand sets: rd[i] = Execute(op, rn[i], rm[i], ra[i], imm, &ge[i]).
+ * Operands `op` does not read may be nullptr, and so may ge if the flags are not needed.
+ */
+void ExecuteBatch(Op op, u32 imm, const u32* rn, const u32* rm, const u32* ra, u32* rd, u8* ge, size_t count);
+void ExecuteBatch(Kernel kernel, Op op, u32 imm, const u32* rn, const u32* rm, const u32* ra, u32* rd, u8* ge,
+                  size_t count);
+
+} // namespace
+} // namespace
@@ -0,0 +1,132 @@
+#include <immintrin.h>
+
+#include "arm/media_vector.h"
+
+// Built with -mavx2. Only called once IsSupported() has checked the CPU.
+
+namespace ARM {
+namespace Media {
+
+typedef u32 U32x8 __attribute__((vector_size(32)));
+typedef s32 S32x8 __attribute__((vector_size(32)));
+
+// One instruction on eight operand sets
+typedef __m256i (*Func)(__m256i n, __m256i m, __m256i a);
+
+template <u32 op, Func func>
+static void Batch(u32 imm, const u32* rn, const u32* rm, const u32* ra, u32* rd, u8* ge, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i n = rn ? _mm256_loadu_si256((const __m256i*)(rn + i)) : _mm256_setzero_si256();
+        const __m256i m = rm ? _mm256_loadu_si256((const __m256i*)(rm + i)) : _mm256_setzero_si256();
+        const __m256i a = ra ? _mm256_loadu_si256((const __m256i*)(ra + i)) : _mm256_setzero_si256();
+        _mm256_storeu_si256((__m256i*)(rd + i), func(n, m, a));
+    }
+    BatchScalar((Op)op, imm, rn, rm, ra, rd, ge, i, count);
+}
+
+// The saturating instructions are those of AVX2, halfword or byte wise
+static __m256i QAdd16(__m256i n, __m256i m, __m256i) { return _mm256_adds_epi16(n, m); }
+static __m256i QSub16(__m256i n, __m256i m, __m256i) { return _mm256_subs_epi16(n, m); }
+static __m256i QAdd8(__m256i n, __m256i m, __m256i) { return _mm256_adds_epi8(n, m); }
+static __m256i QSub8(__m256i n, __m256i m, __m256i) { return _mm256_subs_epi8(n, m); }
+static __m256i UQAdd16(__m256i n, __m256i m, __m256i) { return _mm256_adds_epu16(n, m); }
+static __m256i UQSub16(__m256i n, __m256i m, __m256i) { return _mm256_subs_epu16(n, m); }
+static __m256i UQAdd8(__m256i n, __m256i m, __m256i) { return _mm256_adds_epu8(n, m); }
+static __m256i UQSub8(__m256i n, __m256i m, __m256i) { return _mm256_subs_epu8(n, m); }
+
+// The exchanging forms swap the halfwords of rm, and take the top halfwords of the sum (ASX) or
+// the difference (SAX)
+static __m256i Exchange(__m256i m)
+{
+    return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(m, 0xB1), 0xB1);
+}
+
+static __m256i QAsx(__m256i n, __m256i m, __m256i)
+{
+    m = Exchange(m);
+    return _mm256_blend_epi16(_mm256_subs_epi16(n, m), _mm256_adds_epi16(n, m), 0xAA);
+}
+
+static __m256i QSax(__m256i n, __m256i m, __m256i)
+{
+    m = Exchange(m);
+    return _mm256_blend_epi16(_mm256_adds_epi16(n, m), _mm256_subs_epi16(n, m), 0xAA);
+}
+
+static __m256i UQAsx(__m256i n, __m256i m, __m256i)
+{
+    m = Exchange(m);
+    return _mm256_blend_epi16(_mm256_subs_epu16(n, m), _mm256_adds_epu16(n, m), 0xAA);
+}
+
+static __m256i UQSax(__m256i n, __m256i m, __m256i)
+{
+    m = Exchange(m);
+    return _mm256_blend_epi16(_mm256_adds_epu16(n, m), _mm256_subs_epu16(n, m), 0xAA);
+}
+
+// Absolute differences of the bytes, summed in pairs and then in pairs of pairs
+static __m256i Usad8(__m256i n, __m256i m, __m256i)
+{
+    const __m256i difference = _mm256_or_si256(_mm256_subs_epu8(n, m), _mm256_subs_epu8(m, n));
+    return _mm256_madd_epi16(_mm256_maddubs_epi16(difference, _mm256_set1_epi8(1)), _mm256_set1_epi16(1));
+}
+
+static __m256i Usada8(__m256i n, __m256i m, __m256i a)
+{
+    return _mm256_add_epi32(Usad8(n, m, a), a);
+}
+
+// GE bit i of each element's ra selects byte i of rn over that of rm
+static __m256i Sel(__m256i n, __m256i m, __m256i a)
+{
+    const __m256i bits = _mm256_set1_epi32(0x08040201);
+    const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 4, 4, 4, 4, 8, 8, 8, 8, 12, 12, 12, 12,
+                                            0, 0, 0, 0, 4, 4, 4, 4, 8, 8, 8, 8, 12, 12, 12, 12);
+    const __m256i flags = _mm256_shuffle_epi8(a, spread);
+    return _mm256_blendv_epi8(m, n, _mm256_cmpeq_epi8(_mm256_and_si256(flags, bits), bits));
+}
+
+static __m256i Rev(__m256i, __m256i m, __m256i)
+{
+    return _mm256_shuffle_epi8(m, _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                                   3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+}
+
+static __m256i Rev16(__m256i, __m256i m, __m256i)
+{
+    return _mm256_shuffle_epi8(m, _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                                   1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14));
+}
+
+static Kernels BuildKernels()
+{
+    Kernels kernels = BuildTable<VectorOps<U32x8, S32x8>::Batch>();
+    kernels.ops[(u32)Op::QADD16] = Batch<(u32)Op::QADD16, QAdd16>;
+    kernels.ops[(u32)Op::QASX] = Batch<(u32)Op::QASX, QAsx>;
+    kernels.ops[(u32)Op::QSAX] = Batch<(u32)Op::QSAX, QSax>;
+    kernels.ops[(u32)Op::QSUB16] = Batch<(u32)Op::QSUB16, QSub16>;
+    kernels.ops[(u32)Op::QADD8] = Batch<(u32)Op::QADD8, QAdd8>;
+    kernels.ops[(u32)Op::QSUB8] = Batch<(u32)Op::QSUB8, QSub8>;
+    kernels.ops[(u32)Op::UQADD16] = Batch<(u32)Op::UQADD16, UQAdd16>;
+    kernels.ops[(u32)Op::UQASX] = Batch<(u32)Op::UQASX, UQAsx>;
+    kernels.ops[(u32)Op::UQSAX] = Batch<(u32)Op::UQSAX, UQSax>;
+    kernels.ops[(u32)Op::UQSUB16] = Batch<(u32)Op::UQSUB16, UQSub16>;
+    kernels.ops[(u32)Op::UQADD8] = Batch<(u32)Op::UQADD8, UQAdd8>;
+    kernels.ops[(u32)Op::UQSUB8] = Batch<(u32)Op::UQSUB8, UQSub8>;
+    kernels.ops[(u32)Op::USAD8] = Batch<(u32)Op::USAD8, Usad8>;
+    kernels.ops[(u32)Op::USADA8] = Batch<(u32)Op::USADA8, Usada8>;
+    kernels.ops[(u32)Op::SEL] = Batch<(u32)Op::SEL, Sel>;
+    kernels.ops[(u32)Op::REV] = Batch<(u32)Op::REV, Rev>;
+    kernels.ops[(u32)Op::REV16] = Batch<(u32)Op::REV16, Rev16>;
+    return kernels;
+}
+
+static const Kernels kernels = BuildKernels();
+
+const Kernels* const avx2_kernels = &kernels;
+
+} // namespace
+} // namespace
@@ -0,0 +1,78 @@
+#include <vector>
+
+#include "arm/media_fuzz.h"
+
+namespace ARM {
+namespace Media {
+
+// SplitMix64
+static u64 Next(u64& state)
+{
+    u64 z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static u32 Operand(u64& state)
+{
+    static const u8 edges[] = { 0x00, 0x01, 0x7E, 0x7F, 0x80, 0x81, 0xFE, 0xFF };
+
+    const u64 bits = Next(state);
+    if (bits & 1)
+        return (u32)(bits >> 32);
+
+    u32 word = 0;
+    for (u32 lane = 0; lane < 4; ++lane) {
+        const u32 choice = (bits >> (1 + lane * 8)) & 0xFF;
+        const u32 byte = (choice & 1) ? (u32)(bits >> (32 + lane * 8)) & 0xFF : edges[(choice >> 1) % 8];
+        word |= byte << (lane * 8);
+    }
+    return word;
+}
+
+// Longest batch, chosen so that most batches leave a tail for the scalar code
+static const u32 MAX_BATCH = 1021;
+
+// Left in the flags of instructions that do not set them
+static const u8 NO_FLAGS = 0xCC;
+
+u64 Fuzz(Kernel kernel, Op op, u64 seed, u64 count, Mismatch* first)
+{
+    std::vector<u32> rn(MAX_BATCH), rm(MAX_BATCH), ra(MAX_BATCH), rd(MAX_BATCH);
+    std::vector<u8> ge(MAX_BATCH);
+
+    u64 state = seed ^ ((u64)op << 32);
+    u64 mismatches = 0;
+
+    while (count != 0) {
+        const u64 batch = Next(state) % MAX_BATCH + 1;
+        const u32 length = (u32)(batch < count ? batch : count);
+        const u32 imm = (u32)Next(state) & 31;
+        for (u32 i = 0; i < length; ++i) {
+            rn[i] = Operand(state);
+            rm[i] = Operand(state);
+            ra[i] = Operand(state);
+            ge[i] = NO_FLAGS;
+        }
+
+        // Operands the instruction does not read are left out, as callers may
+        ExecuteBatch(kernel, op, imm, ReadsRn(op) ? rn.data() : nullptr, ReadsRm(op) ? rm.data() : nullptr,
+                     ReadsRa(op) ? ra.data() : nullptr, rd.data(), ge.data(), length);
+
+        for (u32 i = 0; i < length; ++i) {
+            u32 expected_ge = NO_FLAGS;
+            const u32 expected = Execute(op, rn[i], rm[i], ra[i], imm, &expected_ge);
+            if (rd[i] == expected && ge[i] == expected_ge)
+                continue;
+
+            if (mismatches++ == 0 && first != nullptr)
+                *first = { op, imm, rn[i], rm[i], ra[i], expected, rd[i], expected_ge, ge[i] };
+        }
+        count -= length;
+    }
+    return mismatches;
+}
+
+} // namespace
+} // namespace
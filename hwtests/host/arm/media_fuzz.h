@@ -0,0 +1,31 @@
+#pragma once
+
+#include "arm/media.h"
+
+/**
+ * Differential fuzzing of the batch kernels against the reference. Operands mix random words with
+ * words whose bytes sit at the edges of their ranges (0x00, 0x7F, 0x80, 0xFF, ...), where
+ * halfwords and bytes saturate, carry and change sign. The same seed gives the same operands.
+ */
+
+namespace ARM {
+namespace Media {
+
+/// An operand set for which a kernel and the reference disagree.
+struct Mismatch {
+    Op op;
+    u32 imm;
+    u32 rn, rm, ra;
+    u32 expected, actual;
+    u32 expected_ge, actual_ge;
+};
+
+/**
+ * Runs `count` operand sets through ExecuteBatch() with `kernel` and through Execute(), in batches
+ * of varying length, with a random immediate for each. Returns how many disagree, and the first
+ * of them in `first` if it is not nullptr.
+ */
+u64 Fuzz(Kernel kernel, Op op, u64 seed, u64 count, Mismatch* first);
+
+} // namespace
+} // namespace
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "arm/media.h"
+
+// Internal to the media instruction library: the kernels of each instruction set, one function per
+// instruction. Each only reads the operands its instruction reads.
+
+namespace ARM {
+namespace Media {
+
+typedef void (*BatchFunc)(u32 imm, const u32* rn, const u32* rm, const u32* ra, u32* rd, u8* ge, size_t count);
+
+struct Kernels {
+    BatchFunc ops[NUM_OPS];
+};
+
+extern const Kernels scalar_kernels;
+extern const Kernels vector_kernels;
+// nullptr if not built for this target
+extern const Kernels* const sse41_kernels;
+extern const Kernels* const avx2_kernels;
+
+// The parallel add and subtract instructions come first in Op, six forms for each prefix
+static const u32 NUM_PARALLEL_OPS = 36;
+
+enum Prefix { PREFIX_S, PREFIX_Q, PREFIX_SH, PREFIX_U, PREFIX_UQ, PREFIX_UH };
+enum Form { FORM_ADD16, FORM_ASX, FORM_SAX, FORM_SUB16, FORM_ADD8, FORM_SUB8 };
+
+constexpr Prefix PrefixOf(u32 op)
+{
+    return (Prefix)(op / 6);
+}
+
+constexpr Form FormOf(u32 op)
+{
+    return (Form)(op % 6);
+}
+
+constexpr bool IsParallel(u32 op)
+{
+    return op < NUM_PARALLEL_OPS;
+}
+
+constexpr bool ParallelSetsGE(u32 op)
+{
+    return IsParallel(op) && (PrefixOf(op) == PREFIX_S || PrefixOf(op) == PREFIX_U);
+}
+
+// Fills a table with Batch<0>::Run ... Batch<NUM_OPS - 1>::Run
+template <template <u32> class Batch, u32 op = 0>
+struct TableBuilder {
+    static void Fill(Kernels& kernels)
+    {
+        kernels.ops[op] = Batch<op>::Run;
+        TableBuilder<Batch, op + 1>::Fill(kernels);
+    }
+};
+
+template <template <u32> class Batch>
+struct TableBuilder<Batch, NUM_OPS> {
+    static void Fill(Kernels&) {}
+};
+
+template <template <u32> class Batch>
+Kernels BuildTable()
+{
+    Kernels kernels;
+    TableBuilder<Batch>::Fill(kernels);
+    return kernels;
+}
+
+// Runs operand sets [begin, end) with the reference. Also used for the tails the vector kernels leave.
+void BatchScalar(Op op, u32 imm, const u32* rn, const u32* rm, const u32* ra, u32* rd, u8* ge, size_t begin,
+                 size_t end);
+
+} // namespace
+} // namespace
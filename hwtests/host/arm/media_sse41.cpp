@@ -0,0 +1,128 @@
+#include <smmintrin.h>
+
+#include "arm/media_vector.h"
+
+// Built with -msse4.1. Only called once IsSupported() has checked the CPU.
+
+namespace ARM {
+namespace Media {
+
+typedef u32 U32x4 __attribute__((vector_size(16)));
+typedef s32 S32x4 __attribute__((vector_size(16)));
+
+// One instruction on four operand sets
+typedef __m128i (*Func)(__m128i n, __m128i m, __m128i a);
+
+template <u32 op, Func func>
+static void Batch(u32 imm, const u32* rn, const u32* rm, const u32* ra, u32* rd, u8* ge, size_t count)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i n = rn ? _mm_loadu_si128((const __m128i*)(rn + i)) : _mm_setzero_si128();
+        const __m128i m = rm ? _mm_loadu_si128((const __m128i*)(rm + i)) : _mm_setzero_si128();
+        const __m128i a = ra ? _mm_loadu_si128((const __m128i*)(ra + i)) : _mm_setzero_si128();
+        _mm_storeu_si128((__m128i*)(rd + i), func(n, m, a));
+    }
+    BatchScalar((Op)op, imm, rn, rm, ra, rd, ge, i, count);
+}
+
+// The saturating instructions are those of SSE2, halfword or byte wise
+static __m128i QAdd16(__m128i n, __m128i m, __m128i) { return _mm_adds_epi16(n, m); }
+static __m128i QSub16(__m128i n, __m128i m, __m128i) { return _mm_subs_epi16(n, m); }
+static __m128i QAdd8(__m128i n, __m128i m, __m128i) { return _mm_adds_epi8(n, m); }
+static __m128i QSub8(__m128i n, __m128i m, __m128i) { return _mm_subs_epi8(n, m); }
+static __m128i UQAdd16(__m128i n, __m128i m, __m128i) { return _mm_adds_epu16(n, m); }
+static __m128i UQSub16(__m128i n, __m128i m, __m128i) { return _mm_subs_epu16(n, m); }
+static __m128i UQAdd8(__m128i n, __m128i m, __m128i) { return _mm_adds_epu8(n, m); }
+static __m128i UQSub8(__m128i n, __m128i m, __m128i) { return _mm_subs_epu8(n, m); }
+
+// The exchanging forms swap the halfwords of rm, and take the top halfwords of the sum (ASX) or
+// the difference (SAX)
+static __m128i Exchange(__m128i m)
+{
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(m, 0xB1), 0xB1);
+}
+
+static __m128i QAsx(__m128i n, __m128i m, __m128i)
+{
+    m = Exchange(m);
+    return _mm_blend_epi16(_mm_subs_epi16(n, m), _mm_adds_epi16(n, m), 0xAA);
+}
+
+static __m128i QSax(__m128i n, __m128i m, __m128i)
+{
+    m = Exchange(m);
+    return _mm_blend_epi16(_mm_adds_epi16(n, m), _mm_subs_epi16(n, m), 0xAA);
+}
+
+static __m128i UQAsx(__m128i n, __m128i m, __m128i)
+{
+    m = Exchange(m);
+    return _mm_blend_epi16(_mm_subs_epu16(n, m), _mm_adds_epu16(n, m), 0xAA);
+}
+
+static __m128i UQSax(__m128i n, __m128i m, __m128i)
+{
+    m = Exchange(m);
+    return _mm_blend_epi16(_mm_adds_epu16(n, m), _mm_subs_epu16(n, m), 0xAA);
+}
+
+// Absolute differences of the bytes, summed in pairs and then in pairs of pairs
+static __m128i Usad8(__m128i n, __m128i m, __m128i)
+{
+    const __m128i difference = _mm_or_si128(_mm_subs_epu8(n, m), _mm_subs_epu8(m, n));
+    return _mm_madd_epi16(_mm_maddubs_epi16(difference, _mm_set1_epi8(1)), _mm_set1_epi16(1));
+}
+
+static __m128i Usada8(__m128i n, __m128i m, __m128i a)
+{
+    return _mm_add_epi32(Usad8(n, m, a), a);
+}
+
+// GE bit i of each element's ra selects byte i of rn over that of rm
+static __m128i Sel(__m128i n, __m128i m, __m128i a)
+{
+    const __m128i bits = _mm_set1_epi32(0x08040201);
+    const __m128i flags = _mm_shuffle_epi8(a, _mm_set_epi8(12, 12, 12, 12, 8, 8, 8, 8, 4, 4, 4, 4, 0, 0, 0, 0));
+    return _mm_blendv_epi8(m, n, _mm_cmpeq_epi8(_mm_and_si128(flags, bits), bits));
+}
+
+static __m128i Rev(__m128i, __m128i m, __m128i)
+{
+    return _mm_shuffle_epi8(m, _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3));
+}
+
+static __m128i Rev16(__m128i, __m128i m, __m128i)
+{
+    return _mm_shuffle_epi8(m, _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1));
+}
+
+static Kernels BuildKernels()
+{
+    Kernels kernels = BuildTable<VectorOps<U32x4, S32x4>::Batch>();
+    kernels.ops[(u32)Op::QADD16] = Batch<(u32)Op::QADD16, QAdd16>;
+    kernels.ops[(u32)Op::QASX] = Batch<(u32)Op::QASX, QAsx>;
+    kernels.ops[(u32)Op::QSAX] = Batch<(u32)Op::QSAX, QSax>;
+    kernels.ops[(u32)Op::QSUB16] = Batch<(u32)Op::QSUB16, QSub16>;
+    kernels.ops[(u32)Op::QADD8] = Batch<(u32)Op::QADD8, QAdd8>;
+    kernels.ops[(u32)Op::QSUB8] = Batch<(u32)Op::QSUB8, QSub8>;
+    kernels.ops[(u32)Op::UQADD16] = Batch<(u32)Op::UQADD16, UQAdd16>;
+    kernels.ops[(u32)Op::UQASX] = Batch<(u32)Op::UQASX, UQAsx>;
+    kernels.ops[(u32)Op::UQSAX] = Batch<(u32)Op::UQSAX, UQSax>;
+    kernels.ops[(u32)Op::UQSUB16] = Batch<(u32)Op::UQSUB16, UQSub16>;
+    kernels.ops[(u32)Op::UQADD8] = Batch<(u32)Op::UQADD8, UQAdd8>;
+    kernels.ops[(u32)Op::UQSUB8] = Batch<(u32)Op::UQSUB8, UQSub8>;
+    kernels.ops[(u32)Op::USAD8] = Batch<(u32)Op::USAD8, Usad8>;
+    kernels.ops[(u32)Op::USADA8] = Batch<(u32)Op::USADA8, Usada8>;
+    kernels.ops[(u32)Op::SEL] = Batch<(u32)Op::SEL, Sel>;
+    kernels.ops[(u32)Op::REV] = Batch<(u32)Op::REV, Rev>;
+    kernels.ops[(u32)Op::REV16] = Batch<(u32)Op::REV16, Rev16>;
+    return kernels;
+}
+
+static const Kernels kernels = BuildKernels();
+
+const Kernels* const sse41_kernels = &kernels;
+
+} // namespace
+} // namespace
@@ -0,0 +1,12 @@
+#include "arm/media_vector.h"
+
+namespace ARM {
+namespace Media {
+
+typedef u32 U32x4 __attribute__((vector_size(16)));
+typedef s32 S32x4 __attribute__((vector_size(16)));
+
+const Kernels vector_kernels = BuildTable<VectorOps<U32x4, S32x4>::Batch>();
+
+} // namespace
+} // namespace
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <cstring>
+
+#include "arm/media_kernels.h"
+
+// Internal to the media instruction library: every instruction written once with GCC vector
+// extensions, over vectors of any width. media_vector.cpp builds it for 16 byte vectors, which
+// become NEON on ARM and SSE2 on x86; media_sse41.cpp and media_avx2.cpp build it again with their
+// instruction sets enabled, and replace the instructions those sets have a better way to do.
+//
+// Each lane holds one operand set. Halfwords and bytes are unpacked into lanes of their own,
+// sign or zero extended, so the sums and differences are exact, as in the reference.
+//
+// Everything here is local to the file that includes it, so that code built for one instruction
+// set can not be linked into a kernel for another.
+
+namespace ARM {
+namespace Media {
+namespace {
+
+typedef std::int32_t s32;
+
+template <typename U>
+struct Vector {
+    static const size_t LANES = sizeof(U) / sizeof(u32);
+
+    static U Load(const u32* src)
+    {
+        U value;
+        memcpy(&value, src, sizeof(value));
+        return value;
+    }
+
+    static void Store(u32* dst, U value)
+    {
+        memcpy(dst, &value, sizeof(value));
+    }
+
+    static void StoreFlags(u8* dst, U flags)
+    {
+        for (size_t i = 0; i < LANES; ++i)
+            dst[i] = flags[i];
+    }
+
+    // Lanes of `a` where `mask` is all ones, of `b` where it is zero
+    template <typename M>
+    static U Select(M mask, U a, U b)
+    {
+        return (a & (U)mask) | (b & ~(U)mask);
+    }
+};
+
+template <typename U, typename S>
+struct VectorOps {
+    typedef Vector<U> V;
+
+    // Field `lane` of every element, `bits` wide, sign or zero extended
+    static S Field(U value, u32 lane, u32 bits, bool is_signed)
+    {
+        const S shifted = (S)(value << (32 - bits * (lane + 1)));
+        return is_signed ? shifted >> (32 - bits) : (S)((U)shifted >> (32 - bits));
+    }
+
+    static S Clamp(S value, s32 min, s32 max)
+    {
+        const S lo = (S)V::Select(value < min, (U)(S{} + min), (U)value);
+        return (S)V::Select(lo > max, (U)(S{} + max), (U)lo);
+    }
+
+    template <u32 op>
+    static U Parallel(U n, U m, U& flags)
+    {
+        const Prefix prefix = PrefixOf(op);
+        const Form form = FormOf(op);
+        const bool is_signed = prefix == PREFIX_S || prefix == PREFIX_Q || prefix == PREFIX_SH;
+        const u32 bits = (form == FORM_ADD8 || form == FORM_SUB8) ? 8 : 16;
+        const u32 lanes = 32 / bits;
+        const u32 ge_bits = 4 / lanes;
+        const bool exchange = form == FORM_ASX || form == FORM_SAX;
+
+        U result = U{};
+        flags = U{};
+        for (u32 lane = 0; lane < lanes; ++lane) {
+            const bool add = form == FORM_ADD16 || form == FORM_ADD8 || (form == FORM_ASX && lane == 1) ||
+                             (form == FORM_SAX && lane == 0);
+            const S a = Field(n, lane, bits, is_signed);
+            const S b = Field(m, exchange ? 1 - lane : lane, bits, is_signed);
+            S value = add ? a + b : a - b;
+
+            if (prefix == PREFIX_S || prefix == PREFIX_U) {
+                const s32 min = (prefix == PREFIX_U && add) ? 1 << bits : 0;
+                flags |= (U)(value >= min) & (((1u << ge_bits) - 1) << (lane * ge_bits));
+            } else if (prefix == PREFIX_Q) {
+                value = Clamp(value, -(1 << (bits - 1)), (1 << (bits - 1)) - 1);
+            } else if (prefix == PREFIX_UQ) {
+                value = Clamp(value, 0, (1 << bits) - 1);
+            } else {
+                value >>= 1;
+            }
+            result |= ((U)value & ((1u << bits) - 1)) << (lane * bits);
+        }
+        return result;
+    }
+
+    static U SignExtend(U value, u32 bits)
+    {
+        return (U)((S)(value << (32 - bits)) >> (32 - bits));
+    }
+
+    static U Saturate16(U value, s32 min, s32 max)
+    {
+        const U lo = (U)Clamp(Field(value, 0, 16, true), min, max) & 0xFFFF;
+        const U hi = (U)Clamp(Field(value, 1, 16, true), min, max) << 16;
+        return lo | hi;
+    }
+
+    template <u32 op>
+    static U Apply(u32 imm, U n, U m, U a, U& flags)
+    {
+        if (IsParallel(op))
+            return Parallel<IsParallel(op) ? op : 0>(n, m, flags);
+
+        const u32 rotation = imm & 24;
+        const U rotated = rotation == 0 ? m : (m >> rotation) | (m << (32 - rotation));
+        const U byte0 = rotated & 0xFF;
+        const U byte2 = (rotated >> 16) & 0xFF;
+
+        switch ((Op)op) {
+        case Op::USAD8:
+        case Op::USADA8: {
+            U sum = (Op)op == Op::USADA8 ? a : U{};
+            for (u32 lane = 0; lane < 4; ++lane) {
+                const S difference = Field(n, lane, 8, false) - Field(m, lane, 8, false);
+                sum += V::Select(difference < 0, (U)-difference, (U)difference);
+            }
+            return sum;
+        }
+
+        case Op::SXTB:
+            return SignExtend(rotated, 8);
+        case Op::SXTH:
+            return SignExtend(rotated, 16);
+        case Op::SXTB16:
+            return (SignExtend(byte0, 8) & 0xFFFF) | (SignExtend(byte2, 8) << 16);
+        case Op::UXTB:
+            return byte0;
+        case Op::UXTH:
+            return rotated & 0xFFFF;
+        case Op::UXTB16:
+            return byte0 | (byte2 << 16);
+        case Op::SXTAB:
+            return n + SignExtend(rotated, 8);
+        case Op::SXTAH:
+            return n + SignExtend(rotated, 16);
+        case Op::SXTAB16:
+            return ((n + SignExtend(byte0, 8)) & 0xFFFF) | ((n & 0xFFFF0000) + (SignExtend(byte2, 8) << 16));
+        case Op::UXTAB:
+            return n + byte0;
+        case Op::UXTAH:
+            return n + (rotated & 0xFFFF);
+        case Op::UXTAB16:
+            return ((n + byte0) & 0xFFFF) | ((n & 0xFFFF0000) + (byte2 << 16));
+
+        case Op::SEL: {
+            // Spreads GE bit i over byte i
+            const U bits = a & 0xF;
+            const U mask = (bits & 1) * 0xFF | ((bits >> 1) & 1) * 0xFF00 | ((bits >> 2) & 1) * 0xFF0000 |
+                           ((bits >> 3) & 1) * 0xFF000000;
+            return (n & mask) | (m & ~mask);
+        }
+        case Op::PKHBT:
+            return (n & 0xFFFF) | ((m << (imm & 31)) & 0xFFFF0000);
+        case Op::PKHTB: {
+            // A shift of 0 means 32, which leaves only copies of the sign bit, as 31 does
+            const u32 shift = (imm & 31) == 0 ? 31 : imm & 31;
+            return (n & 0xFFFF0000) | ((U)((S)m >> shift) & 0xFFFF);
+        }
+        case Op::REV:
+            return (m >> 24) | ((m >> 8) & 0xFF00) | ((m << 8) & 0xFF0000) | (m << 24);
+        case Op::REV16:
+            return ((m >> 8) & 0x00FF00FF) | ((m << 8) & 0xFF00FF00);
+        case Op::REVSH:
+            return (U)((S)((m << 24) | ((m << 8) & 0xFF0000)) >> 16);
+        case Op::SSAT16: {
+            const u32 bits = ((imm - 1) & 15) + 1;
+            return Saturate16(n, -(1 << (bits - 1)), (1 << (bits - 1)) - 1);
+        }
+        case Op::USAT16:
+            return Saturate16(n, 0, (1 << (imm & 15)) - 1);
+        default:
+            return U{};
+        }
+    }
+
+    template <u32 op>
+    struct Batch {
+        static void Run(u32 imm, const u32* rn, const u32* rm, const u32* ra, u32* rd, u8* ge, size_t count)
+        {
+            size_t i = 0;
+            for (; i + V::LANES <= count; i += V::LANES) {
+                const U n = rn ? V::Load(rn + i) : U{};
+                const U m = rm ? V::Load(rm + i) : U{};
+                const U a = ra ? V::Load(ra + i) : U{};
+                U flags;
+                V::Store(rd + i, Apply<op>(imm, n, m, a, flags));
+                if (ParallelSetsGE(op) && ge != nullptr)
+                    V::StoreFlags(ge + i, flags);
+            }
+            BatchScalar((Op)op, imm, rn, rm, ra, rd, ge, i, count);
+        }
+    };
+};
+
+} // namespace
+} // namespace
+} // namespace
@@ -0,0 +1,109 @@
+#include "compare.h"
+
+#include <algorithm>
+#include <math.h>
+
+namespace Collector {
+
+Summary Aggregate(const std::vector<Run>& runs)
+{
+    Summary summary;
+    for (const Run& run : runs) {
+        summary.runs++;
+        if (summary.tick_rate == 0)
+            summary.tick_rate = run.tick_rate;
+
+        for (const TestResult& test : run.tests) {
+            TestSummary& result = summary.tests[ResultKey(test.group, test.name)];
+            test.passed ? result.passed++ : result.failed++;
+        }
+        for (const BenchmarkResult& benchmark : run.benchmarks) {
+            std::vector<uint64_t>& samples = summary.benchmarks[ResultKey(benchmark.group, benchmark.name)];
+            samples.insert(samples.end(), benchmark.samples.begin(), benchmark.samples.end());
+        }
+    }
+
+    for (auto& benchmark : summary.benchmarks)
+        std::sort(benchmark.second.begin(), benchmark.second.end());
+    return summary;
+}
+
+uint64_t Percentile(const std::vector<uint64_t>& sorted, uint32_t percent)
+{
+    const size_t rank = (sorted.size() * percent + 99) / 100;
+    return sorted[rank ? rank - 1 : 0];
+}
+
+double KolmogorovSmirnov(const std::vector<uint64_t>& a, const std::vector<uint64_t>& b)
+{
+    // Walks both in order, stepping past every sample equal to the next value at once, so that
+    // ties do not count as a difference
+    size_t i = 0, j = 0;
+    double distance = 0;
+    while (i < a.size() && j < b.size()) {
+        const uint64_t value = std::min(a[i], b[j]);
+        while (i < a.size() && a[i] == value)
+            i++;
+        while (j < b.size() && b[j] == value)
+            j++;
+        distance = std::max(distance, fabs((double)i / a.size() - (double)j / b.size()));
+    }
+    return distance;
+}
+
+std::vector<BenchmarkDiff> DiffBenchmarks(const Summary& a, const Summary& b)
+{
+    // c(alpha) of the two-sample test, for alpha = 0.01
+    const double c_alpha = 1.628;
+
+    std::vector<BenchmarkDiff> diffs;
+    for (const auto& benchmark : a.benchmarks) {
+        auto other = b.benchmarks.find(benchmark.first);
+        if (other == b.benchmarks.end() || benchmark.second.empty() || other->second.empty())
+            continue;
+
+        const std::vector<uint64_t>& samples_a = benchmark.second;
+        const std::vector<uint64_t>& samples_b = other->second;
+        const double n = samples_a.size();
+        const double m = samples_b.size();
+
+        BenchmarkDiff diff;
+        diff.key = benchmark.first;
+        diff.median_a = Percentile(samples_a, 50);
+        diff.median_b = Percentile(samples_b, 50);
+        diff.p99_a = Percentile(samples_a, 99);
+        diff.p99_b = Percentile(samples_b, 99);
+        diff.distance = KolmogorovSmirnov(samples_a, samples_b);
+        diff.critical = c_alpha * sqrt((n + m) / (n * m));
+
+        if (diff.distance <= diff.critical || diff.median_a == diff.median_b)
+            diff.verdict = BenchmarkDiff::SAME;
+        else
+            diff.verdict = diff.median_b > diff.median_a ? BenchmarkDiff::SLOWER : BenchmarkDiff::FASTER;
+        diffs.push_back(diff);
+    }
+    return diffs;
+}
+
+std::vector<TestDiff> DiffTests(const Summary& a, const Summary& b)
+{
+    std::map<ResultKey, TestDiff> diffs;
+    for (const auto& test : a.tests)
+        diffs[test.first].a = test.second;
+    for (const auto& test : b.tests)
+        diffs[test.first].b = test.second;
+
+    std::vector<TestDiff> changed;
+    for (auto& diff : diffs) {
+        const TestSummary& in_a = diff.second.a;
+        const TestSummary& in_b = diff.second.b;
+        const bool only_one = (in_a.passed + in_a.failed == 0) != (in_b.passed + in_b.failed == 0);
+        if (only_one || (in_a.failed != 0) != (in_b.failed != 0)) {
+            diff.second.key = diff.first;
+            changed.push_back(diff.second);
+        }
+    }
+    return changed;
+}
+
+} // namespace
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "run.h"
+
+// Results of several runs taken together, and the differences between two such sets.
+
+namespace Collector {
+
+/// Tests and benchmarks are told apart by the group they report and their name.
+typedef std::pair<std::string, std::string> ResultKey;
+
+struct TestSummary {
+    uint32_t passed = 0;
+    uint32_t failed = 0;
+};
+
+struct Summary {
+    uint32_t runs = 0;
+    uint64_t tick_rate = 0;
+    std::map<ResultKey, TestSummary> tests;
+    // The samples of every run, sorted
+    std::map<ResultKey, std::vector<uint64_t>> benchmarks;
+};
+
+Summary Aggregate(const std::vector<Run>& runs);
+
+/// Nearest-rank percentile of sorted, non-empty samples, as hwtests reports them.
+uint64_t Percentile(const std::vector<uint64_t>& sorted, uint32_t percent);
+
+/// Largest difference between the cumulative distributions of two sorted sets of samples.
+double KolmogorovSmirnov(const std::vector<uint64_t>& a, const std::vector<uint64_t>& b);
+
+struct BenchmarkDiff {
+    enum Verdict { SAME, FASTER, SLOWER };
+
+    ResultKey key;
+    uint64_t median_a, median_b;
+    uint64_t p99_a, p99_b;
+    double distance;
+    // Distance above which the distributions differ, at a 1% significance level
+    double critical;
+    Verdict verdict;
+};
+
+/// Compares the benchmarks both summaries have, in the order of their keys.
+std::vector<BenchmarkDiff> DiffBenchmarks(const Summary& a, const Summary& b);
+
+struct TestDiff {
+    ResultKey key;
+    TestSummary a, b;
+};
+
+/// Tests that failed in only one of the summaries, or are only in one.
+std::vector<TestDiff> DiffTests(const Summary& a, const Summary& b);
+
+} // namespace
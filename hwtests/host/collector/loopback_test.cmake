@@ -0,0 +1,38 @@
+# Run by ctest: captures two runs of hwtests_host, streamed over the loopback interface as a 3DS
+# would stream them over the network, then checks that the store lists and compares them.
+
+file(REMOVE_RECURSE ${WORK_DIR})
+file(MAKE_DIRECTORY ${WORK_DIR})
+set(STORE ${WORK_DIR}/results.hwtc)
+
+function(collector)
+    execute_process(COMMAND ${COLLECTOR} ${STORE} ${ARGN}
+                    WORKING_DIRECTORY ${WORK_DIR}
+                    RESULT_VARIABLE result OUTPUT_VARIABLE output ERROR_VARIABLE output)
+    message("${output}")
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "hwtests_collector ${ARGN} failed: ${result}")
+    endif()
+    set(output "${output}" PARENT_SCOPE)
+endfunction()
+
+set(ENV{HWTESTS_SDMC} ${WORK_DIR})
+foreach(label first second)
+    collector(capture --label ${label} -- ${HWTESTS} --batch --collector 127.0.0.1:{port}
+              FS Kernel::AddressArbiter Benchmark::Model::Color)
+endforeach()
+
+collector(list)
+if (NOT output MATCHES " 1  first .* 2  second ")
+    message(FATAL_ERROR "the runs were not both stored")
+endif()
+
+collector(show first)
+if (NOT output MATCHES "BENCHMARK: \\[Model::Color\\]" OR NOT output MATCHES " 0 failed")
+    message(FATAL_ERROR "the run's results were not stored")
+endif()
+
+collector(diff first second)
+if (NOT output MATCHES "benchmarks slower, [0-9]+ faster, [0-9]+ the same")
+    message(FATAL_ERROR "the runs were not compared")
+endif()
@@ -0,0 +1,251 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "compare.h"
+#include "server.h"
+#include "store.h"
+
+// Collects the results hwtests streams when given --collector, or hwtest_collector.txt on the SD
+// card, keeps them in a store file, and compares runs.
+
+using namespace Collector;
+
+static const uint16_t DEFAULT_PORT = 5123;
+
+static int Usage()
+{
+    fprintf(stderr,
+            "usage: hwtests_collector <store> <command>\n"
+            "  listen [--port <port>] [--label <label>]\n"
+            "      Stores every run streamed to the port, one connection at a time\n"
+            "  capture [--label <label>] -- <program> [<args>]\n"
+            "      Runs the program, with {port} in its arguments replaced by a loopback port, and\n"
+            "      stores the run it streams there. Exits with the program's exit status.\n"
+            "  list\n"
+            "  show <runs>\n"
+            "  diff <runs> <runs>\n"
+            "Runs are given by id, or by label for every run with it. The results of several\n"
+            "runs are taken together. Runs are labelled with their platform by default.\n");
+    return 2;
+}
+
+static std::string FormatTime(int64_t seconds)
+{
+    const time_t time = seconds;
+    char text[32];
+    strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", localtime(&time));
+    return text;
+}
+
+static void PrintRun(const RunInfo& info)
+{
+    printf("%4u  %-16s %-8s %s %6u %6u %6u%s\n", info.id, info.label.c_str(), info.platform.c_str(),
+           FormatTime(info.time).c_str(), info.tests, info.failures, info.benchmarks,
+           info.complete ? "" : "  (cut short)");
+}
+
+static bool AddRun(Store& store, const std::string& label, const RunDecoder& decoder)
+{
+    const Run& run = decoder.GetRun();
+    RunInfo info;
+    std::string error;
+    if (!store.Add(label.empty() ? run.platform : label, time(nullptr), decoder.Records(), run, info, error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return false;
+    }
+    PrintRun(info);
+    return true;
+}
+
+static int Listen(Store& store, uint16_t port, const std::string& label)
+{
+    std::string error;
+    uint16_t bound_port;
+    const int listener = Collector::Listen(false, port, bound_port, error);
+    if (listener < 0) {
+        fprintf(stderr, "Could not listen on port %u: %s\n", port, error.c_str());
+        return 1;
+    }
+
+    printf("Listening on port %u\n", bound_port);
+    fflush(stdout);
+    while (true) {
+        const int connection = accept(listener, nullptr, nullptr);
+        if (connection < 0)
+            continue;
+
+        RunDecoder decoder;
+        const bool received = ReceiveRun(connection, decoder, error);
+        close(connection);
+        if (!received)
+            fprintf(stderr, "Ignored a connection: %s\n", error.c_str());
+        // Whatever arrived of a run that was cut short is kept
+        if (!decoder.Records().empty())
+            AddRun(store, label, decoder);
+        fflush(stdout);
+    }
+}
+
+static int CaptureRun(Store& store, const std::vector<std::string>& command, const std::string& label)
+{
+    std::string error;
+    uint16_t port;
+    const int listener = Collector::Listen(true, 0, port, error);
+    if (listener < 0) {
+        fprintf(stderr, "Could not listen on the loopback interface: %s\n", error.c_str());
+        return 1;
+    }
+
+    RunDecoder decoder;
+    int status;
+    const bool received = Capture(listener, port, command, decoder, status, error);
+    close(listener);
+    if (!received)
+        fprintf(stderr, "No run captured: %s\n", error.c_str());
+    if (!decoder.Records().empty() && !AddRun(store, label, decoder))
+        return 1;
+    return received ? status : 1;
+}
+
+static bool LoadRuns(Store& store, const std::string& selector, std::vector<Run>& runs)
+{
+    const std::vector<RunInfo> selected = store.Select(selector);
+    if (selected.empty()) {
+        fprintf(stderr, "No run is %s\n", selector.c_str());
+        return false;
+    }
+
+    for (const RunInfo& info : selected) {
+        Run run;
+        std::string error;
+        if (!store.Load(info, run, error)) {
+            fprintf(stderr, "%s\n", error.c_str());
+            return false;
+        }
+        runs.push_back(run);
+    }
+    return true;
+}
+
+static std::string KeyName(const ResultKey& key)
+{
+    return "[" + key.first + "] " + key.second;
+}
+
+static int Show(Store& store, const std::string& selector)
+{
+    std::vector<Run> runs;
+    if (!LoadRuns(store, selector, runs))
+        return 1;
+    const Summary summary = Aggregate(runs);
+
+    printf("%u runs\n", summary.runs);
+    for (const auto& test : summary.tests) {
+        if (test.second.failed != 0)
+            printf("FAILURE: %s, %u of %u runs\n", KeyName(test.first).c_str(), test.second.failed,
+                   test.second.passed + test.second.failed);
+    }
+    for (const auto& benchmark : summary.benchmarks) {
+        const std::vector<uint64_t>& samples = benchmark.second;
+        if (samples.empty())
+            continue;
+        printf("BENCHMARK: %s: %zu samples, min %llu, median %llu, p99 %llu ticks\n", KeyName(benchmark.first).c_str(),
+               samples.size(), (unsigned long long)samples.front(), (unsigned long long)Percentile(samples, 50),
+               (unsigned long long)Percentile(samples, 99));
+    }
+
+    uint32_t passed = 0, failed = 0;
+    for (const auto& test : summary.tests) {
+        passed += test.second.passed;
+        failed += test.second.failed;
+    }
+    printf("%u tests passed, %u failed\n", passed, failed);
+    return 0;
+}
+
+static std::string TestStatus(const TestSummary& test)
+{
+    if (test.passed + test.failed == 0)
+        return "missing";
+    if (test.failed == 0)
+        return "passed";
+    return test.passed == 0 ? "failed" : "flaky";
+}
+
+static int Diff(Store& store, const std::string& selector_a, const std::string& selector_b)
+{
+    std::vector<Run> runs_a, runs_b;
+    if (!LoadRuns(store, selector_a, runs_a) || !LoadRuns(store, selector_b, runs_b))
+        return 1;
+    const Summary a = Aggregate(runs_a);
+    const Summary b = Aggregate(runs_b);
+
+    printf("%s (%u runs) -> %s (%u runs)\n", selector_a.c_str(), a.runs, selector_b.c_str(), b.runs);
+    for (const TestDiff& test : DiffTests(a, b))
+        printf("TEST: %s: %s -> %s\n", KeyName(test.key).c_str(), TestStatus(test.a).c_str(), TestStatus(test.b).c_str());
+
+    static const char* verdicts[] = { "same", "faster", "slower" };
+    uint32_t counts[3] = {};
+    for (const BenchmarkDiff& diff : DiffBenchmarks(a, b)) {
+        const double change = diff.median_a ? 100.0 * ((double)diff.median_b - diff.median_a) / diff.median_a : 0;
+        printf("%-6s %s: median %llu -> %llu ticks (%+.1f%%), p99 %llu -> %llu, D %.3f (%.3f)\n",
+               verdicts[diff.verdict], KeyName(diff.key).c_str(), (unsigned long long)diff.median_a,
+               (unsigned long long)diff.median_b, change, (unsigned long long)diff.p99_a,
+               (unsigned long long)diff.p99_b, diff.distance, diff.critical);
+        counts[diff.verdict]++;
+    }
+    printf("%u benchmarks slower, %u faster, %u the same\n", counts[BenchmarkDiff::SLOWER],
+           counts[BenchmarkDiff::FASTER], counts[BenchmarkDiff::SAME]);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+        return Usage();
+
+    const std::string command = argv[2];
+    std::string label;
+    uint16_t port = DEFAULT_PORT;
+    std::vector<std::string> args;
+    std::vector<std::string> program;
+    for (int i = 3; i < argc; ++i) {
+        if (strcmp(argv[i], "--") == 0) {
+            program.assign(argv + i + 1, argv + argc);
+            break;
+        }
+        if (strcmp(argv[i], "--label") == 0 && i + 1 < argc)
+            label = argv[++i];
+        else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc)
+            port = atoi(argv[++i]);
+        else
+            args.push_back(argv[i]);
+    }
+
+    Store store;
+    std::string error;
+    if (!store.Open(argv[1], error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    if (command == "listen" && args.empty())
+        return Listen(store, port, label);
+    if (command == "capture" && args.empty() && !program.empty())
+        return CaptureRun(store, program, label);
+    if (command == "list" && args.empty()) {
+        printf("  id  label            platform received             tests failed benchmarks\n");
+        for (const RunInfo& info : store.Runs())
+            PrintRun(info);
+        return 0;
+    }
+    if (command == "show" && args.size() == 1)
+        return Show(store, args[0]);
+    if (command == "diff" && args.size() == 2)
+        return Diff(store, args[0], args[1]);
+    return Usage();
+}
@@ -0,0 +1,119 @@
+#include "run.h"
+
+#include "common/stream_format.h"
+
+using namespace StreamFormat;
+
+namespace Collector {
+
+bool RunDecoder::Feed(const char* data, size_t size)
+{
+    if (!ok)
+        return false;
+
+    pending.append(data, size);
+    size_t used = 0;
+    while (used < pending.length()) {
+        // A type byte and a whole length varint, or wait for more
+        Reader header(pending.data() + used + 1, pending.length() - used - 1);
+        const uint64_t length = header.Varint();
+        if (!header.Ok() || length > header.Remaining())
+            break;
+
+        const uint8_t type = pending[used];
+        const size_t payload = pending.length() - header.Remaining();
+        if (!Decode(type, pending.data() + payload, length)) {
+            ok = false;
+            return false;
+        }
+        records.append(pending, used, payload + length - used);
+        used = payload + length;
+    }
+    pending.erase(0, used);
+    return true;
+}
+
+bool RunDecoder::Decode(uint8_t type, const char* payload, size_t size)
+{
+    Reader reader(payload, size);
+
+    if (!hello_seen && type != RECORD_HELLO) {
+        error = "the stream does not start with a hello record";
+        return false;
+    }
+
+    switch (type) {
+    case RECORD_HELLO: {
+        if (hello_seen) {
+            error = "a second hello record";
+            return false;
+        }
+        const uint64_t magic = reader.Varint();
+        const uint64_t version = reader.Varint();
+        if (magic != MAGIC || version != VERSION) {
+            error = "not an hwtests result stream of a known version";
+            return false;
+        }
+        run.platform = reader.String();
+        run.tick_rate = reader.Varint();
+        hello_seen = true;
+        break;
+    }
+
+    case RECORD_GROUP:
+        run_group = reader.String();
+        break;
+
+    case RECORD_TEST: {
+        TestResult test;
+        test.run_group = run_group;
+        test.group = reader.String();
+        test.name = reader.String();
+        test.passed = reader.Varint() != 0;
+        test.ticks = reader.Varint();
+        run.tests.push_back(test);
+        break;
+    }
+
+    case RECORD_BENCHMARK: {
+        BenchmarkResult benchmark;
+        benchmark.run_group = run_group;
+        benchmark.group = reader.String();
+        benchmark.name = reader.String();
+        benchmark.iterations = reader.Varint();
+        benchmark.overhead = reader.Varint();
+        benchmark.samples = reader.Samples();
+        run.benchmarks.push_back(benchmark);
+        break;
+    }
+
+    case RECORD_END:
+        run.groups_run = reader.Varint();
+        run.failures = reader.Varint();
+        run.complete = true;
+        break;
+
+    default:
+        // From a newer hwtests
+        break;
+    }
+
+    if (!reader.Ok()) {
+        error = "a record is shorter than its fields";
+        return false;
+    }
+    return true;
+}
+
+bool DecodeRun(const std::string& records, Run& run, std::string& error)
+{
+    RunDecoder decoder;
+    if (!decoder.Feed(records.data(), records.length()) || !decoder.Finished()) {
+        error = decoder.Error().empty() ? "the records are cut short" : decoder.Error();
+        return false;
+    }
+    run = decoder.GetRun();
+    return true;
+}
+
+} // namespace
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// One run of hwtests as the collector sees it, decoded from the records it streamed.
+
+namespace Collector {
+
+struct TestResult {
+    // The group of main()'s the test ran in, and the group and name it reported
+    std::string run_group;
+    std::string group;
+    std::string name;
+    bool passed;
+    uint64_t ticks;
+};
+
+struct BenchmarkResult {
+    std::string run_group;
+    std::string group;
+    std::string name;
+    uint64_t iterations;
+    uint64_t overhead;
+    // Sorted, in ticks, at most StreamFormat::MAX_SAMPLES of them
+    std::vector<uint64_t> samples;
+};
+
+struct Run {
+    std::string platform;
+    uint64_t tick_rate = 0;
+    std::vector<TestResult> tests;
+    std::vector<BenchmarkResult> benchmarks;
+    // Whether the end record arrived, and what it said
+    bool complete = false;
+    uint32_t groups_run = 0;
+    uint32_t failures = 0;
+};
+
+/**
+ * Decodes a stream of records into a Run, from bytes as they arrive: a record split across two
+ * Feed() calls is decoded once the second arrives. The raw records are kept, as they are what the
+ * store keeps.
+ */
+class RunDecoder {
+public:
+    /// Returns false once the stream turns out to be malformed, with the reason in Error().
+    bool Feed(const char* data, size_t size);
+
+    /// Whether the stream ended on a record boundary, after a hello record.
+    bool Finished() const { return ok && hello_seen && pending.empty(); }
+
+    const Run& GetRun() const { return run; }
+    const std::string& Records() const { return records; }
+    const std::string& Error() const { return error; }
+
+private:
+    bool Decode(uint8_t type, const char* payload, size_t size);
+
+    Run run;
+    std::string records;
+    std::string pending;
+    std::string run_group;
+    std::string error;
+    bool hello_seen = false;
+    bool ok = true;
+};
+
+/// Decodes the records of a whole run. Returns false, with the reason in `error`, if they are not one.
+bool DecodeRun(const std::string& records, Run& run, std::string& error);
+
+} // namespace
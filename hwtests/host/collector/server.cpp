@@ -0,0 +1,128 @@
+#include "server.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+namespace Collector {
+
+int Listen(bool loopback_only, uint16_t port, uint16_t& bound_port, std::string& error)
+{
+    const int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) {
+        error = strerror(errno);
+        return -1;
+    }
+    // Not passed on to captured commands
+    fcntl(listener, F_SETFD, FD_CLOEXEC);
+    const int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(loopback_only ? INADDR_LOOPBACK : INADDR_ANY);
+    addr.sin_port = htons(port);
+    socklen_t length = sizeof(addr);
+    if (bind(listener, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listener, 4) != 0 ||
+        getsockname(listener, (sockaddr*)&addr, &length) != 0) {
+        error = strerror(errno);
+        close(listener);
+        return -1;
+    }
+
+    bound_port = ntohs(addr.sin_port);
+    return listener;
+}
+
+bool ReceiveRun(int connection, RunDecoder& decoder, std::string& error)
+{
+    char buffer[0x10000];
+    while (true) {
+        const ssize_t received = recv(connection, buffer, sizeof(buffer), 0);
+        if (received < 0 && errno == EINTR)
+            continue;
+        if (received < 0) {
+            error = strerror(errno);
+            return false;
+        }
+        if (received == 0)
+            break;
+        if (!decoder.Feed(buffer, received)) {
+            error = decoder.Error();
+            return false;
+        }
+    }
+
+    // A run cut short is kept up to its last whole record
+    if (decoder.Records().empty()) {
+        error = "the connection closed before a hello record";
+        return false;
+    }
+    return true;
+}
+
+static void RunCommand(const std::vector<std::string>& command, uint16_t port)
+{
+    std::vector<std::string> args;
+    for (std::string arg : command) {
+        for (size_t pos = arg.find("{port}"); pos != std::string::npos; pos = arg.find("{port}", pos))
+            arg.replace(pos, 6, std::to_string(port));
+        args.push_back(arg);
+    }
+
+    std::vector<char*> argv;
+    for (std::string& arg : args)
+        argv.push_back(&arg[0]);
+    argv.push_back(nullptr);
+
+    execvp(argv[0], argv.data());
+    fprintf(stderr, "Could not run %s: %s\n", argv[0], strerror(errno));
+    _exit(127);
+}
+
+bool Capture(int listener, uint16_t port, const std::vector<std::string>& command, RunDecoder& decoder,
+             int& status, std::string& error)
+{
+    const pid_t child = fork();
+    if (child < 0) {
+        error = strerror(errno);
+        return false;
+    }
+    if (child == 0)
+        RunCommand(command, port);
+
+    // Waits for the connection, or for the command to give up without making one
+    int connection = -1;
+    int wait_status = 0;
+    bool exited = false;
+    while (connection < 0 && !exited) {
+        pollfd poll_fd = { listener, POLLIN, 0 };
+        if (poll(&poll_fd, 1, 100) > 0)
+            connection = accept(listener, nullptr, nullptr);
+        else
+            exited = waitpid(child, &wait_status, WNOHANG) == child;
+    }
+
+    bool received = false;
+    if (connection >= 0) {
+        received = ReceiveRun(connection, decoder, error);
+        close(connection);
+    } else {
+        error = "the command exited without connecting";
+    }
+
+    if (!exited)
+        waitpid(child, &wait_status, 0);
+    status = WIFEXITED(wait_status) ? WEXITSTATUS(wait_status) : 128 + WTERMSIG(wait_status);
+    return received;
+}
+
+} // namespace
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "run.h"
+
+// Receiving runs over TCP, from a 3DS on the network or from a host build on this machine.
+
+namespace Collector {
+
+/**
+ * Listens on `port`, of every interface or only of the loopback one. Port 0 picks a free port.
+ * Returns the socket, with the port it is bound to in `bound_port`, or -1.
+ */
+int Listen(bool loopback_only, uint16_t port, uint16_t& bound_port, std::string& error);
+
+/// Reads the stream of an accepted `connection` until it closes. Returns false if it is not a run.
+bool ReceiveRun(int connection, RunDecoder& decoder, std::string& error);
+
+/**
+ * The loopback stand-in for a 3DS: runs `command`, with "{port}" in its arguments replaced by
+ * `port`, and receives the run it streams to `listener`. Sets `status` to its exit status.
+ * Returns false if it exited without connecting, or did not stream a run.
+ */
+bool Capture(int listener, uint16_t port, const std::vector<std::string>& command, RunDecoder& decoder,
+             int& status, std::string& error);
+
+} // namespace
@@ -0,0 +1,195 @@
+#include "store.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/stream_format.h"
+
+using namespace StreamFormat;
+
+namespace Collector {
+
+static const char FILE_MAGIC[4] = { 'H', 'W', 'T', 'C' };
+static const char FOOTER_MAGIC[4] = { 'H', 'W', 'T', 'I' };
+static const uint32_t FILE_VERSION = 1;
+
+static const uint64_t HEADER_SIZE = 8;
+// Index offset, index size, magic
+static const uint64_t FOOTER_SIZE = 16;
+
+static void PutWord(std::string& out, uint64_t value, unsigned bytes)
+{
+    for (unsigned i = 0; i < bytes; ++i)
+        out += (char)(value >> (i * 8));
+}
+
+static uint64_t GetWord(const char* data, unsigned bytes)
+{
+    uint64_t value = 0;
+    for (unsigned i = 0; i < bytes; ++i)
+        value |= (uint64_t)(uint8_t)data[i] << (i * 8);
+    return value;
+}
+
+Store::~Store()
+{
+    if (file != nullptr)
+        fclose(file);
+}
+
+bool Store::Open(const std::string& path, std::string& error)
+{
+    file = fopen(path.c_str(), "r+b");
+    if (file == nullptr) {
+        file = fopen(path.c_str(), "w+b");
+        if (file == nullptr) {
+            error = "could not open " + path;
+            return false;
+        }
+
+        std::string header(FILE_MAGIC, 4);
+        PutWord(header, FILE_VERSION, 4);
+        index_offset = HEADER_SIZE;
+        if (fwrite(header.data(), 1, header.length(), file) != header.length() || !WriteIndex()) {
+            error = "could not write " + path;
+            return false;
+        }
+        return true;
+    }
+
+    if (!ReadIndex(error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+bool Store::ReadIndex(std::string& error)
+{
+    char header[HEADER_SIZE];
+    char footer[FOOTER_SIZE];
+    if (fseek(file, 0, SEEK_SET) != 0 || fread(header, 1, HEADER_SIZE, file) != HEADER_SIZE ||
+        memcmp(header, FILE_MAGIC, 4) != 0 || GetWord(header + 4, 4) != FILE_VERSION) {
+        error = "not a result store";
+        return false;
+    }
+    if (fseek(file, -(long)FOOTER_SIZE, SEEK_END) != 0 || fread(footer, 1, FOOTER_SIZE, file) != FOOTER_SIZE ||
+        memcmp(footer + 12, FOOTER_MAGIC, 4) != 0) {
+        error = "the index is missing";
+        return false;
+    }
+
+    index_offset = GetWord(footer, 8);
+    const uint64_t index_size = GetWord(footer + 8, 4);
+    std::string index(index_size, '\0');
+    if (fseek(file, (long)index_offset, SEEK_SET) != 0 || fread(&index[0], 1, index_size, file) != index_size) {
+        error = "the index is cut short";
+        return false;
+    }
+
+    Reader reader(index.data(), index.length());
+    const uint64_t count = reader.Varint();
+    for (uint64_t i = 0; i < count && reader.Ok(); ++i) {
+        RunInfo info;
+        info.id = reader.Varint();
+        info.label = reader.String();
+        info.platform = reader.String();
+        info.time = reader.Varint();
+        info.tests = reader.Varint();
+        info.failures = reader.Varint();
+        info.benchmarks = reader.Varint();
+        info.complete = reader.Varint() != 0;
+        info.offset = reader.Varint();
+        info.size = reader.Varint();
+        runs.push_back(info);
+    }
+    if (!reader.Ok()) {
+        error = "the index is corrupt";
+        return false;
+    }
+    return true;
+}
+
+bool Store::WriteIndex()
+{
+    std::string index;
+    PutVarint(index, runs.size());
+    for (const RunInfo& info : runs) {
+        PutVarint(index, info.id);
+        PutString(index, info.label);
+        PutString(index, info.platform);
+        PutVarint(index, info.time);
+        PutVarint(index, info.tests);
+        PutVarint(index, info.failures);
+        PutVarint(index, info.benchmarks);
+        PutVarint(index, info.complete);
+        PutVarint(index, info.offset);
+        PutVarint(index, info.size);
+    }
+
+    std::string footer;
+    PutWord(footer, index_offset, 8);
+    PutWord(footer, index.length(), 4);
+    footer.append(FOOTER_MAGIC, 4);
+
+    index += footer;
+    return fseek(file, (long)index_offset, SEEK_SET) == 0 &&
+           fwrite(index.data(), 1, index.length(), file) == index.length() && fflush(file) == 0;
+}
+
+bool Store::Add(const std::string& label, int64_t time, const std::string& records, const Run& run, RunInfo& info,
+                std::string& error)
+{
+    info.id = runs.empty() ? 1 : runs.back().id + 1;
+    info.label = label;
+    info.platform = run.platform;
+    info.time = time;
+    info.tests = run.tests.size();
+    info.failures = 0;
+    for (const TestResult& test : run.tests)
+        info.failures += !test.passed;
+    info.benchmarks = run.benchmarks.size();
+    info.complete = run.complete;
+    info.offset = index_offset;
+    info.size = records.length();
+
+    // Over the old index. The run and the new index are longer than it, so none of it is left over.
+    if (fseek(file, (long)index_offset, SEEK_SET) != 0 ||
+        fwrite(records.data(), 1, records.length(), file) != records.length()) {
+        error = "could not write the run";
+        return false;
+    }
+    runs.push_back(info);
+    index_offset += records.length();
+    if (!WriteIndex()) {
+        error = "could not write the index";
+        return false;
+    }
+    return true;
+}
+
+bool Store::Load(const RunInfo& info, Run& run, std::string& error)
+{
+    std::string records(info.size, '\0');
+    if (fseek(file, (long)info.offset, SEEK_SET) != 0 || fread(&records[0], 1, info.size, file) != info.size) {
+        error = "the records of run " + std::to_string(info.id) + " are cut short";
+        return false;
+    }
+    return DecodeRun(records, run, error);
+}
+
+std::vector<RunInfo> Store::Select(const std::string& selector) const
+{
+    std::vector<RunInfo> selected;
+    char* end;
+    const unsigned long id = strtoul(selector.c_str(), &end, 10);
+    const bool is_id = !selector.empty() && *end == '\0';
+
+    for (const RunInfo& info : runs) {
+        if (is_id ? info.id == id : info.label == selector)
+            selected.push_back(info);
+    }
+    return selected;
+}
+
+} // namespace
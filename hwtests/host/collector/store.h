@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "run.h"
+
+// Runs kept in one file: the records of each run as they were streamed, one after another, then an
+// index of the runs, then a footer giving where the index starts. Adding a run writes it over the
+// old index, and writes a new index and footer after it, so the records are never rewritten and a
+// run is read with one seek.
+
+namespace Collector {
+
+struct RunInfo {
+    uint32_t id;
+    std::string label;
+    std::string platform;
+    // Seconds since the epoch, when the collector received the run
+    int64_t time;
+    uint32_t tests;
+    uint32_t failures;
+    uint32_t benchmarks;
+    bool complete;
+    // Where its records are in the file
+    uint64_t offset;
+    uint64_t size;
+};
+
+class Store {
+public:
+    ~Store();
+
+    /// Opens the store at `path`, creating it if it does not exist.
+    bool Open(const std::string& path, std::string& error);
+
+    const std::vector<RunInfo>& Runs() const { return runs; }
+
+    /// Adds a run, given its records and the run they decode to. Sets `info` to its index entry.
+    bool Add(const std::string& label, int64_t time, const std::string& records, const Run& run, RunInfo& info,
+             std::string& error);
+
+    bool Load(const RunInfo& info, Run& run, std::string& error);
+
+    /// The runs `selector` names: the run with that id, or every run with that label.
+    std::vector<RunInfo> Select(const std::string& selector) const;
+
+private:
+    bool ReadIndex(std::string& error);
+    bool WriteIndex();
+
+    FILE* file = nullptr;
+    std::vector<RunInfo> runs;
+    // End of the last run's records, where the index starts
+    uint64_t index_offset = 0;
+};
+
+} // namespace
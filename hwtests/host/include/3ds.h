@@ -0,0 +1,21 @@
+#pragma once
+
+// The parts of libctru used by the portable hwtests, implemented on the host. Names, types and
+// signatures follow libctru, so that the same test sources build for both.
+
+#include "3ds/types.h"
+#include "3ds/result.h"
+#include "3ds/svc.h"
+#include "3ds/synchronization.h"
+#include "3ds/os.h"
+#include "3ds/gfx.h"
+#include "3ds/console.h"
+#include "3ds/sdmc.h"
+#include "3ds/allocator/linear.h"
+#include "3ds/allocator/vram.h"
+#include "3ds/gpu/gx.h"
+#include "3ds/services/apt.h"
+#include "3ds/services/fs.h"
+#include "3ds/services/hid.h"
+#include "3ds/services/gspgpu.h"
+#include "3ds/services/soc.h"
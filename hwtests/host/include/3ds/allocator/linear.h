@@ -0,0 +1,7 @@
+#pragma once
+
+#include <stddef.h>
+
+/// Ordinary heap memory on the host, which the GPU models can read and write directly.
+void* linearAlloc(size_t size);
+void linearFree(void* mem);
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <stddef.h>
+
+/// Ordinary heap memory on the host, like linearAlloc().
+void* vramAlloc(size_t size);
+void vramFree(void* mem);
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "3ds/gfx.h"
+
+typedef struct PrintConsole PrintConsole;
+
+/// Console output goes to stdout.
+PrintConsole* consoleInit(gfxScreen_t screen, PrintConsole* console);
+void consoleClear(void);
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "3ds/types.h"
+
+typedef enum {
+    GFX_TOP = 0,
+    GFX_BOTTOM = 1,
+} gfxScreen_t;
+
+// There is no display on the host. These only exist so that the harness links.
+void gfxInitDefault(void);
+void gfxExit(void);
+void gfxFlushBuffers(void);
+void gfxSwapBuffers(void);
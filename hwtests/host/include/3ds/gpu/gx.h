@@ -0,0 +1,12 @@
+#pragma once
+
+#include "3ds/types.h"
+
+// Commands run on the host models in host/pica before returning, so the matching waits have
+// nothing to wait for.
+
+/// Returns RESULT_INVALID_COMBINATION for transfers the model does not handle.
+Result GX_DisplayTransfer(u32* inadr, u32 indim, u32* outadr, u32 outdim, u32 flags);
+
+/// Each engine runs if its start address is set and its control value has the start bit.
+Result GX_MemoryFill(u32* buf0a, u32 buf0v, u32* buf0e, u16 control0, u32* buf1a, u32 buf1v, u32* buf1e, u16 control1);
@@ -0,0 +1,3 @@
+#pragma once
+
+#define SYSCLOCK_ARM11 268111856
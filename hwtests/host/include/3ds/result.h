@@ -0,0 +1,15 @@
+#pragma once
+
+#define R_SUCCEEDED(res) ((res) >= 0)
+#define R_FAILED(res) ((res) < 0)
+
+// Result codes returned by the host implementation, with the values the 3DS uses for them
+#define RESULT_TIMEOUT ((Result)0x09401BFE)
+#define RESULT_INVALID_HANDLE ((Result)0xD8E007F7)
+#define RESULT_OUT_OF_HANDLES ((Result)0xD8600413)
+#define RESULT_NOT_OWNER ((Result)0xD8E0041F)
+#define RESULT_INVALID_COMBINATION ((Result)0xE0E01BEE)
+#define RESULT_OUT_OF_RANGE ((Result)0xD8E007FD)
+#define RESULT_INVALID_RANGE ((Result)0xE0E01BFD)
+#define RESULT_INVALID_POINTER ((Result)0xD8E007F6)
+#define RESULT_INVALID_ENUM ((Result)0xD8E093ED)
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "3ds/types.h"
+
+/**
+ * The SD card is a host directory: $HWTESTS_SDMC if set, the working directory otherwise.
+ * sdmcInit() makes it the working directory, as it is on the 3DS, so relative paths resolve
+ * inside it.
+ */
+Result sdmcInit(void);
+Result sdmcExit(void);
@@ -0,0 +1,4 @@
+#pragma once
+
+/// Always false: there is no home menu to return to, so interactive loops end at once.
+bool aptMainLoop(void);
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "3ds/types.h"
+
+/**
+ * FS:USER, limited to the SD card archive, which is backed by the host directory described in
+ * sdmc.h. Files and directories are opened as kernel handles, so svcCloseHandle() closes them too.
+ */
+
+typedef enum {
+    PATH_INVALID = 0,
+    PATH_EMPTY = 1,
+    PATH_BINARY = 2,
+    PATH_ASCII = 3,
+    PATH_UTF16 = 4,
+} FS_PathType;
+
+typedef enum {
+    ARCHIVE_SDMC = 0x00000009,
+} FS_ArchiveID;
+
+enum {
+    FS_OPEN_READ = BIT(0),
+    FS_OPEN_WRITE = BIT(1),
+    FS_OPEN_CREATE = BIT(2),
+};
+
+enum {
+    FS_WRITE_FLUSH = BIT(0),
+    FS_WRITE_UPDATE_TIME = BIT(8),
+};
+
+enum {
+    FS_ATTRIBUTE_DIRECTORY = BIT(0),
+    FS_ATTRIBUTE_HIDDEN = BIT(8),
+    FS_ATTRIBUTE_ARCHIVE = BIT(16),
+    FS_ATTRIBUTE_READ_ONLY = BIT(24),
+};
+
+typedef struct {
+    FS_PathType type;
+    u32 size;
+    const void* data;
+} FS_Path;
+
+typedef u64 FS_Archive;
+
+typedef struct {
+    u16 name[0x106];
+    char shortName[0x0A];
+    char shortExt[0x04];
+    u8 valid;
+    u8 reserved;
+    u32 attributes;
+    u64 fileSize;
+} FS_DirectoryEntry;
+
+// Result codes returned by the host implementation, with the values the 3DS SD card archive uses
+#define RESULT_FS_NOT_FOUND ((Result)0xC8804478)
+#define RESULT_FS_DIRECTORY_NOT_FOUND ((Result)0xC8804471)
+#define RESULT_FS_ALREADY_EXISTS ((Result)0xC82044BE)
+#define RESULT_FS_DIRECTORY_ALREADY_EXISTS ((Result)0xC82044B9)
+#define RESULT_FS_INVALID_ARCHIVE ((Result)0xC8804464)
+#define RESULT_FS_INVALID_PATH ((Result)0xE0E046BE)
+#define RESULT_FS_NOT_PERMITTED ((Result)0xC8804465)
+
+FS_Path fsMakePath(FS_PathType type, const void* path);
+
+Result FSUSER_OpenArchive(FS_Archive* archive, FS_ArchiveID id, FS_Path path);
+Result FSUSER_CloseArchive(FS_Archive archive);
+
+Result FSUSER_OpenFile(Handle* out, FS_Archive archive, FS_Path path, u32 open_flags, u32 attributes);
+Result FSUSER_CreateFile(FS_Archive archive, FS_Path path, u32 attributes, u64 file_size);
+Result FSUSER_DeleteFile(FS_Archive archive, FS_Path path);
+Result FSUSER_RenameFile(FS_Archive src_archive, FS_Path src_path, FS_Archive dst_archive, FS_Path dst_path);
+
+Result FSUSER_OpenDirectory(Handle* out, FS_Archive archive, FS_Path path);
+Result FSUSER_CreateDirectory(FS_Archive archive, FS_Path path, u32 attributes);
+Result FSUSER_DeleteDirectory(FS_Archive archive, FS_Path path);
+Result FSUSER_RenameDirectory(FS_Archive src_archive, FS_Path src_path, FS_Archive dst_archive, FS_Path dst_path);
+
+Result FSFILE_Read(Handle handle, u32* bytes_read, u64 offset, void* buffer, u32 size);
+Result FSFILE_Write(Handle handle, u32* bytes_written, u64 offset, const void* buffer, u32 size, u32 flags);
+Result FSFILE_GetSize(Handle handle, u64* size);
+Result FSFILE_SetSize(Handle handle, u64 size);
+Result FSFILE_Flush(Handle handle);
+Result FSFILE_Close(Handle handle);
+
+Result FSDIR_Read(Handle handle, u32* entries_read, u32 entry_count, FS_DirectoryEntry* entries);
+Result FSDIR_Close(Handle handle);
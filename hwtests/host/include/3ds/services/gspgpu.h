@@ -0,0 +1,14 @@
+#pragma once
+
+#include "3ds/types.h"
+
+void gspWaitForVBlank(void);
+
+/// GPU commands complete before they return on the host, so these return at once.
+void gspWaitForPPF(void);
+void gspWaitForPSC0(void);
+void gspWaitForPSC1(void);
+
+/// There are no CPU caches to maintain between the host and the GPU models.
+Result GSPGPU_FlushDataCache(const void* adr, u32 size);
+Result GSPGPU_InvalidateDataCache(const void* adr, u32 size);
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "3ds/types.h"
+
+enum {
+    KEY_A = BIT(0),
+    KEY_B = BIT(1),
+    KEY_SELECT = BIT(2),
+    KEY_START = BIT(3),
+};
+
+/// No keys are ever pressed on the host.
+void hidScanInput(void);
+u32 hidKeysDown(void);
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "3ds/types.h"
+
+/**
+ * soc:U is the 3DS's BSD socket service. On the host the sockets are the host's own, so these
+ * only check their arguments, and programs use <sys/socket.h> as they do on the 3DS.
+ */
+Result socInit(u32* context_addr, u32 context_size);
+Result socExit(void);
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "3ds/types.h"
+
+typedef enum {
+    RESET_ONESHOT = 0,
+    RESET_STICKY = 1,
+    RESET_PULSE = 2,
+} ResetType;
+
+typedef enum {
+    ARBITRATION_SIGNAL = 0,
+    ARBITRATION_WAIT_IF_LESS_THAN = 1,
+    ARBITRATION_DECREMENT_AND_WAIT_IF_LESS_THAN = 2,
+    ARBITRATION_WAIT_IF_LESS_THAN_TIMEOUT = 3,
+    ARBITRATION_DECREMENT_AND_WAIT_IF_LESS_THAN_TIMEOUT = 4,
+} ArbitrationType;
+
+/// Pseudo-handle for the calling thread.
+#define CUR_THREAD_HANDLE 0xFFFF8000
+
+/**
+ * Kernel objects are modelled on host threads, of which only the one the 3DS kernel would run
+ * runs at a time: see source/scheduler.cpp. Processor ids are accepted, but every thread shares
+ * the one core.
+ */
+
+Result svcCreateThread(Handle* thread, ThreadFunc entrypoint, u32 arg, u32* stack_top, s32 thread_priority, s32 processor_id);
+void svcExitThread(void) __attribute__((noreturn));
+void svcSleepThread(s64 ns);
+Result svcGetThreadPriority(s32* out, Handle handle);
+
+Result svcCreateMutex(Handle* mutex, bool initially_locked);
+Result svcReleaseMutex(Handle handle);
+
+Result svcCreateEvent(Handle* event, ResetType reset_type);
+Result svcSignalEvent(Handle handle);
+Result svcClearEvent(Handle handle);
+
+Result svcCreateSemaphore(Handle* semaphore, s32 initial_count, s32 max_count);
+Result svcReleaseSemaphore(s32* count, Handle semaphore, s32 release_count);
+
+/// Addresses are host pointers, so they take a uintptr_t where libctru has a u32. Waiters are kept
+/// in a table hashed by address: see source/arbiter.cpp.
+Result svcCreateAddressArbiter(Handle* arbiter);
+Result svcArbitrateAddress(Handle arbiter, uintptr_t addr, ArbitrationType type, s32 value, s64 nanoseconds);
+
+Result svcWaitSynchronization(Handle handle, s64 nanoseconds);
+Result svcWaitSynchronizationN(s32* out, const Handle* handles, s32 handles_num, bool wait_all, s64 nanoseconds);
+
+Result svcDuplicateHandle(Handle* out, Handle original);
+Result svcCloseHandle(Handle handle);
+
+/// Ticks of the 268MHz system clock, derived from the host's monotonic clock. Skips ahead while
+/// every thread is waiting for a timeout.
+u64 svcGetSystemTick(void);
+
+Result svcOutputDebugString(const char* str, s32 length);
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "3ds/types.h"
+
+typedef s32 LightLock;
+
+void LightLock_Init(LightLock* lock);
+void LightLock_Lock(LightLock* lock);
+int LightLock_TryLock(LightLock* lock);
+void LightLock_Unlock(LightLock* lock);
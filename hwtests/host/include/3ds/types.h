@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define U64_MAX UINT64_MAX
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+// long long, as on the 3DS, so that the "%llu" formats used by the tests stay correct
+typedef unsigned long long u64;
+
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef long long s64;
+
+typedef volatile u8 vu8;
+typedef volatile u16 vu16;
+typedef volatile u32 vu32;
+typedef volatile u64 vu64;
+
+typedef s32 Result;
+typedef u32 Handle;
+
+typedef void (*ThreadFunc)(void*);
+
+#define BIT(n) (1U << (n))
@@ -0,0 +1,171 @@
+#include <cstring>
+
+#include "pica/color_kernels.h"
+
+namespace Pica {
+namespace Color {
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "RGBA8 words are read with memcpy");
+
+static u32 Expand5(u32 value) { return (value << 3) | (value >> 2); }
+static u32 Expand6(u32 value) { return (value << 2) | (value >> 4); }
+static u32 Expand4(u32 value) { return (value << 4) | value; }
+
+static u32 Pack(u32 r, u32 g, u32 b, u32 a)
+{
+    return (r << 24) | (g << 16) | (b << 8) | a;
+}
+
+static u16 Read16(const u8* src)
+{
+    return src[0] | (src[1] << 8);
+}
+
+static void Write16(u8* dst, u32 value)
+{
+    dst[0] = value & 0xFF;
+    dst[1] = value >> 8;
+}
+
+u32 DecodePixel(PixelFormat format, const u8* src)
+{
+    switch (format) {
+    case PixelFormat::RGBA8:
+        return src[0] | (src[1] << 8) | (src[2] << 16) | ((u32)src[3] << 24);
+    case PixelFormat::RGB8:
+        return Pack(src[2], src[1], src[0], 0xFF);
+    case PixelFormat::RGB565: {
+        const u32 value = Read16(src);
+        return Pack(Expand5(value >> 11), Expand6((value >> 5) & 0x3F), Expand5(value & 0x1F), 0xFF);
+    }
+    case PixelFormat::RGB5A1: {
+        const u32 value = Read16(src);
+        return Pack(Expand5(value >> 11), Expand5((value >> 6) & 0x1F), Expand5((value >> 1) & 0x1F),
+                    (value & 1) ? 0xFF : 0);
+    }
+    case PixelFormat::RGBA4: {
+        const u32 value = Read16(src);
+        return Pack(Expand4(value >> 12), Expand4((value >> 8) & 0xF), Expand4((value >> 4) & 0xF),
+                    Expand4(value & 0xF));
+    }
+    }
+    return 0;
+}
+
+void EncodePixel(PixelFormat format, u32 rgba, u8* dst)
+{
+    const u32 r = rgba >> 24;
+    const u32 g = (rgba >> 16) & 0xFF;
+    const u32 b = (rgba >> 8) & 0xFF;
+    const u32 a = rgba & 0xFF;
+
+    switch (format) {
+    case PixelFormat::RGBA8:
+        dst[0] = a;
+        dst[1] = b;
+        dst[2] = g;
+        dst[3] = r;
+        break;
+    case PixelFormat::RGB8:
+        dst[0] = b;
+        dst[1] = g;
+        dst[2] = r;
+        break;
+    case PixelFormat::RGB565:
+        Write16(dst, ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+        break;
+    case PixelFormat::RGB5A1:
+        Write16(dst, ((r >> 3) << 11) | ((g >> 3) << 6) | ((b >> 3) << 1) | (a >> 7));
+        break;
+    case PixelFormat::RGBA4:
+        Write16(dst, ((r >> 4) << 12) | ((g >> 4) << 8) | ((b >> 4) << 4) | (a >> 4));
+        break;
+    }
+}
+
+void DecodeScalar(PixelFormat format, const u8* src, u32* rgba, size_t count)
+{
+    const u32 bpp = BytesPerPixel(format);
+    for (size_t i = 0; i < count; ++i)
+        rgba[i] = DecodePixel(format, src + i * bpp);
+}
+
+void EncodeScalar(PixelFormat format, const u32* rgba, u8* dst, size_t count)
+{
+    const u32 bpp = BytesPerPixel(format);
+    for (size_t i = 0; i < count; ++i)
+        EncodePixel(format, rgba[i], dst + i * bpp);
+}
+
+template <PixelFormat format>
+static void Decode(const u8* src, u32* rgba, size_t count)
+{
+    DecodeScalar(format, src, rgba, count);
+}
+
+template <PixelFormat format>
+static void Encode(const u32* rgba, u8* dst, size_t count)
+{
+    EncodeScalar(format, rgba, dst, count);
+}
+
+const Kernels scalar_kernels = {
+    { Decode<PixelFormat::RGBA8>, Decode<PixelFormat::RGB8>, Decode<PixelFormat::RGB565>,
+      Decode<PixelFormat::RGB5A1>, Decode<PixelFormat::RGBA4> },
+    { Encode<PixelFormat::RGBA8>, Encode<PixelFormat::RGB8>, Encode<PixelFormat::RGB565>,
+      Encode<PixelFormat::RGB5A1>, Encode<PixelFormat::RGBA4> },
+};
+
+#if !defined(__x86_64__) && !defined(__i386__)
+const Kernels* const sse41_kernels = nullptr;
+const Kernels* const avx2_kernels = nullptr;
+#endif
+
+static const Kernels* GetKernels(Kernel kernel)
+{
+    switch (kernel) {
+    case Kernel::Vector:
+        return &vector_kernels;
+    case Kernel::SSE41:
+        return sse41_kernels;
+    case Kernel::AVX2:
+        return avx2_kernels;
+    default:
+        return &scalar_kernels;
+    }
+}
+
+// Pixels converted per step, small enough for the intermediate words to stay in the L1 cache
+static const size_t CHUNK_PIXELS = 512;
+
+void Convert(Kernel kernel, PixelFormat in, PixelFormat out, const u8* src, u8* dst, size_t count)
+{
+    if (in == out) {
+        memcpy(dst, src, count * BytesPerPixel(in));
+        return;
+    }
+
+    const Kernels* kernels = GetKernels(kernel);
+    const DecodeFunc decode = kernels->decode[(u32)in];
+    const EncodeFunc encode = kernels->encode[(u32)out];
+    const u32 in_bpp = BytesPerPixel(in);
+    const u32 out_bpp = BytesPerPixel(out);
+
+    alignas(32) u32 rgba[CHUNK_PIXELS];
+    while (count > 0) {
+        const size_t pixels = count < CHUNK_PIXELS ? count : CHUNK_PIXELS;
+        decode(src, rgba, pixels);
+        encode(rgba, dst, pixels);
+        src += pixels * in_bpp;
+        dst += pixels * out_bpp;
+        count -= pixels;
+    }
+}
+
+void Convert(PixelFormat in, PixelFormat out, const u8* src, u8* dst, size_t count)
+{
+    Convert(BestKernel(), in, out, src, dst, count);
+}
+
+} // namespace
+} // namespace
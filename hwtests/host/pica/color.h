@@ -0,0 +1,29 @@
+#pragma once
+
+#include "pica/kernel.h"
+
+/**
+ * Pixel format conversion as done by the DisplayTransfer engine, bit exact with the hardware
+ * results recorded in hwtests.
+ *
+ * Pixels are converted through RGBA8: narrower channels are widened by repeating their top bits
+ * (so 0x1F becomes 0xFF), RGB8 gets an alpha of 0xFF, and channels are narrowed by truncation.
+ * In memory, RGBA8 is the little endian word 0xRRGGBBAA, RGB8 the bytes B, G, R, and the 16 bit
+ * formats little endian halfwords with red in the top bits.
+ */
+
+namespace Pica {
+namespace Color {
+
+/// Reads the pixel at `src` as 0xRRGGBBAA.
+u32 DecodePixel(PixelFormat format, const u8* src);
+
+/// Writes `rgba` (0xRRGGBBAA) to `dst`, using BytesPerPixel(format) bytes.
+void EncodePixel(PixelFormat format, u32 rgba, u8* dst);
+
+/// Converts `count` pixels from `src` to `dst`. The buffers must not overlap.
+void Convert(PixelFormat in, PixelFormat out, const u8* src, u8* dst, size_t count);
+void Convert(Kernel kernel, PixelFormat in, PixelFormat out, const u8* src, u8* dst, size_t count);
+
+} // namespace
+} // namespace
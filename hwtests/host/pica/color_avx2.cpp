@@ -0,0 +1,146 @@
+#include <cstring>
+#include <immintrin.h>
+
+#include "pica/color_kernels.h"
+
+// Built with -mavx2. Only called once IsSupported() has checked the CPU.
+
+namespace Pica {
+namespace Color {
+
+static __m256i Pack(__m256i r, __m256i g, __m256i b, __m256i a)
+{
+    return _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(r, 24), _mm256_slli_epi32(g, 16)),
+                           _mm256_or_si256(_mm256_slli_epi32(b, 8), a));
+}
+
+static __m256i Field(__m256i value, int shift, u32 mask)
+{
+    return _mm256_and_si256(_mm256_srli_epi32(value, shift), _mm256_set1_epi32(mask));
+}
+
+static __m256i Expand(__m256i value, int left, int right)
+{
+    return _mm256_or_si256(_mm256_slli_epi32(value, left), _mm256_srli_epi32(value, right));
+}
+
+static __m256i DecodeRGB565Words(__m256i value)
+{
+    return Pack(Expand(Field(value, 11, 0x1F), 3, 2), Expand(Field(value, 5, 0x3F), 2, 4),
+                Expand(Field(value, 0, 0x1F), 3, 2), _mm256_set1_epi32(0xFF));
+}
+
+static __m256i DecodeRGB5A1Words(__m256i value)
+{
+    const __m256i alpha = _mm256_mullo_epi32(Field(value, 0, 1), _mm256_set1_epi32(0xFF));
+    return Pack(Expand(Field(value, 11, 0x1F), 3, 2), Expand(Field(value, 6, 0x1F), 3, 2),
+                Expand(Field(value, 1, 0x1F), 3, 2), alpha);
+}
+
+static __m256i DecodeRGBA4Words(__m256i value)
+{
+    return Pack(Expand(Field(value, 12, 0xF), 4, 0), Expand(Field(value, 8, 0xF), 4, 0),
+                Expand(Field(value, 4, 0xF), 4, 0), Expand(Field(value, 0, 0xF), 4, 0));
+}
+
+static __m256i EncodeRGB565Words(__m256i value)
+{
+    return _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(Field(value, 27, 0x1F), 11), _mm256_slli_epi32(Field(value, 18, 0x3F), 5)),
+                           Field(value, 11, 0x1F));
+}
+
+static __m256i EncodeRGB5A1Words(__m256i value)
+{
+    return _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(Field(value, 27, 0x1F), 11), _mm256_slli_epi32(Field(value, 19, 0x1F), 6)),
+                           _mm256_or_si256(_mm256_slli_epi32(Field(value, 11, 0x1F), 1), Field(value, 7, 1)));
+}
+
+static __m256i EncodeRGBA4Words(__m256i value)
+{
+    return _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(Field(value, 28, 0xF), 12), _mm256_slli_epi32(Field(value, 20, 0xF), 8)),
+                           _mm256_or_si256(_mm256_slli_epi32(Field(value, 12, 0xF), 4), Field(value, 4, 0xF)));
+}
+
+// 16 bit formats, sixteen pixels per step
+template <PixelFormat format, __m256i (*words)(__m256i)>
+static void Decode16(const u8* src, u32* rgba, size_t count)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i low = _mm_loadu_si128((const __m128i*)(src + i * 2));
+        const __m128i high = _mm_loadu_si128((const __m128i*)(src + i * 2 + 16));
+        _mm256_storeu_si256((__m256i*)(rgba + i), words(_mm256_cvtepu16_epi32(low)));
+        _mm256_storeu_si256((__m256i*)(rgba + i + 8), words(_mm256_cvtepu16_epi32(high)));
+    }
+    DecodeScalar(format, src + i * 2, rgba + i, count - i);
+}
+
+template <PixelFormat format, __m256i (*halfwords)(__m256i)>
+static void Encode16(const u32* rgba, u8* dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i low = halfwords(_mm256_loadu_si256((const __m256i*)(rgba + i)));
+        const __m256i high = halfwords(_mm256_loadu_si256((const __m256i*)(rgba + i + 8)));
+        // packus works within each 128 bit lane, so put the quarters back in order
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(low, high), 0xD8);
+        _mm256_storeu_si256((__m256i*)(dst + i * 2), packed);
+    }
+    EncodeScalar(format, rgba + i, dst + i * 2, count - i);
+}
+
+static void DecodeRGBA8(const u8* src, u32* rgba, size_t count)
+{
+    memcpy(rgba, src, count * 4);
+}
+
+static void DecodeRGB8(const u8* src, u32* rgba, size_t count)
+{
+    const __m256i shuffle = _mm256_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+                                             -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    const __m256i alpha = _mm256_set1_epi32(0xFF);
+    size_t i = 0;
+    // Pixels 4-7 are loaded as 16 bytes from pixel 4, so stop while 16 bytes are left after it
+    for (; i + 10 <= count; i += 8) {
+        const __m128i low = _mm_loadu_si128((const __m128i*)(src + i * 3));
+        const __m128i high = _mm_loadu_si128((const __m128i*)(src + i * 3 + 12));
+        const __m256i bytes = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+        _mm256_storeu_si256((__m256i*)(rgba + i), _mm256_or_si256(_mm256_shuffle_epi8(bytes, shuffle), alpha));
+    }
+    DecodeScalar(PixelFormat::RGB8, src + i * 3, rgba + i, count - i);
+}
+
+static void EncodeRGBA8(const u32* rgba, u8* dst, size_t count)
+{
+    memcpy(dst, rgba, count * 4);
+}
+
+static void EncodeRGB8(const u32* rgba, u8* dst, size_t count)
+{
+    const __m256i shuffle = _mm256_setr_epi8(1, 2, 3, 5, 6, 7, 9, 10, 11, 13, 14, 15, -1, -1, -1, -1,
+                                             1, 2, 3, 5, 6, 7, 9, 10, 11, 13, 14, 15, -1, -1, -1, -1);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i bytes = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(rgba + i)), shuffle);
+        // The first 12 bytes of each lane are pixels; the 4 after the first lane are overwritten
+        // by the second
+        _mm_storeu_si128((__m128i*)(dst + i * 3), _mm256_castsi256_si128(bytes));
+        const __m128i high = _mm256_extracti128_si256(bytes, 1);
+        _mm_storel_epi64((__m128i*)(dst + i * 3 + 12), high);
+        const u32 last = _mm_extract_epi32(high, 2);
+        memcpy(dst + i * 3 + 20, &last, 4);
+    }
+    EncodeScalar(PixelFormat::RGB8, rgba + i, dst + i * 3, count - i);
+}
+
+static const Kernels kernels = {
+    { DecodeRGBA8, DecodeRGB8, Decode16<PixelFormat::RGB565, DecodeRGB565Words>,
+      Decode16<PixelFormat::RGB5A1, DecodeRGB5A1Words>, Decode16<PixelFormat::RGBA4, DecodeRGBA4Words> },
+    { EncodeRGBA8, EncodeRGB8, Encode16<PixelFormat::RGB565, EncodeRGB565Words>,
+      Encode16<PixelFormat::RGB5A1, EncodeRGB5A1Words>, Encode16<PixelFormat::RGBA4, EncodeRGBA4Words> },
+};
+
+const Kernels* const avx2_kernels = &kernels;
+
+} // namespace
+} // namespace
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "pica/color.h"
+
+// Internal to the color conversion library: the kernels of each instruction set, which decode
+// pixels to 0xRRGGBBAA words and encode them back, `count` pixels at a time.
+
+namespace Pica {
+namespace Color {
+
+typedef void (*DecodeFunc)(const u8* src, u32* rgba, size_t count);
+typedef void (*EncodeFunc)(const u32* rgba, u8* dst, size_t count);
+
+struct Kernels {
+    DecodeFunc decode[NUM_PIXEL_FORMATS];
+    EncodeFunc encode[NUM_PIXEL_FORMATS];
+};
+
+extern const Kernels scalar_kernels;
+extern const Kernels vector_kernels;
+// nullptr if not built for this target
+extern const Kernels* const sse41_kernels;
+extern const Kernels* const avx2_kernels;
+
+// Per pixel helpers, also used for the tails the vector kernels leave
+void DecodeScalar(PixelFormat format, const u8* src, u32* rgba, size_t count);
+void EncodeScalar(PixelFormat format, const u32* rgba, u8* dst, size_t count);
+
+} // namespace
+} // namespace
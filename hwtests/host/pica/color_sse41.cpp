@@ -0,0 +1,135 @@
+#include <cstring>
+#include <smmintrin.h>
+
+#include "pica/color_kernels.h"
+
+// Built with -msse4.1. Only called once IsSupported() has checked the CPU.
+
+namespace Pica {
+namespace Color {
+
+static __m128i Pack(__m128i r, __m128i g, __m128i b, __m128i a)
+{
+    return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(r, 24), _mm_slli_epi32(g, 16)),
+                        _mm_or_si128(_mm_slli_epi32(b, 8), a));
+}
+
+static __m128i Field(__m128i value, int shift, u32 mask)
+{
+    return _mm_and_si128(_mm_srli_epi32(value, shift), _mm_set1_epi32(mask));
+}
+
+static __m128i Expand(__m128i value, int left, int right)
+{
+    return _mm_or_si128(_mm_slli_epi32(value, left), _mm_srli_epi32(value, right));
+}
+
+static __m128i DecodeRGB565Words(__m128i value)
+{
+    return Pack(Expand(Field(value, 11, 0x1F), 3, 2), Expand(Field(value, 5, 0x3F), 2, 4),
+                Expand(Field(value, 0, 0x1F), 3, 2), _mm_set1_epi32(0xFF));
+}
+
+static __m128i DecodeRGB5A1Words(__m128i value)
+{
+    const __m128i alpha = _mm_mullo_epi32(Field(value, 0, 1), _mm_set1_epi32(0xFF));
+    return Pack(Expand(Field(value, 11, 0x1F), 3, 2), Expand(Field(value, 6, 0x1F), 3, 2),
+                Expand(Field(value, 1, 0x1F), 3, 2), alpha);
+}
+
+static __m128i DecodeRGBA4Words(__m128i value)
+{
+    return Pack(Expand(Field(value, 12, 0xF), 4, 0), Expand(Field(value, 8, 0xF), 4, 0),
+                Expand(Field(value, 4, 0xF), 4, 0), Expand(Field(value, 0, 0xF), 4, 0));
+}
+
+static __m128i EncodeRGB565Words(__m128i value)
+{
+    return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(Field(value, 27, 0x1F), 11), _mm_slli_epi32(Field(value, 18, 0x3F), 5)),
+                        Field(value, 11, 0x1F));
+}
+
+static __m128i EncodeRGB5A1Words(__m128i value)
+{
+    return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(Field(value, 27, 0x1F), 11), _mm_slli_epi32(Field(value, 19, 0x1F), 6)),
+                        _mm_or_si128(_mm_slli_epi32(Field(value, 11, 0x1F), 1), Field(value, 7, 1)));
+}
+
+static __m128i EncodeRGBA4Words(__m128i value)
+{
+    return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(Field(value, 28, 0xF), 12), _mm_slli_epi32(Field(value, 20, 0xF), 8)),
+                        _mm_or_si128(_mm_slli_epi32(Field(value, 12, 0xF), 4), Field(value, 4, 0xF)));
+}
+
+// 16 bit formats, eight pixels per step
+template <PixelFormat format, __m128i (*words)(__m128i)>
+static void Decode16(const u8* src, u32* rgba, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i value = _mm_loadu_si128((const __m128i*)(src + i * 2));
+        _mm_storeu_si128((__m128i*)(rgba + i), words(_mm_cvtepu16_epi32(value)));
+        _mm_storeu_si128((__m128i*)(rgba + i + 4), words(_mm_cvtepu16_epi32(_mm_srli_si128(value, 8))));
+    }
+    DecodeScalar(format, src + i * 2, rgba + i, count - i);
+}
+
+template <PixelFormat format, __m128i (*halfwords)(__m128i)>
+static void Encode16(const u32* rgba, u8* dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i low = halfwords(_mm_loadu_si128((const __m128i*)(rgba + i)));
+        const __m128i high = halfwords(_mm_loadu_si128((const __m128i*)(rgba + i + 4)));
+        _mm_storeu_si128((__m128i*)(dst + i * 2), _mm_packus_epi32(low, high));
+    }
+    EncodeScalar(format, rgba + i, dst + i * 2, count - i);
+}
+
+static void DecodeRGBA8(const u8* src, u32* rgba, size_t count)
+{
+    memcpy(rgba, src, count * 4);
+}
+
+static void DecodeRGB8(const u8* src, u32* rgba, size_t count)
+{
+    const __m128i shuffle = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    const __m128i alpha = _mm_set1_epi32(0xFF);
+    size_t i = 0;
+    // Each load reads 16 bytes for 4 pixels, so stop while 16 bytes are left
+    for (; i + 6 <= count; i += 4) {
+        const __m128i bytes = _mm_loadu_si128((const __m128i*)(src + i * 3));
+        _mm_storeu_si128((__m128i*)(rgba + i), _mm_or_si128(_mm_shuffle_epi8(bytes, shuffle), alpha));
+    }
+    DecodeScalar(PixelFormat::RGB8, src + i * 3, rgba + i, count - i);
+}
+
+static void EncodeRGBA8(const u32* rgba, u8* dst, size_t count)
+{
+    memcpy(dst, rgba, count * 4);
+}
+
+static void EncodeRGB8(const u32* rgba, u8* dst, size_t count)
+{
+    const __m128i shuffle = _mm_setr_epi8(1, 2, 3, 5, 6, 7, 9, 10, 11, 13, 14, 15, -1, -1, -1, -1);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i bytes = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(rgba + i)), shuffle);
+        _mm_storel_epi64((__m128i*)(dst + i * 3), bytes);
+        const u32 last = _mm_extract_epi32(bytes, 2);
+        memcpy(dst + i * 3 + 8, &last, 4);
+    }
+    EncodeScalar(PixelFormat::RGB8, rgba + i, dst + i * 3, count - i);
+}
+
+static const Kernels kernels = {
+    { DecodeRGBA8, DecodeRGB8, Decode16<PixelFormat::RGB565, DecodeRGB565Words>,
+      Decode16<PixelFormat::RGB5A1, DecodeRGB5A1Words>, Decode16<PixelFormat::RGBA4, DecodeRGBA4Words> },
+    { EncodeRGBA8, EncodeRGB8, Encode16<PixelFormat::RGB565, EncodeRGB565Words>,
+      Encode16<PixelFormat::RGB5A1, EncodeRGB5A1Words>, Encode16<PixelFormat::RGBA4, EncodeRGBA4Words> },
+};
+
+const Kernels* const sse41_kernels = &kernels;
+
+} // namespace
+} // namespace
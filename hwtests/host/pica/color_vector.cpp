@@ -0,0 +1,163 @@
+#include <cstring>
+
+#include "pica/color_kernels.h"
+
+// Written with GCC vector extensions instead of intrinsics, so the same code becomes NEON on ARM
+// and SSE2 on x86.
+
+namespace Pica {
+namespace Color {
+
+typedef u8 V8 __attribute__((vector_size(16)));
+typedef u16 V16 __attribute__((vector_size(8)));
+typedef u32 V32 __attribute__((vector_size(16)));
+
+// Four pixels per vector
+static const size_t LANES = 4;
+
+static V32 Load16(const u8* src)
+{
+    V16 value;
+    memcpy(&value, src, sizeof(value));
+    return __builtin_convertvector(value, V32);
+}
+
+static void Store16(u8* dst, V32 value)
+{
+    const V16 narrow = __builtin_convertvector(value, V16);
+    memcpy(dst, &narrow, sizeof(narrow));
+}
+
+static V32 Pack(V32 r, V32 g, V32 b, V32 a)
+{
+    return (r << 24) | (g << 16) | (b << 8) | a;
+}
+
+static V32 Expand5(V32 value) { return (value << 3) | (value >> 2); }
+static V32 Expand6(V32 value) { return (value << 2) | (value >> 4); }
+static V32 Expand4(V32 value) { return (value << 4) | value; }
+
+static void DecodeRGBA8(const u8* src, u32* rgba, size_t count)
+{
+    memcpy(rgba, src, count * 4);
+}
+
+static void DecodeRGB8(const u8* src, u32* rgba, size_t count)
+{
+    const V8 alpha = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                       0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    size_t i = 0;
+    // Each load reads 16 bytes for 4 pixels, so stop while 16 bytes are left
+    for (; i + 6 <= count; i += LANES) {
+        V8 bytes;
+        memcpy(&bytes, src + i * 3, sizeof(bytes));
+#if defined(__clang__)
+        const V8 words = __builtin_shufflevector(bytes, alpha, 16, 0, 1, 2, 16, 3, 4, 5, 16, 6, 7, 8, 16, 9, 10, 11);
+#else
+        const V8 mask = { 16, 0, 1, 2, 16, 3, 4, 5, 16, 6, 7, 8, 16, 9, 10, 11 };
+        const V8 words = __builtin_shuffle(bytes, alpha, mask);
+#endif
+        memcpy(rgba + i, &words, sizeof(words));
+    }
+    DecodeScalar(PixelFormat::RGB8, src + i * 3, rgba + i, count - i);
+}
+
+static void DecodeRGB565(const u8* src, u32* rgba, size_t count)
+{
+    size_t i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        const V32 value = Load16(src + i * 2);
+        const V32 result = Pack(Expand5(value >> 11), Expand6((value >> 5) & 0x3F), Expand5(value & 0x1F), (V32){} + 0xFF);
+        memcpy(rgba + i, &result, sizeof(result));
+    }
+    DecodeScalar(PixelFormat::RGB565, src + i * 2, rgba + i, count - i);
+}
+
+static void DecodeRGB5A1(const u8* src, u32* rgba, size_t count)
+{
+    size_t i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        const V32 value = Load16(src + i * 2);
+        const V32 result = Pack(Expand5(value >> 11), Expand5((value >> 6) & 0x1F), Expand5((value >> 1) & 0x1F),
+                                (value & 1) * 0xFF);
+        memcpy(rgba + i, &result, sizeof(result));
+    }
+    DecodeScalar(PixelFormat::RGB5A1, src + i * 2, rgba + i, count - i);
+}
+
+static void DecodeRGBA4(const u8* src, u32* rgba, size_t count)
+{
+    size_t i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        const V32 value = Load16(src + i * 2);
+        const V32 result = Pack(Expand4(value >> 12), Expand4((value >> 8) & 0xF), Expand4((value >> 4) & 0xF),
+                                Expand4(value & 0xF));
+        memcpy(rgba + i, &result, sizeof(result));
+    }
+    DecodeScalar(PixelFormat::RGBA4, src + i * 2, rgba + i, count - i);
+}
+
+static void EncodeRGBA8(const u32* rgba, u8* dst, size_t count)
+{
+    memcpy(dst, rgba, count * 4);
+}
+
+static void EncodeRGB8(const u32* rgba, u8* dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        V8 words;
+        memcpy(&words, rgba + i, sizeof(words));
+#if defined(__clang__)
+        const V8 bytes = __builtin_shufflevector(words, words, 1, 2, 3, 5, 6, 7, 9, 10, 11, 13, 14, 15, 0, 0, 0, 0);
+#else
+        const V8 mask = { 1, 2, 3, 5, 6, 7, 9, 10, 11, 13, 14, 15, 0, 0, 0, 0 };
+        const V8 bytes = __builtin_shuffle(words, mask);
+#endif
+        memcpy(dst + i * 3, &bytes, 12);
+    }
+    EncodeScalar(PixelFormat::RGB8, rgba + i, dst + i * 3, count - i);
+}
+
+static void EncodeRGB565(const u32* rgba, u8* dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        V32 value;
+        memcpy(&value, rgba + i, sizeof(value));
+        Store16(dst + i * 2, ((value >> 27) << 11) | (((value >> 18) & 0x3F) << 5) | ((value >> 11) & 0x1F));
+    }
+    EncodeScalar(PixelFormat::RGB565, rgba + i, dst + i * 2, count - i);
+}
+
+static void EncodeRGB5A1(const u32* rgba, u8* dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        V32 value;
+        memcpy(&value, rgba + i, sizeof(value));
+        Store16(dst + i * 2, ((value >> 27) << 11) | (((value >> 19) & 0x1F) << 6) |
+                             (((value >> 11) & 0x1F) << 1) | ((value >> 7) & 1));
+    }
+    EncodeScalar(PixelFormat::RGB5A1, rgba + i, dst + i * 2, count - i);
+}
+
+static void EncodeRGBA4(const u32* rgba, u8* dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        V32 value;
+        memcpy(&value, rgba + i, sizeof(value));
+        Store16(dst + i * 2, ((value >> 28) << 12) | (((value >> 20) & 0xF) << 8) |
+                             (((value >> 12) & 0xF) << 4) | ((value >> 4) & 0xF));
+    }
+    EncodeScalar(PixelFormat::RGBA4, rgba + i, dst + i * 2, count - i);
+}
+
+const Kernels vector_kernels = {
+    { DecodeRGBA8, DecodeRGB8, DecodeRGB565, DecodeRGB5A1, DecodeRGBA4 },
+    { EncodeRGBA8, EncodeRGB8, EncodeRGB565, EncodeRGB5A1, EncodeRGBA4 },
+};
+
+} // namespace
+} // namespace
@@ -0,0 +1,134 @@
+#include <cstring>
+#include <vector>
+
+#include "pica/color.h"
+#include "pica/display_transfer.h"
+#include "pica/tiling.h"
+
+namespace Pica {
+namespace DisplayTransfer {
+
+// Output rows converted per step: one row of tiles on the output side, and one or two on the
+// input side, so that the intermediate buffers stay small
+static const u32 STRIP_ROWS = 8;
+
+Config Config::FromRegisters(u32 input_dimensions, u32 output_dimensions, u32 flags)
+{
+    Config config;
+    config.input_width = input_dimensions & 0xFFFF;
+    config.input_height = input_dimensions >> 16;
+    config.output_width = output_dimensions & 0xFFFF;
+    config.output_height = output_dimensions >> 16;
+    config.input_format = (PixelFormat)((flags >> 8) & 7);
+    config.output_format = (PixelFormat)((flags >> 12) & 7);
+    config.scaling = (Scale::Scaling)((flags >> 24) & 3);
+    config.flags = flags;
+    return config;
+}
+
+u32 Config::ScaledWidth() const
+{
+    return output_width / Scale::ScaleX(scaling);
+}
+
+u32 Config::ScaledHeight() const
+{
+    return output_height / Scale::ScaleY(scaling);
+}
+
+bool IsValid(const Config& config)
+{
+    if ((u32)config.input_format >= NUM_PIXEL_FORMATS || (u32)config.output_format >= NUM_PIXEL_FORMATS)
+        return false;
+    if ((u32)config.scaling > (u32)Scale::Scaling::Both)
+        return false;
+    if (config.flags & (RAW_COPY | NO_SWIZZLE))
+        return true;
+
+    // The input region is the output register size, the output that after scaling
+    const bool tiled_input = !(config.flags & LINEAR_TO_TILED);
+    const u32 width = tiled_input ? config.output_width : config.ScaledWidth();
+    const u32 height = tiled_input ? config.output_height : config.ScaledHeight();
+    return width % 8 == 0 && height % 8 == 0;
+}
+
+static void RawCopy(const Config& config, const u8* input, u8* output)
+{
+    memcpy(output, input, (size_t)config.output_width * config.output_height * BytesPerPixel(config.input_format));
+}
+
+bool Run(Kernel kernel, const Config& config, const u8* input, u8* output)
+{
+    if (!IsValid(config))
+        return false;
+
+    if (config.flags & RAW_COPY) {
+        RawCopy(config, input, output);
+        return true;
+    }
+
+    const bool keep_layout = config.flags & NO_SWIZZLE;
+    const bool tiled_input = !keep_layout && !(config.flags & LINEAR_TO_TILED);
+    const bool tiled_output = !keep_layout && (config.flags & LINEAR_TO_TILED);
+    const PixelFormat in_format = config.input_format;
+    const PixelFormat out_format = config.output_format;
+    const u32 in_bpp = BytesPerPixel(in_format);
+    const u32 out_bpp = BytesPerPixel(out_format);
+    const u32 scale_y = Scale::ScaleY(config.scaling);
+    const u32 in_width = config.output_width;
+    const u32 out_width = config.ScaledWidth();
+    const u32 out_height = config.ScaledHeight();
+
+    // Without conversion or scaling, only the layout changes
+    if (in_format == out_format && config.scaling == Scale::Scaling::None) {
+        if (tiled_input)
+            Tiling::TiledToLinear(kernel, input, output, out_width * out_bpp, out_width, out_height, out_bpp, 1);
+        else if (tiled_output)
+            Tiling::LinearToTiled(kernel, input, in_width * in_bpp, output, out_width, out_height, out_bpp, 1);
+        else
+            memcpy(output, input, (size_t)out_width * out_height * out_bpp);
+        return true;
+    }
+
+    std::vector<u8> in_linear(tiled_input ? (size_t)in_width * STRIP_ROWS * scale_y * in_bpp : 0);
+    std::vector<u32> rgba((size_t)in_width * STRIP_ROWS * scale_y);
+    std::vector<u32> scaled(config.scaling == Scale::Scaling::None ? 0 : (size_t)out_width * STRIP_ROWS);
+    std::vector<u8> out_linear(tiled_output ? (size_t)out_width * STRIP_ROWS * out_bpp : 0);
+
+    for (u32 y = 0; y < out_height; y += STRIP_ROWS) {
+        const u32 rows = out_height - y < STRIP_ROWS ? out_height - y : STRIP_ROWS;
+        const u32 in_rows = rows * scale_y;
+
+        // Tiles are stored a row of tiles at a time, so strips start at the same offset in both layouts
+        const u8* src = input + (size_t)y * scale_y * in_width * in_bpp;
+        u8* dst = output + (size_t)y * out_width * out_bpp;
+
+        if (tiled_input) {
+            Tiling::TiledToLinear(kernel, src, in_linear.data(), in_width * in_bpp, in_width, in_rows, in_bpp, 1);
+            src = in_linear.data();
+        }
+        Color::Convert(kernel, in_format, PixelFormat::RGBA8, src, (u8*)rgba.data(), (size_t)in_width * in_rows);
+
+        const u32* pixels = rgba.data();
+        if (config.scaling != Scale::Scaling::None) {
+            Scale::Downscale(kernel, config.scaling, rgba.data(), in_width, scaled.data(), out_width, out_width, rows);
+            pixels = scaled.data();
+        }
+
+        if (tiled_output) {
+            Color::Convert(kernel, PixelFormat::RGBA8, out_format, (const u8*)pixels, out_linear.data(), (size_t)out_width * rows);
+            Tiling::LinearToTiled(kernel, out_linear.data(), out_width * out_bpp, dst, out_width, rows, out_bpp, 1);
+        } else {
+            Color::Convert(kernel, PixelFormat::RGBA8, out_format, (const u8*)pixels, dst, (size_t)out_width * rows);
+        }
+    }
+    return true;
+}
+
+bool Run(const Config& config, const u8* input, u8* output)
+{
+    return Run(BestKernel(), config, input, output);
+}
+
+} // namespace
+} // namespace
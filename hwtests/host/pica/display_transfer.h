@@ -0,0 +1,56 @@
+#pragma once
+
+#include "pica/kernel.h"
+#include "pica/scale.h"
+
+/**
+ * The DisplayTransfer engine: copies a surface between the tiled and the linear layout,
+ * converting its pixel format and optionally downscaling it, as recorded by the DisplayTransfer
+ * tests in hwtests.
+ *
+ * The output register dimensions select the region transferred. The input is read as a surface of
+ * that size, whatever its own register says (RGBA8_To_RGB8_Different_Sizes shows this for tiled
+ * input; linear input is assumed to behave the same), and the output is that size divided by the
+ * downscale factor. The tiled side must be a multiple of 8 pixels wide and high.
+ */
+
+namespace Pica {
+namespace DisplayTransfer {
+
+/// Bits of the flags register the model implements. The others have no effect.
+enum Flags : u32 {
+    /// Linear input to tiled output, instead of tiled to linear.
+    LINEAR_TO_TILED = 1 << 1,
+    /// Copies the input bytes unchanged, without conversion, tiling or scaling.
+    RAW_COPY = 1 << 3,
+    /// Keeps the input's pixel order, converting and scaling it as if both sides were linear.
+    NO_SWIZZLE = 1 << 5,
+};
+
+struct Config {
+    u32 input_width;
+    u32 input_height;
+    u32 output_width;
+    u32 output_height;
+    PixelFormat input_format;
+    PixelFormat output_format;
+    Scale::Scaling scaling;
+    u32 flags;
+
+    /// Decodes the register values, where dimensions are height << 16 | width.
+    static Config FromRegisters(u32 input_dimensions, u32 output_dimensions, u32 flags);
+
+    /// Size of the output in pixels, after downscaling.
+    u32 ScaledWidth() const;
+    u32 ScaledHeight() const;
+};
+
+/// Whether the model can run `config`: valid formats and scaling, and whole tiles on the tiled side.
+bool IsValid(const Config& config);
+
+/// Runs the transfer. Returns false, leaving `output` alone, if the configuration is not valid.
+bool Run(const Config& config, const u8* input, u8* output);
+bool Run(Kernel kernel, const Config& config, const u8* input, u8* output);
+
+} // namespace
+} // namespace
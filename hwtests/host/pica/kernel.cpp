@@ -0,0 +1,40 @@
+#include "pica/kernel.h"
+
+namespace Pica {
+
+const char* KernelName(Kernel kernel)
+{
+    static const char* names[NUM_KERNELS] = { "scalar", "vector", "SSE4.1", "AVX2" };
+    return names[(u32)kernel];
+}
+
+bool IsSupported(Kernel kernel)
+{
+    switch (kernel) {
+    case Kernel::Scalar:
+    case Kernel::Vector:
+        return true;
+#if defined(__x86_64__) || defined(__i386__)
+    case Kernel::SSE41:
+        return __builtin_cpu_supports("sse4.1");
+    case Kernel::AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+Kernel BestKernel()
+{
+    static const Kernel best = [] {
+        if (IsSupported(Kernel::AVX2))
+            return Kernel::AVX2;
+        if (IsSupported(Kernel::SSE41))
+            return Kernel::SSE41;
+        return Kernel::Vector;
+    }();
+    return best;
+}
+
+} // namespace
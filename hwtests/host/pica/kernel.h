@@ -0,0 +1,30 @@
+#pragma once
+
+#include "pica/types.h"
+
+/**
+ * The models' inner loops are implemented several times: in plain C++, with generic vector code
+ * (which the compiler turns into NEON on ARM), and with SSE4.1 and AVX2 on x86. Every
+ * implementation produces the same output; by default the fastest one the CPU supports is used.
+ */
+
+namespace Pica {
+
+enum class Kernel {
+    Scalar,
+    Vector,
+    SSE41,
+    AVX2,
+};
+
+static const u32 NUM_KERNELS = 4;
+
+const char* KernelName(Kernel kernel);
+
+/// Whether `kernel` was built in and can run on this CPU.
+bool IsSupported(Kernel kernel);
+
+/// The fastest supported kernel.
+Kernel BestKernel();
+
+} // namespace
@@ -0,0 +1,72 @@
+#include <cstring>
+
+#include "pica/memory_fill_kernels.h"
+
+namespace Pica {
+namespace MemoryFill {
+
+// Stores 8 bytes at a time
+static void FillScalar(u8* dst, size_t size, const u8* pattern)
+{
+    u64 words[PATTERN_PERIOD / 8];
+    memcpy(words, pattern, sizeof(words));
+
+    for (; size >= PATTERN_PERIOD; size -= PATTERN_PERIOD) {
+        for (u64 word : words) {
+            memcpy(dst, &word, sizeof(word));
+            dst += sizeof(word);
+        }
+    }
+    memcpy(dst, pattern, size);
+}
+
+const FillFunc fill_scalar = FillScalar;
+
+#if !defined(__x86_64__) && !defined(__i386__)
+const FillFunc fill_sse41 = nullptr;
+const FillFunc fill_avx2 = nullptr;
+#endif
+
+static FillFunc GetKernel(Kernel kernel)
+{
+    switch (kernel) {
+    case Kernel::Vector:
+        return fill_vector;
+    case Kernel::SSE41:
+        return fill_sse41;
+    case Kernel::AVX2:
+        return fill_avx2;
+    default:
+        return fill_scalar;
+    }
+}
+
+Width WidthFromControl(u32 control)
+{
+    const u32 width = (control >> 8) & 3;
+    return width == 3 ? Width::Bits32 : (Width)width;
+}
+
+static u32 BytesPerValue(Width width)
+{
+    return (u32)width + 2;
+}
+
+void Fill(Kernel kernel, u8* dst, size_t size, u32 value, Width width)
+{
+    const u32 bytes = BytesPerValue(width);
+
+    alignas(32) u8 pattern[PATTERN_SIZE];
+    for (size_t i = 0; i < PATTERN_SIZE; ++i)
+        pattern[i] = value >> (i % bytes * 8);
+
+    GetKernel(kernel)(dst, size, pattern);
+}
+
+void Fill(u8* dst, size_t size, u32 value, Width width)
+{
+    Fill(BestKernel(), dst, size, value, width);
+}
+
+} // namespace
+} // namespace
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "pica/kernel.h"
+
+/**
+ * The MemoryFill engines, as recorded by the MemoryFills tests in hwtests: a range of memory is
+ * filled with the low 2, 3 or 4 bytes of a value, little endian, repeated from the start of the
+ * range. A 24 bit fill repeats 3 bytes, so its pattern is not aligned to words; a range that does
+ * not hold a whole number of values ends with part of one.
+ */
+
+namespace Pica {
+namespace MemoryFill {
+
+/// Sizes of the fill value, with their values in bits 8-9 of the control register.
+enum class Width : u32 {
+    Bits16 = 0,
+    Bits24 = 1,
+    Bits32 = 2,
+};
+
+/// Bits of the control register.
+enum Control : u32 {
+    START = 1 << 0,
+    FINISHED = 1 << 1,
+};
+
+/// The fill width selected by `control`. Both 2 and 3 select 32 bits.
+Width WidthFromControl(u32 control);
+
+/// Fills `size` bytes at `dst` with `value`.
+void Fill(u8* dst, size_t size, u32 value, Width width);
+void Fill(Kernel kernel, u8* dst, size_t size, u32 value, Width width);
+
+} // namespace
+} // namespace
@@ -0,0 +1,49 @@
+#include <cstring>
+#include <immintrin.h>
+
+#include "pica/memory_fill_kernels.h"
+
+// Built with -mavx2. Only called once IsSupported() has checked the CPU.
+
+namespace Pica {
+namespace MemoryFill {
+
+static void Fill(u8* dst, size_t size, const u8* pattern)
+{
+    // Aligns `dst` to 32 bytes, and the pattern registers with it
+    const size_t head = (32 - (uintptr_t)dst % 32) % 32;
+    if (size <= head) {
+        memcpy(dst, pattern, size);
+        return;
+    }
+    memcpy(dst, pattern, head);
+    dst += head;
+    size -= head;
+    pattern += head;
+
+    const __m256i v0 = _mm256_loadu_si256((const __m256i*)pattern);
+    const __m256i v1 = _mm256_loadu_si256((const __m256i*)(pattern + 32));
+    const __m256i v2 = _mm256_loadu_si256((const __m256i*)(pattern + 64));
+
+    __m256i* out = (__m256i*)dst;
+    if (size >= STREAM_MIN_SIZE) {
+        for (; size >= PATTERN_PERIOD; size -= PATTERN_PERIOD, out += 3) {
+            _mm256_stream_si256(out, v0);
+            _mm256_stream_si256(out + 1, v1);
+            _mm256_stream_si256(out + 2, v2);
+        }
+        _mm_sfence();
+    } else {
+        for (; size >= PATTERN_PERIOD; size -= PATTERN_PERIOD, out += 3) {
+            _mm256_store_si256(out, v0);
+            _mm256_store_si256(out + 1, v1);
+            _mm256_store_si256(out + 2, v2);
+        }
+    }
+    memcpy(out, pattern, size);
+}
+
+const FillFunc fill_avx2 = Fill;
+
+} // namespace
+} // namespace
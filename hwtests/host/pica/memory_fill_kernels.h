@@ -0,0 +1,30 @@
+#pragma once
+
+#include "pica/memory_fill.h"
+
+// Internal to the memory fill library. Every width repeats within PATTERN_PERIOD bytes, so a
+// kernel loads that many bytes of the pattern into registers once and stores them over and over.
+// It may first store a few bytes to align `dst`, and then load the registers from further into
+// the pattern, which is why the pattern is longer than one period.
+
+namespace Pica {
+namespace MemoryFill {
+
+static const size_t PATTERN_PERIOD = 96;
+static const size_t PATTERN_SIZE = 128;
+
+/// Fills `size` bytes at `dst` with the first bytes of `pattern`, repeated every PATTERN_PERIOD bytes.
+typedef void (*FillFunc)(u8* dst, size_t size, const u8* pattern);
+
+extern const FillFunc fill_scalar;
+extern const FillFunc fill_vector;
+// nullptr if not built for this target
+extern const FillFunc fill_sse41;
+extern const FillFunc fill_avx2;
+
+// Fills larger than this bypass the caches. They are larger than any framebuffer, and are
+// unlikely to be read back soon.
+static const size_t STREAM_MIN_SIZE = 2 * 1024 * 1024;
+
+} // namespace
+} // namespace
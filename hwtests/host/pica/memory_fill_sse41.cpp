@@ -0,0 +1,58 @@
+#include <cstring>
+#include <smmintrin.h>
+
+#include "pica/memory_fill_kernels.h"
+
+// Built with -msse4.1. Only called once IsSupported() has checked the CPU.
+
+namespace Pica {
+namespace MemoryFill {
+
+static void Fill(u8* dst, size_t size, const u8* pattern)
+{
+    // Aligns `dst` to 16 bytes, and the pattern registers with it
+    const size_t head = (16 - (uintptr_t)dst % 16) % 16;
+    if (size <= head) {
+        memcpy(dst, pattern, size);
+        return;
+    }
+    memcpy(dst, pattern, head);
+    dst += head;
+    size -= head;
+    pattern += head;
+
+    const __m128i v0 = _mm_loadu_si128((const __m128i*)pattern);
+    const __m128i v1 = _mm_loadu_si128((const __m128i*)(pattern + 16));
+    const __m128i v2 = _mm_loadu_si128((const __m128i*)(pattern + 32));
+    const __m128i v3 = _mm_loadu_si128((const __m128i*)(pattern + 48));
+    const __m128i v4 = _mm_loadu_si128((const __m128i*)(pattern + 64));
+    const __m128i v5 = _mm_loadu_si128((const __m128i*)(pattern + 80));
+
+    __m128i* out = (__m128i*)dst;
+    if (size >= STREAM_MIN_SIZE) {
+        for (; size >= PATTERN_PERIOD; size -= PATTERN_PERIOD, out += 6) {
+            _mm_stream_si128(out, v0);
+            _mm_stream_si128(out + 1, v1);
+            _mm_stream_si128(out + 2, v2);
+            _mm_stream_si128(out + 3, v3);
+            _mm_stream_si128(out + 4, v4);
+            _mm_stream_si128(out + 5, v5);
+        }
+        _mm_sfence();
+    } else {
+        for (; size >= PATTERN_PERIOD; size -= PATTERN_PERIOD, out += 6) {
+            _mm_store_si128(out, v0);
+            _mm_store_si128(out + 1, v1);
+            _mm_store_si128(out + 2, v2);
+            _mm_store_si128(out + 3, v3);
+            _mm_store_si128(out + 4, v4);
+            _mm_store_si128(out + 5, v5);
+        }
+    }
+    memcpy(out, pattern, size);
+}
+
+const FillFunc fill_sse41 = Fill;
+
+} // namespace
+} // namespace
@@ -0,0 +1,31 @@
+#include <cstring>
+
+#include "pica/memory_fill_kernels.h"
+
+// Written with GCC vector extensions instead of intrinsics, so the same code becomes NEON on ARM
+// and SSE2 on x86.
+
+namespace Pica {
+namespace MemoryFill {
+
+typedef u8 V8 __attribute__((vector_size(16)));
+
+static const size_t REGISTERS = PATTERN_PERIOD / sizeof(V8);
+
+static void Fill(u8* dst, size_t size, const u8* pattern)
+{
+    V8 period[REGISTERS];
+    memcpy(period, pattern, sizeof(period));
+
+    for (; size >= PATTERN_PERIOD; size -= PATTERN_PERIOD) {
+        for (size_t i = 0; i < REGISTERS; ++i)
+            memcpy(dst + i * sizeof(V8), &period[i], sizeof(V8));
+        dst += PATTERN_PERIOD;
+    }
+    memcpy(dst, pattern, size);
+}
+
+const FillFunc fill_vector = Fill;
+
+} // namespace
+} // namespace
@@ -0,0 +1,95 @@
+#include <cstring>
+
+#include "pica/scale_kernels.h"
+
+namespace Pica {
+namespace Scale {
+
+// The vector kernels work on whole words with these same steps, so that every byte is one channel
+
+static u32 Average2(u32 a, u32 b)
+{
+    // Per byte (a + b) / 2, without carries between the bytes
+    return (a & b) + (((a ^ b) >> 1) & 0x7F7F7F7F);
+}
+
+static u32 Average4(u32 a, u32 b, u32 c, u32 d)
+{
+    // Sums of four bytes need 10 bits, so the even and odd bytes are summed separately
+    const u32 even = (a & 0x00FF00FF) + (b & 0x00FF00FF) + (c & 0x00FF00FF) + (d & 0x00FF00FF);
+    const u32 odd = ((a >> 8) & 0x00FF00FF) + ((b >> 8) & 0x00FF00FF) + ((c >> 8) & 0x00FF00FF) + ((d >> 8) & 0x00FF00FF);
+    return ((even >> 2) & 0x00FF00FF) | (((odd >> 2) & 0x00FF00FF) << 8);
+}
+
+void HorizontalScalar(const u32* src, u32* dst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        dst[i] = Average2(src[i * 2], src[i * 2 + 1]);
+}
+
+void BothScalar(const u32* top, const u32* bottom, u32* dst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        dst[i] = Average4(top[i * 2], top[i * 2 + 1], bottom[i * 2], bottom[i * 2 + 1]);
+}
+
+const Kernels scalar_kernels = { HorizontalScalar, BothScalar };
+
+#if !defined(__x86_64__) && !defined(__i386__)
+const Kernels* const sse41_kernels = nullptr;
+const Kernels* const avx2_kernels = nullptr;
+#endif
+
+static const Kernels* GetKernels(Kernel kernel)
+{
+    switch (kernel) {
+    case Kernel::Vector:
+        return &vector_kernels;
+    case Kernel::SSE41:
+        return sse41_kernels;
+    case Kernel::AVX2:
+        return avx2_kernels;
+    default:
+        return &scalar_kernels;
+    }
+}
+
+u32 ScaleX(Scaling scaling)
+{
+    return scaling == Scaling::None ? 1 : 2;
+}
+
+u32 ScaleY(Scaling scaling)
+{
+    return scaling == Scaling::Both ? 2 : 1;
+}
+
+void Downscale(Kernel kernel, Scaling scaling, const u32* src, size_t src_stride, u32* dst, size_t dst_stride,
+               u32 width, u32 height)
+{
+    const Kernels* kernels = GetKernels(kernel);
+
+    for (u32 y = 0; y < height; ++y) {
+        switch (scaling) {
+        case Scaling::None:
+            memcpy(dst, src, width * sizeof(u32));
+            break;
+        case Scaling::Horizontal:
+            kernels->horizontal(src, dst, width);
+            break;
+        case Scaling::Both:
+            kernels->both(src, src + src_stride, dst, width);
+            break;
+        }
+        src += src_stride * ScaleY(scaling);
+        dst += dst_stride;
+    }
+}
+
+void Downscale(Scaling scaling, const u32* src, size_t src_stride, u32* dst, size_t dst_stride, u32 width, u32 height)
+{
+    Downscale(BestKernel(), scaling, src, src_stride, dst, dst_stride, width, height);
+}
+
+} // namespace
+} // namespace
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "pica/kernel.h"
+
+/**
+ * The box filters the DisplayTransfer engine applies when downscaling, bit exact with the
+ * RGBA8_To_RGBA8_Scaled_Blending results recorded in hwtests.
+ *
+ * Each output pixel is the average of two horizontally neighbouring input pixels, or of a 2x2
+ * block, taken separately for every channel and rounded down: 0xFF and 0x00 give 0x7F. The four
+ * pixels of a block are summed before dividing, as the emulators do; the hardware results so
+ * far do not tell this apart from averaging the two rows' averages. Pixels are 0xRRGGBBAA words,
+ * as Color::Convert produces for RGBA8.
+ */
+
+namespace Pica {
+namespace Scale {
+
+/// Downscaling modes, with their values in bits 24-25 of the DisplayTransfer flags register.
+enum class Scaling : u32 {
+    None = 0,
+    Horizontal = 1, ///< 2x1 blocks
+    Both = 2,       ///< 2x2 blocks
+};
+
+/// Input pixels averaged into one output pixel, horizontally and vertically.
+u32 ScaleX(Scaling scaling);
+u32 ScaleY(Scaling scaling);
+
+/**
+ * Downscales `src` into a `width` by `height` pixel `dst`. Strides are in pixels; `src` holds
+ * ScaleX(scaling) * width by ScaleY(scaling) * height pixels. The buffers must not overlap.
+ */
+void Downscale(Scaling scaling, const u32* src, size_t src_stride, u32* dst, size_t dst_stride, u32 width, u32 height);
+void Downscale(Kernel kernel, Scaling scaling, const u32* src, size_t src_stride, u32* dst, size_t dst_stride,
+               u32 width, u32 height);
+
+} // namespace
+} // namespace
@@ -0,0 +1,63 @@
+#include <immintrin.h>
+
+#include "pica/scale_kernels.h"
+
+// Built with -mavx2. Only called once IsSupported() has checked the CPU. The same steps as the
+// SSE4.1 kernels, eight pixels at a time.
+
+namespace Pica {
+namespace Scale {
+
+// Splits pixels 0-15 into the even and the odd ones
+static void Deinterleave(const u32* src, __m256i& even, __m256i& odd)
+{
+    const __m256 a = _mm256_loadu_ps((const float*)src);
+    const __m256 b = _mm256_loadu_ps((const float*)(src + 8));
+    // Shuffles stay within 128 bit lanes, which leaves the pixels in 0, 2, 8, 10, 4, 6, 12, 14 order
+    even = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))), 0xD8);
+    odd = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))), 0xD8);
+}
+
+static void Horizontal(const u32* src, u32* dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i a, b;
+        Deinterleave(src + i * 2, a, b);
+        // vpavgb rounds up; taking back the carried low bit rounds down instead
+        const __m256i round = _mm256_and_si256(_mm256_xor_si256(a, b), _mm256_set1_epi8(1));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_sub_epi8(_mm256_avg_epu8(a, b), round));
+    }
+    HorizontalScalar(src + i * 2, dst + i, count - i);
+}
+
+// Sums the even or the odd bytes of four vectors into 16 bit lanes
+static __m256i Sum4(__m256i a, __m256i b, __m256i c, __m256i d, __m256i mask)
+{
+    return _mm256_add_epi16(_mm256_add_epi16(_mm256_and_si256(a, mask), _mm256_and_si256(b, mask)),
+                            _mm256_add_epi16(_mm256_and_si256(c, mask), _mm256_and_si256(d, mask)));
+}
+
+static void Both(const u32* top, const u32* bottom, u32* dst, size_t count)
+{
+    const __m256i mask = _mm256_set1_epi16(0xFF);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i a, b, c, d;
+        Deinterleave(top + i * 2, a, b);
+        Deinterleave(bottom + i * 2, c, d);
+        const __m256i even = _mm256_srli_epi16(Sum4(a, b, c, d, mask), 2);
+        const __m256i odd = _mm256_srli_epi16(Sum4(_mm256_srli_epi16(a, 8), _mm256_srli_epi16(b, 8),
+                                                   _mm256_srli_epi16(c, 8), _mm256_srli_epi16(d, 8), mask), 2);
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_or_si256(even, _mm256_slli_epi16(odd, 8)));
+    }
+    BothScalar(top + i * 2, bottom + i * 2, dst + i, count - i);
+}
+
+static const Kernels kernels = { Horizontal, Both };
+
+const Kernels* const avx2_kernels = &kernels;
+
+} // namespace
+} // namespace
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "pica/scale.h"
+
+// Internal to the scaling library: the kernels of each instruction set, which produce `count`
+// pixels of one output row from one or two input rows.
+
+namespace Pica {
+namespace Scale {
+
+typedef void (*HorizontalFunc)(const u32* src, u32* dst, size_t count);
+typedef void (*BothFunc)(const u32* top, const u32* bottom, u32* dst, size_t count);
+
+struct Kernels {
+    HorizontalFunc horizontal;
+    BothFunc both;
+};
+
+extern const Kernels scalar_kernels;
+extern const Kernels vector_kernels;
+// nullptr if not built for this target
+extern const Kernels* const sse41_kernels;
+extern const Kernels* const avx2_kernels;
+
+// Also used for the tails the vector kernels leave
+void HorizontalScalar(const u32* src, u32* dst, size_t count);
+void BothScalar(const u32* top, const u32* bottom, u32* dst, size_t count);
+
+} // namespace
+} // namespace
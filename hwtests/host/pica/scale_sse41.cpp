@@ -0,0 +1,61 @@
+#include <smmintrin.h>
+
+#include "pica/scale_kernels.h"
+
+// Built with -msse4.1. Only called once IsSupported() has checked the CPU.
+
+namespace Pica {
+namespace Scale {
+
+// Splits pixels 0-7 into the even and the odd ones
+static void Deinterleave(const u32* src, __m128i& even, __m128i& odd)
+{
+    const __m128 a = _mm_loadu_ps((const float*)src);
+    const __m128 b = _mm_loadu_ps((const float*)(src + 4));
+    even = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+    odd = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+static void Horizontal(const u32* src, u32* dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i a, b;
+        Deinterleave(src + i * 2, a, b);
+        // pavgb rounds up; taking back the carried low bit rounds down instead
+        const __m128i round = _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_sub_epi8(_mm_avg_epu8(a, b), round));
+    }
+    HorizontalScalar(src + i * 2, dst + i, count - i);
+}
+
+// Sums the even or the odd bytes of four vectors into 16 bit lanes
+static __m128i Sum4(__m128i a, __m128i b, __m128i c, __m128i d, __m128i mask)
+{
+    return _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a, mask), _mm_and_si128(b, mask)),
+                         _mm_add_epi16(_mm_and_si128(c, mask), _mm_and_si128(d, mask)));
+}
+
+static void Both(const u32* top, const u32* bottom, u32* dst, size_t count)
+{
+    const __m128i mask = _mm_set1_epi16(0xFF);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i a, b, c, d;
+        Deinterleave(top + i * 2, a, b);
+        Deinterleave(bottom + i * 2, c, d);
+        const __m128i even = _mm_srli_epi16(Sum4(a, b, c, d, mask), 2);
+        const __m128i odd = _mm_srli_epi16(Sum4(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8),
+                                                _mm_srli_epi16(c, 8), _mm_srli_epi16(d, 8), mask), 2);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(even, _mm_slli_epi16(odd, 8)));
+    }
+    BothScalar(top + i * 2, bottom + i * 2, dst + i, count - i);
+}
+
+static const Kernels kernels = { Horizontal, Both };
+
+const Kernels* const sse41_kernels = &kernels;
+
+} // namespace
+} // namespace
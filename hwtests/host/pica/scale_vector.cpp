@@ -0,0 +1,69 @@
+#include <cstring>
+
+#include "pica/scale_kernels.h"
+
+// Written with GCC vector extensions instead of intrinsics, so the same code becomes NEON on ARM
+// and SSE2 on x86. The arithmetic is that of the scalar kernels, four pixels at a time.
+
+namespace Pica {
+namespace Scale {
+
+typedef u32 V32 __attribute__((vector_size(16)));
+
+static V32 Load(const u32* src)
+{
+    V32 value;
+    memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+static void Store(u32* dst, V32 value)
+{
+    memcpy(dst, &value, sizeof(value));
+}
+
+// Splits pixels 0-7 into the even and the odd ones
+static void Deinterleave(const u32* src, V32& even, V32& odd)
+{
+    const V32 a = Load(src);
+    const V32 b = Load(src + 4);
+#ifdef __clang__
+    even = __builtin_shufflevector(a, b, 0, 2, 4, 6);
+    odd = __builtin_shufflevector(a, b, 1, 3, 5, 7);
+#else
+    even = __builtin_shuffle(a, b, V32{ 0, 2, 4, 6 });
+    odd = __builtin_shuffle(a, b, V32{ 1, 3, 5, 7 });
+#endif
+}
+
+static void Horizontal(const u32* src, u32* dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        V32 a, b;
+        Deinterleave(src + i * 2, a, b);
+        Store(dst + i, (a & b) + (((a ^ b) >> 1) & 0x7F7F7F7F));
+    }
+    HorizontalScalar(src + i * 2, dst + i, count - i);
+}
+
+static void Both(const u32* top, const u32* bottom, u32* dst, size_t count)
+{
+    const u32 mask = 0x00FF00FF;
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        V32 a, b, c, d;
+        Deinterleave(top + i * 2, a, b);
+        Deinterleave(bottom + i * 2, c, d);
+        const V32 even = (a & mask) + (b & mask) + (c & mask) + (d & mask);
+        const V32 odd = ((a >> 8) & mask) + ((b >> 8) & mask) + ((c >> 8) & mask) + ((d >> 8) & mask);
+        Store(dst + i, ((even >> 2) & mask) | (((odd >> 2) & mask) << 8));
+    }
+    BothScalar(top + i * 2, bottom + i * 2, dst + i, count - i);
+}
+
+const Kernels vector_kernels = { Horizontal, Both };
+
+} // namespace
+} // namespace
@@ -0,0 +1,188 @@
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "pica/tiling_kernels.h"
+
+namespace Pica {
+namespace Tiling {
+
+// Below this, starting threads costs more than it saves
+static const size_t THREADING_MIN_BYTES = 2 * 1024 * 1024;
+static const unsigned MAX_THREADS = 8;
+
+static u32 MortonIndex(u32 x, u32 y)
+{
+    return (x & 1) | ((y & 1) << 1) | ((x & 2) << 1) | ((y & 2) << 2) | ((x & 4) << 2) | ((y & 4) << 3);
+}
+
+u32 TiledIndex(u32 x, u32 y, u32 width)
+{
+    return ((y / 8) * (width / 8) + x / 8) * 64 + MortonIndex(x % 8, y % 8);
+}
+
+// Copies a pair of pixels at a time, which are next to each other in both layouts
+static inline __attribute__((always_inline)) void TileScalar(u32 bpp, const u8* linear, size_t stride, u8* tiled,
+                                                             u32 tiles, u32 strips)
+{
+    for (u32 strip = 0; strip < strips; ++strip) {
+        for (u32 tile = 0; tile < tiles; ++tile) {
+            const u8* src = linear + strip * 8 * stride + tile * 8 * bpp;
+            for (u32 y = 0; y < 8; ++y) {
+                for (u32 x = 0; x < 8; x += 2)
+                    memcpy(tiled + MortonIndex(x, y) * bpp, src + y * stride + x * bpp, 2 * bpp);
+            }
+            tiled += 64 * bpp;
+        }
+    }
+}
+
+static inline __attribute__((always_inline)) void DetileScalar(u32 bpp, const u8* tiled, u8* linear, size_t stride,
+                                                               u32 tiles, u32 strips)
+{
+    for (u32 strip = 0; strip < strips; ++strip) {
+        for (u32 tile = 0; tile < tiles; ++tile) {
+            u8* dst = linear + strip * 8 * stride + tile * 8 * bpp;
+            for (u32 y = 0; y < 8; ++y) {
+                for (u32 x = 0; x < 8; x += 2)
+                    memcpy(dst + y * stride + x * bpp, tiled + MortonIndex(x, y) * bpp, 2 * bpp);
+            }
+            tiled += 64 * bpp;
+        }
+    }
+}
+
+template <u32 bpp>
+static void TileScalar(const u8* linear, size_t stride, u8* tiled, u32 tiles, u32 strips)
+{
+    TileScalar(bpp, linear, stride, tiled, tiles, strips);
+}
+
+template <u32 bpp>
+static void DetileScalar(const u8* tiled, u8* linear, size_t stride, u32 tiles, u32 strips)
+{
+    DetileScalar(bpp, tiled, linear, stride, tiles, strips);
+}
+
+static const Kernels scalar_kernels = {
+    { nullptr, TileScalar<1>, TileScalar<2>, TileScalar<3>, TileScalar<4> },
+    { nullptr, DetileScalar<1>, DetileScalar<2>, DetileScalar<3>, DetileScalar<4> },
+};
+
+#if !defined(__x86_64__) && !defined(__i386__)
+const Kernels* const sse41_kernels = nullptr;
+const Kernels* const avx2_kernels = nullptr;
+#endif
+
+// Kernel sets to try for `kernel`, best first. Each falls back to the ones below it.
+static std::vector<const Kernels*> KernelChain(Kernel kernel)
+{
+    std::vector<const Kernels*> chain;
+    if (kernel == Kernel::AVX2 && avx2_kernels)
+        chain.push_back(avx2_kernels);
+    if ((kernel == Kernel::AVX2 || kernel == Kernel::SSE41) && sse41_kernels)
+        chain.push_back(sse41_kernels);
+    if (kernel == Kernel::Vector)
+        chain.push_back(&vector_kernels);
+    chain.push_back(&scalar_kernels);
+    return chain;
+}
+
+static unsigned ThreadCount(unsigned threads, u32 strips, size_t bytes)
+{
+    if (threads == 0) {
+        if (bytes < THREADING_MIN_BYTES)
+            return 1;
+        threads = std::thread::hardware_concurrency();
+        threads = threads == 0 ? 1 : threads > MAX_THREADS ? MAX_THREADS : threads;
+    }
+    return threads < strips ? threads : (strips == 0 ? 1 : strips);
+}
+
+// Calls `convert(first_strip, strip_count)` over all strips, split across threads
+template <typename Func>
+static void ForEachStrips(u32 strips, unsigned threads, Func convert)
+{
+    if (threads <= 1) {
+        convert(0, strips);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    u32 first = 0;
+    for (unsigned i = 0; i < threads; ++i) {
+        const u32 count = (strips - first) / (threads - i);
+        if (i + 1 == threads)
+            convert(first, count);
+        else
+            workers.emplace_back(convert, first, count);
+        first += count;
+    }
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+void LinearToTiled(Kernel kernel, const u8* linear, size_t stride, u8* tiled, u32 width, u32 height,
+                   u32 bytes_per_pixel, unsigned threads)
+{
+    const u32 bpp = bytes_per_pixel;
+    const u32 tiles = width / 8;
+    const u32 strips = height / 8;
+
+    TileFunc tile = nullptr;
+    if (bpp <= MAX_KERNEL_BYTES_PER_PIXEL) {
+        for (const Kernels* kernels : KernelChain(kernel)) {
+            if ((tile = kernels->tile[bpp]) != nullptr)
+                break;
+        }
+    }
+
+    ForEachStrips(strips, ThreadCount(threads, strips, (size_t)width * height * bpp), [&](u32 first, u32 count) {
+        const u8* src = linear + (size_t)first * 8 * stride;
+        u8* dst = tiled + (size_t)first * tiles * 64 * bpp;
+        if (tile)
+            tile(src, stride, dst, tiles, count);
+        else
+            TileScalar(bpp, src, stride, dst, tiles, count);
+    });
+}
+
+void TiledToLinear(Kernel kernel, const u8* tiled, u8* linear, size_t stride, u32 width, u32 height,
+                   u32 bytes_per_pixel, unsigned threads)
+{
+    const u32 bpp = bytes_per_pixel;
+    const u32 tiles = width / 8;
+    const u32 strips = height / 8;
+
+    DetileFunc detile = nullptr;
+    if (bpp <= MAX_KERNEL_BYTES_PER_PIXEL) {
+        for (const Kernels* kernels : KernelChain(kernel)) {
+            if ((detile = kernels->detile[bpp]) != nullptr)
+                break;
+        }
+    }
+
+    ForEachStrips(strips, ThreadCount(threads, strips, (size_t)width * height * bpp), [&](u32 first, u32 count) {
+        const u8* src = tiled + (size_t)first * tiles * 64 * bpp;
+        u8* dst = linear + (size_t)first * 8 * stride;
+        if (detile)
+            detile(src, dst, stride, tiles, count);
+        else
+            DetileScalar(bpp, src, dst, stride, tiles, count);
+    });
+}
+
+void LinearToTiled(const u8* linear, size_t stride, u8* tiled, u32 width, u32 height, u32 bytes_per_pixel,
+                   unsigned threads)
+{
+    LinearToTiled(BestKernel(), linear, stride, tiled, width, height, bytes_per_pixel, threads);
+}
+
+void TiledToLinear(const u8* tiled, u8* linear, size_t stride, u32 width, u32 height, u32 bytes_per_pixel,
+                   unsigned threads)
+{
+    TiledToLinear(BestKernel(), tiled, linear, stride, width, height, bytes_per_pixel, threads);
+}
+
+} // namespace
+} // namespace
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "pica/kernel.h"
+
+/**
+ * Tiled surfaces, as the GPU reads and writes them: 8x8 pixel tiles stored one after the other,
+ * left to right and then top to bottom, with the 64 pixels of a tile in Morton (Z-curve) order.
+ * Pixel (x, y) of a tile is at index x0 | y0 << 1 | x1 << 2 | y1 << 3 | x2 << 4 | y2 << 5, where
+ * xN is bit N of x, as Test_ZCurve in hwtests shows.
+ *
+ * Surfaces must be a multiple of 8 pixels wide and high. Any number of bytes per pixel works;
+ * 1, 2 and 4 have vector kernels. When `threads` is 0, large surfaces are split by rows of tiles
+ * across a few threads.
+ */
+
+namespace Pica {
+namespace Tiling {
+
+/// Index of pixel (x, y) in a tiled surface `width` pixels wide.
+u32 TiledIndex(u32 x, u32 y, u32 width);
+
+/// Copies a linear surface with rows `stride` bytes apart to a tiled surface.
+void LinearToTiled(const u8* linear, size_t stride, u8* tiled, u32 width, u32 height, u32 bytes_per_pixel,
+                   unsigned threads = 0);
+void LinearToTiled(Kernel kernel, const u8* linear, size_t stride, u8* tiled, u32 width, u32 height,
+                   u32 bytes_per_pixel, unsigned threads = 0);
+
+/// Copies a tiled surface to a linear surface with rows `stride` bytes apart.
+void TiledToLinear(const u8* tiled, u8* linear, size_t stride, u32 width, u32 height, u32 bytes_per_pixel,
+                   unsigned threads = 0);
+void TiledToLinear(Kernel kernel, const u8* tiled, u8* linear, size_t stride, u32 width, u32 height,
+                   u32 bytes_per_pixel, unsigned threads = 0);
+
+} // namespace
+} // namespace
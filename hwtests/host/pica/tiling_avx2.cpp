@@ -0,0 +1,59 @@
+#include <immintrin.h>
+
+#include "pica/tiling_kernels.h"
+
+// Built with -mavx2. Only called once IsSupported() has checked the CPU. Only 4 bytes per pixel
+// has whole 256-bit rows; the others use the SSE4.1 kernels.
+
+namespace Pica {
+namespace Tiling {
+
+static __m256i Load(const u8* src) { return _mm256_loadu_si256((const __m256i*)src); }
+static void Store(u8* dst, __m256i value) { _mm256_storeu_si256((__m256i*)dst, value); }
+
+static void Tile4(const u8* linear, size_t stride, u8* tiled, u32 tiles, u32 strips)
+{
+    for (u32 strip = 0; strip < strips; ++strip) {
+        for (u32 tile = 0; tile < tiles; ++tile) {
+            const u8* src = linear + strip * 8 * stride + tile * 32;
+            for (u32 pair = 0; pair < 4; ++pair) {
+                const __m256i a = Load(src + pair * 2 * stride);
+                const __m256i b = Load(src + (pair * 2 + 1) * stride);
+                // Blocks 0 and 2, and blocks 1 and 3
+                const __m256i even = _mm256_unpacklo_epi64(a, b);
+                const __m256i odd = _mm256_unpackhi_epi64(a, b);
+                Store(tiled + BlockIndex(0, pair) * 4, _mm256_permute2x128_si256(even, odd, 0x20));
+                Store(tiled + BlockIndex(2, pair) * 4, _mm256_permute2x128_si256(even, odd, 0x31));
+            }
+            tiled += 256;
+        }
+    }
+}
+
+static void Detile4(const u8* tiled, u8* linear, size_t stride, u32 tiles, u32 strips)
+{
+    for (u32 strip = 0; strip < strips; ++strip) {
+        for (u32 tile = 0; tile < tiles; ++tile) {
+            u8* dst = linear + strip * 8 * stride + tile * 32;
+            for (u32 pair = 0; pair < 4; ++pair) {
+                const __m256i low = Load(tiled + BlockIndex(0, pair) * 4);
+                const __m256i high = Load(tiled + BlockIndex(2, pair) * 4);
+                const __m256i even = _mm256_permute2x128_si256(low, high, 0x20);
+                const __m256i odd = _mm256_permute2x128_si256(low, high, 0x31);
+                Store(dst + pair * 2 * stride, _mm256_unpacklo_epi64(even, odd));
+                Store(dst + (pair * 2 + 1) * stride, _mm256_unpackhi_epi64(even, odd));
+            }
+            tiled += 256;
+        }
+    }
+}
+
+static const Kernels kernels = {
+    { nullptr, nullptr, nullptr, nullptr, Tile4 },
+    { nullptr, nullptr, nullptr, nullptr, Detile4 },
+};
+
+const Kernels* const avx2_kernels = &kernels;
+
+} // namespace
+} // namespace
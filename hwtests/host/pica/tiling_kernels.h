@@ -0,0 +1,35 @@
+#pragma once
+
+#include "pica/tiling.h"
+
+// Internal to the tiling library. Kernels convert `strips` rows of tiles, each `tiles` tiles
+// wide. A tile is handled as 16 blocks of 2x2 pixels: the two pixels of a block in one row are
+// next to each other in both layouts, and the blocks are in Morton order themselves.
+
+namespace Pica {
+namespace Tiling {
+
+typedef void (*TileFunc)(const u8* linear, size_t stride, u8* tiled, u32 tiles, u32 strips);
+typedef void (*DetileFunc)(const u8* tiled, u8* linear, size_t stride, u32 tiles, u32 strips);
+
+static const u32 MAX_KERNEL_BYTES_PER_PIXEL = 4;
+
+/// Kernels by bytes per pixel, nullptr where a kernel set has none.
+struct Kernels {
+    TileFunc tile[MAX_KERNEL_BYTES_PER_PIXEL + 1];
+    DetileFunc detile[MAX_KERNEL_BYTES_PER_PIXEL + 1];
+};
+
+extern const Kernels vector_kernels;
+// nullptr if not built for this target
+extern const Kernels* const sse41_kernels;
+extern const Kernels* const avx2_kernels;
+
+/// Index of the first pixel of block `column` (0-3) in rows `pair` * 2 and `pair` * 2 + 1 of a tile.
+static inline u32 BlockIndex(u32 column, u32 pair)
+{
+    return ((column & 1) | ((pair & 1) << 1) | ((column & 2) << 1) | ((pair & 2) << 2)) * 4;
+}
+
+} // namespace
+} // namespace
@@ -0,0 +1,132 @@
+#include <smmintrin.h>
+
+#include "pica/tiling_kernels.h"
+
+// Built with -msse4.1. Only called once IsSupported() has checked the CPU.
+
+namespace Pica {
+namespace Tiling {
+
+static __m128i Load(const u8* src) { return _mm_loadu_si128((const __m128i*)src); }
+static void Store(u8* dst, __m128i value) { _mm_storeu_si128((__m128i*)dst, value); }
+static __m128i Load64(const u8* src) { return _mm_loadl_epi64((const __m128i*)src); }
+static void Store64(u8* dst, __m128i value) { _mm_storel_epi64((__m128i*)dst, value); }
+
+static void Tile1(const u8* linear, size_t stride, u8* tiled, u32 tiles, u32 strips)
+{
+    for (u32 strip = 0; strip < strips; ++strip) {
+        for (u32 tile = 0; tile < tiles; ++tile) {
+            const u8* src = linear + strip * 8 * stride + tile * 8;
+            for (u32 pair = 0; pair < 4; ++pair) {
+                const __m128i blocks = _mm_unpacklo_epi16(Load64(src + pair * 2 * stride),
+                                                          Load64(src + (pair * 2 + 1) * stride));
+                Store64(tiled + BlockIndex(0, pair), blocks);
+                Store64(tiled + BlockIndex(2, pair), _mm_srli_si128(blocks, 8));
+            }
+            tiled += 64;
+        }
+    }
+}
+
+static void Detile1(const u8* tiled, u8* linear, size_t stride, u32 tiles, u32 strips)
+{
+    // Gathers the even pixel pairs, from row y, into the low half and the odd ones into the high half
+    const __m128i rows = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+
+    for (u32 strip = 0; strip < strips; ++strip) {
+        for (u32 tile = 0; tile < tiles; ++tile) {
+            u8* dst = linear + strip * 8 * stride + tile * 8;
+            for (u32 pair = 0; pair < 4; ++pair) {
+                const __m128i blocks = _mm_unpacklo_epi64(Load64(tiled + BlockIndex(0, pair)),
+                                                          Load64(tiled + BlockIndex(2, pair)));
+                const __m128i split = _mm_shuffle_epi8(blocks, rows);
+                Store64(dst + pair * 2 * stride, split);
+                Store64(dst + (pair * 2 + 1) * stride, _mm_srli_si128(split, 8));
+            }
+            tiled += 64;
+        }
+    }
+}
+
+static void Tile2(const u8* linear, size_t stride, u8* tiled, u32 tiles, u32 strips)
+{
+    for (u32 strip = 0; strip < strips; ++strip) {
+        for (u32 tile = 0; tile < tiles; ++tile) {
+            const u8* src = linear + strip * 8 * stride + tile * 16;
+            for (u32 pair = 0; pair < 4; ++pair) {
+                const __m128i a = Load(src + pair * 2 * stride);
+                const __m128i b = Load(src + (pair * 2 + 1) * stride);
+                Store(tiled + BlockIndex(0, pair) * 2, _mm_unpacklo_epi32(a, b));
+                Store(tiled + BlockIndex(2, pair) * 2, _mm_unpackhi_epi32(a, b));
+            }
+            tiled += 128;
+        }
+    }
+}
+
+static void Detile2(const u8* tiled, u8* linear, size_t stride, u32 tiles, u32 strips)
+{
+    for (u32 strip = 0; strip < strips; ++strip) {
+        for (u32 tile = 0; tile < tiles; ++tile) {
+            u8* dst = linear + strip * 8 * stride + tile * 16;
+            for (u32 pair = 0; pair < 4; ++pair) {
+                // Row y's pixel pairs to the low half, row y + 1's to the high half
+                const __m128i a = _mm_shuffle_epi32(Load(tiled + BlockIndex(0, pair) * 2), _MM_SHUFFLE(3, 1, 2, 0));
+                const __m128i b = _mm_shuffle_epi32(Load(tiled + BlockIndex(2, pair) * 2), _MM_SHUFFLE(3, 1, 2, 0));
+                Store(dst + pair * 2 * stride, _mm_unpacklo_epi64(a, b));
+                Store(dst + (pair * 2 + 1) * stride, _mm_unpackhi_epi64(a, b));
+            }
+            tiled += 128;
+        }
+    }
+}
+
+static void Tile4(const u8* linear, size_t stride, u8* tiled, u32 tiles, u32 strips)
+{
+    for (u32 strip = 0; strip < strips; ++strip) {
+        for (u32 tile = 0; tile < tiles; ++tile) {
+            const u8* src = linear + strip * 8 * stride + tile * 32;
+            for (u32 pair = 0; pair < 4; ++pair) {
+                const u8* row = src + pair * 2 * stride;
+                const __m128i a0 = Load(row), a1 = Load(row + 16);
+                const __m128i b0 = Load(row + stride), b1 = Load(row + stride + 16);
+                Store(tiled + BlockIndex(0, pair) * 4, _mm_unpacklo_epi64(a0, b0));
+                Store(tiled + BlockIndex(1, pair) * 4, _mm_unpackhi_epi64(a0, b0));
+                Store(tiled + BlockIndex(2, pair) * 4, _mm_unpacklo_epi64(a1, b1));
+                Store(tiled + BlockIndex(3, pair) * 4, _mm_unpackhi_epi64(a1, b1));
+            }
+            tiled += 256;
+        }
+    }
+}
+
+static void Detile4(const u8* tiled, u8* linear, size_t stride, u32 tiles, u32 strips)
+{
+    for (u32 strip = 0; strip < strips; ++strip) {
+        for (u32 tile = 0; tile < tiles; ++tile) {
+            u8* dst = linear + strip * 8 * stride + tile * 32;
+            for (u32 pair = 0; pair < 4; ++pair) {
+                u8* row = dst + pair * 2 * stride;
+                const __m128i c0 = Load(tiled + BlockIndex(0, pair) * 4);
+                const __m128i c1 = Load(tiled + BlockIndex(1, pair) * 4);
+                const __m128i c2 = Load(tiled + BlockIndex(2, pair) * 4);
+                const __m128i c3 = Load(tiled + BlockIndex(3, pair) * 4);
+                Store(row, _mm_unpacklo_epi64(c0, c1));
+                Store(row + 16, _mm_unpacklo_epi64(c2, c3));
+                Store(row + stride, _mm_unpackhi_epi64(c0, c1));
+                Store(row + stride + 16, _mm_unpackhi_epi64(c2, c3));
+            }
+            tiled += 256;
+        }
+    }
+}
+
+static const Kernels kernels = {
+    { nullptr, Tile1, Tile2, nullptr, Tile4 },
+    { nullptr, Detile1, Detile2, nullptr, Detile4 },
+};
+
+const Kernels* const sse41_kernels = &kernels;
+
+} // namespace
+} // namespace
@@ -0,0 +1,110 @@
+#include <cstring>
+
+#include "pica/tiling_kernels.h"
+
+// Written with GCC vector extensions instead of intrinsics, so the same code becomes NEON on ARM
+// and SSE2 on x86. Each step interleaves rows y and y + 1 of a tile into its 2x2 blocks.
+
+namespace Pica {
+namespace Tiling {
+
+typedef u32 V32 __attribute__((vector_size(16)));
+typedef u64 V64 __attribute__((vector_size(16)));
+
+#ifdef __clang__
+#define SHUFFLE(a, b, ...) __builtin_shufflevector(a, b, __VA_ARGS__)
+#else
+#define SHUFFLE(a, b, ...) __builtin_shuffle(a, b, decltype(a){ __VA_ARGS__ })
+#endif
+
+template <typename V>
+static V Load(const u8* src)
+{
+    V value;
+    memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+template <typename V>
+static void Store(u8* dst, V value)
+{
+    memcpy(dst, &value, sizeof(value));
+}
+
+static void Tile2(const u8* linear, size_t stride, u8* tiled, u32 tiles, u32 strips)
+{
+    for (u32 strip = 0; strip < strips; ++strip) {
+        for (u32 tile = 0; tile < tiles; ++tile) {
+            const u8* src = linear + strip * 8 * stride + tile * 16;
+            for (u32 pair = 0; pair < 4; ++pair) {
+                const V32 a = Load<V32>(src + pair * 2 * stride);
+                const V32 b = Load<V32>(src + (pair * 2 + 1) * stride);
+                Store(tiled + BlockIndex(0, pair) * 2, SHUFFLE(a, b, 0, 4, 1, 5));
+                Store(tiled + BlockIndex(2, pair) * 2, SHUFFLE(a, b, 2, 6, 3, 7));
+            }
+            tiled += 128;
+        }
+    }
+}
+
+static void Detile2(const u8* tiled, u8* linear, size_t stride, u32 tiles, u32 strips)
+{
+    for (u32 strip = 0; strip < strips; ++strip) {
+        for (u32 tile = 0; tile < tiles; ++tile) {
+            u8* dst = linear + strip * 8 * stride + tile * 16;
+            for (u32 pair = 0; pair < 4; ++pair) {
+                const V32 a = Load<V32>(tiled + BlockIndex(0, pair) * 2);
+                const V32 b = Load<V32>(tiled + BlockIndex(2, pair) * 2);
+                Store(dst + pair * 2 * stride, SHUFFLE(a, b, 0, 2, 4, 6));
+                Store(dst + (pair * 2 + 1) * stride, SHUFFLE(a, b, 1, 3, 5, 7));
+            }
+            tiled += 128;
+        }
+    }
+}
+
+static void Tile4(const u8* linear, size_t stride, u8* tiled, u32 tiles, u32 strips)
+{
+    for (u32 strip = 0; strip < strips; ++strip) {
+        for (u32 tile = 0; tile < tiles; ++tile) {
+            const u8* src = linear + strip * 8 * stride + tile * 32;
+            for (u32 pair = 0; pair < 4; ++pair) {
+                const u8* row = src + pair * 2 * stride;
+                for (u32 half = 0; half < 2; ++half) {
+                    const V64 a = Load<V64>(row + half * 16);
+                    const V64 b = Load<V64>(row + stride + half * 16);
+                    Store(tiled + BlockIndex(half * 2, pair) * 4, SHUFFLE(a, b, 0, 2));
+                    Store(tiled + BlockIndex(half * 2 + 1, pair) * 4, SHUFFLE(a, b, 1, 3));
+                }
+            }
+            tiled += 256;
+        }
+    }
+}
+
+static void Detile4(const u8* tiled, u8* linear, size_t stride, u32 tiles, u32 strips)
+{
+    for (u32 strip = 0; strip < strips; ++strip) {
+        for (u32 tile = 0; tile < tiles; ++tile) {
+            u8* dst = linear + strip * 8 * stride + tile * 32;
+            for (u32 pair = 0; pair < 4; ++pair) {
+                u8* row = dst + pair * 2 * stride;
+                for (u32 half = 0; half < 2; ++half) {
+                    const V64 a = Load<V64>(tiled + BlockIndex(half * 2, pair) * 4);
+                    const V64 b = Load<V64>(tiled + BlockIndex(half * 2 + 1, pair) * 4);
+                    Store(row + half * 16, SHUFFLE(a, b, 0, 2));
+                    Store(row + stride + half * 16, SHUFFLE(a, b, 1, 3));
+                }
+            }
+            tiled += 256;
+        }
+    }
+}
+
+const Kernels vector_kernels = {
+    { nullptr, nullptr, Tile2, nullptr, Tile4 },
+    { nullptr, nullptr, Detile2, nullptr, Detile4 },
+};
+
+} // namespace
+} // namespace
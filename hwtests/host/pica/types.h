@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Pica {
+
+typedef std::uint8_t u8;
+typedef std::uint16_t u16;
+typedef std::uint32_t u32;
+typedef std::uint64_t u64;
+
+/// Pixel formats of the DisplayTransfer engine, with their values in its flags register.
+enum class PixelFormat : u32 {
+    RGBA8 = 0,
+    RGB8 = 1,
+    RGB565 = 2,
+    RGB5A1 = 3,
+    RGBA4 = 4,
+};
+
+static const u32 NUM_PIXEL_FORMATS = 5;
+
+inline u32 BytesPerPixel(PixelFormat format)
+{
+    static const u32 sizes[NUM_PIXEL_FORMATS] = { 4, 3, 2, 2, 2 };
+    return sizes[(u32)format];
+}
+
+} // namespace
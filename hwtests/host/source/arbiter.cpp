@@ -0,0 +1,185 @@
+#include "kernel.h"
+
+// Address arbiters keep their waiters in a table of wait queues hashed by address, as Linux does
+// for futexes: threads waiting on any address that hashes to one bucket share its queue, in
+// priority order, and a signal walks it for the threads waiting on its own address. The table has
+// a fixed size, so an arbiter costs the same however many addresses are used with it.
+//
+// Waiting threads sleep on their own futex word like any other wait, rather than on the address,
+// so that they are woken in the order the 3DS kernel would wake them.
+//
+// LightLock is libctru's, on an arbiter of its own.
+
+namespace Host {
+
+class AddressArbiter : public Object {
+public:
+    class Bucket : public WaitObject {
+    public:
+        bool ShouldWait(const Thread* thread) const override { return true; }
+
+        // Wakes up to `count` of the threads waiting on `address`, or every one if it is negative
+        void Signal(uintptr_t address, s32 count) {
+            for (WaitNode* node = head; node != nullptr && count != 0;) {
+                WaitNode* next = node->next;
+                if (node->thread->arbitration_address == address) {
+                    EndWait(node->thread, 0, -1);
+                    if (count > 0)
+                        count--;
+                }
+                node = next;
+            }
+        }
+    };
+
+    static const u32 BUCKET_COUNT = 256;
+
+    Bucket& BucketOf(uintptr_t address) {
+        // Fibonacci hashing: the top bits of the product depend on every bit of the address
+        return buckets[(u64)address * 0x9E3779B97F4A7C15ull >> 56];
+    }
+
+    Bucket buckets[BUCKET_COUNT];
+};
+
+static Result Arbitrate(std::unique_lock<std::mutex>& lock, const std::shared_ptr<AddressArbiter>& arbiter,
+                        uintptr_t address, ArbitrationType type, s32 value, s64 nanoseconds)
+{
+    Thread* current = CurrentThread(lock);
+    AddressArbiter::Bucket& bucket = arbiter->BucketOf(address);
+    s32* word = reinterpret_cast<s32*>(address);
+
+    switch (type) {
+    case ARBITRATION_SIGNAL:
+        bucket.Signal(address, value);
+        Reschedule(lock);
+        return 0;
+
+    case ARBITRATION_WAIT_IF_LESS_THAN:
+    case ARBITRATION_DECREMENT_AND_WAIT_IF_LESS_THAN:
+    case ARBITRATION_WAIT_IF_LESS_THAN_TIMEOUT:
+    case ARBITRATION_DECREMENT_AND_WAIT_IF_LESS_THAN_TIMEOUT: {
+        const bool decrement = type == ARBITRATION_DECREMENT_AND_WAIT_IF_LESS_THAN ||
+                               type == ARBITRATION_DECREMENT_AND_WAIT_IF_LESS_THAN_TIMEOUT;
+        const bool timeout = type == ARBITRATION_WAIT_IF_LESS_THAN_TIMEOUT ||
+                             type == ARBITRATION_DECREMENT_AND_WAIT_IF_LESS_THAN_TIMEOUT;
+
+        // Only the running thread touches memory, so the value can not change before the wait.
+        // The timeout variants report a timeout even when they do not wait.
+        const s32 current_value = __atomic_load_n(word, __ATOMIC_ACQUIRE);
+        if (current_value >= value)
+            return timeout ? RESULT_TIMEOUT : 0;
+        // Decremented only when the thread waits
+        if (decrement)
+            __atomic_store_n(word, current_value - 1, __ATOMIC_RELEASE);
+
+        current->arbitration_address = address;
+        const u64 deadline = !timeout || nanoseconds < 0 ? U64_MAX : KernelTime() + nanoseconds;
+        // The bucket lives as long as the arbiter
+        const std::shared_ptr<WaitObject> object(arbiter, &bucket);
+        s32 index;
+        return Wait(lock, { object }, false, deadline, index);
+    }
+
+    default:
+        return RESULT_INVALID_ENUM;
+    }
+}
+
+// The arbiter libctru's synchronization primitives share
+static const std::shared_ptr<AddressArbiter>& SyncArbiter()
+{
+    static const std::shared_ptr<AddressArbiter> arbiter = std::make_shared<AddressArbiter>();
+    return arbiter;
+}
+
+static void SyncArbitrate(LightLock* lock, ArbitrationType type, s32 value)
+{
+    std::unique_lock<std::mutex> kernel(KernelLock());
+    Arbitrate(kernel, SyncArbiter(), reinterpret_cast<uintptr_t>(lock), type, value, 0);
+}
+
+} // namespace
+
+using namespace Host;
+
+Result svcCreateAddressArbiter(Handle* arbiter)
+{
+    *arbiter = CreateHandle(std::make_shared<AddressArbiter>());
+    return 0;
+}
+
+Result svcArbitrateAddress(Handle handle, uintptr_t addr, ArbitrationType type, s32 value, s64 nanoseconds)
+{
+    auto arbiter = GetObject<AddressArbiter>(handle);
+    if (!arbiter)
+        return RESULT_INVALID_HANDLE;
+
+    std::unique_lock<std::mutex> lock(KernelLock());
+    return Arbitrate(lock, arbiter, addr, type, value, nanoseconds);
+}
+
+// As in libctru: a positive value is unlocked, with value - 1 threads waiting, and a negative one
+// locked, with -value - 1 threads waiting. Zero, as from zeroed memory, is unlocked.
+
+void LightLock_Init(LightLock* lock)
+{
+    __atomic_store_n(lock, 1, __ATOMIC_RELEASE);
+}
+
+void LightLock_Lock(LightLock* lock)
+{
+    s32 value = __atomic_load_n(lock, __ATOMIC_RELAXED);
+    s32 desired;
+    bool locked;
+    do {
+        if (value == 0)
+            value = 1;
+        locked = value < 0;
+        // Counts this thread as a waiter if it is locked, takes it otherwise
+        desired = locked ? value - 1 : -value;
+    } while (!__atomic_compare_exchange_n(lock, &value, desired, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+    while (locked) {
+        SyncArbitrate(lock, ARBITRATION_WAIT_IF_LESS_THAN, 0);
+
+        // Woken with the lock released, and this thread no longer counted as a waiter. Another
+        // thread may have taken it first: unlike libctru, which then waits uncounted, this one is
+        // counted again, or the unlock could find no waiters and leave it asleep.
+        value = __atomic_load_n(lock, __ATOMIC_RELAXED);
+        do {
+            locked = value < 0;
+            desired = locked ? value - 1 : -value;
+        } while (!__atomic_compare_exchange_n(lock, &value, desired, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+    }
+}
+
+int LightLock_TryLock(LightLock* lock)
+{
+    // Zero on success, as in libctru
+    s32 value = __atomic_load_n(lock, __ATOMIC_RELAXED);
+    do {
+        if (value == 0)
+            value = 1;
+        if (value < 0)
+            return 1;
+    } while (!__atomic_compare_exchange_n(lock, &value, -value, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+    return 0;
+}
+
+void LightLock_Unlock(LightLock* lock)
+{
+    s32 value = __atomic_load_n(lock, __ATOMIC_RELAXED);
+    s32 desired;
+    bool wake;
+    do {
+        desired = -value;
+        // Hands the lock back with one waiter fewer, as one is woken to take it
+        wake = desired > 1;
+        if (wake)
+            desired--;
+    } while (!__atomic_compare_exchange_n(lock, &value, desired, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    if (wake)
+        SyncArbitrate(lock, ARBITRATION_SIGNAL, 1);
+}
@@ -0,0 +1,346 @@
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <set>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include <dirent.h>
+
+#include "host.h"
+
+namespace Host {
+
+class File : public Object {
+public:
+    explicit File(int fd) : fd(fd) {}
+    ~File() { close(fd); }
+
+    int fd;
+};
+
+class Directory : public Object {
+public:
+    std::vector<FS_DirectoryEntry> entries;
+    size_t next = 0;
+};
+
+static std::mutex archive_lock;
+static std::set<FS_Archive> archives;
+static FS_Archive next_archive = 1;
+
+static bool IsOpenArchive(FS_Archive archive)
+{
+    std::lock_guard<std::mutex> lock(archive_lock);
+    return archives.count(archive) != 0;
+}
+
+// Resolves an FS_Path to a host path below the SD card root. Returns false for paths that cannot
+// name anything inside the archive.
+static bool HostPath(FS_Archive archive, const FS_Path& path, std::string& out)
+{
+    if (!IsOpenArchive(archive))
+        return false;
+
+    std::string name;
+    if (path.type == PATH_ASCII) {
+        name = std::string((const char*)path.data, strnlen((const char*)path.data, path.size));
+    } else if (path.type == PATH_UTF16) {
+        // Only ASCII names are supported
+        const u16* data = (const u16*)path.data;
+        for (u32 i = 0; i < path.size / 2 && data[i] != 0; ++i) {
+            if (data[i] >= 0x80)
+                return false;
+            name += (char)data[i];
+        }
+    } else {
+        return false;
+    }
+
+    if (name.empty() || name[0] != '/' || name.find("/..") != std::string::npos)
+        return false;
+
+    out = SdmcRoot() + name;
+    return true;
+}
+
+// What kind of object is at `path`: 0 for nothing, S_IFREG or S_IFDIR
+static mode_t TypeOf(const std::string& path)
+{
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0)
+        return 0;
+    return info.st_mode & S_IFMT;
+}
+
+static Result ErrnoResult(int error, bool directory)
+{
+    switch (error) {
+    case ENOENT:
+    case ENOTDIR:
+        return directory ? RESULT_FS_DIRECTORY_NOT_FOUND : RESULT_FS_NOT_FOUND;
+    case EEXIST:
+        return directory ? RESULT_FS_DIRECTORY_ALREADY_EXISTS : RESULT_FS_ALREADY_EXISTS;
+    default:
+        return RESULT_FS_NOT_PERMITTED;
+    }
+}
+
+static void FillEntry(FS_DirectoryEntry& entry, const std::string& name, const struct stat& info)
+{
+    memset(&entry, 0, sizeof(entry));
+    const size_t length = std::min(name.length(), (size_t)0x105);
+    for (size_t i = 0; i < length; ++i)
+        entry.name[i] = (u8)name[i];
+
+    entry.valid = 1;
+    if (S_ISDIR(info.st_mode))
+        entry.attributes = FS_ATTRIBUTE_DIRECTORY;
+    else
+        entry.fileSize = info.st_size;
+}
+
+} // namespace
+
+using namespace Host;
+
+FS_Path fsMakePath(FS_PathType type, const void* path)
+{
+    FS_Path result = { type, 0, path };
+    if (type == PATH_ASCII) {
+        result.size = strlen((const char*)path) + 1;
+    } else if (type == PATH_UTF16) {
+        const u16* data = (const u16*)path;
+        while (data[result.size / 2] != 0)
+            result.size += 2;
+        result.size += 2;
+    } else if (type == PATH_EMPTY) {
+        result.size = 1;
+    }
+    return result;
+}
+
+Result FSUSER_OpenArchive(FS_Archive* archive, FS_ArchiveID id, FS_Path path)
+{
+    if (id != ARCHIVE_SDMC || TypeOf(SdmcRoot()) != S_IFDIR)
+        return RESULT_FS_INVALID_ARCHIVE;
+
+    std::lock_guard<std::mutex> lock(archive_lock);
+    *archive = next_archive++;
+    archives.insert(*archive);
+    return 0;
+}
+
+Result FSUSER_CloseArchive(FS_Archive archive)
+{
+    std::lock_guard<std::mutex> lock(archive_lock);
+    return archives.erase(archive) ? 0 : RESULT_FS_INVALID_ARCHIVE;
+}
+
+Result FSUSER_OpenFile(Handle* out, FS_Archive archive, FS_Path path, u32 open_flags, u32 attributes)
+{
+    *out = 0;
+
+    std::string host_path;
+    if (!HostPath(archive, path, host_path))
+        return RESULT_FS_INVALID_PATH;
+    if (TypeOf(host_path) == S_IFDIR)
+        return RESULT_FS_NOT_FOUND;
+
+    // Files opened for writing can also be read from, as FS::SDMC's write and read test expects
+    int flags = (open_flags & FS_OPEN_WRITE) ? O_RDWR : O_RDONLY;
+    if (open_flags & FS_OPEN_CREATE)
+        flags |= O_CREAT;
+
+    const int fd = open(host_path.c_str(), flags, 0666);
+    if (fd < 0)
+        return ErrnoResult(errno, false);
+
+    *out = CreateHandle(std::make_shared<File>(fd));
+    return 0;
+}
+
+Result FSUSER_CreateFile(FS_Archive archive, FS_Path path, u32 attributes, u64 file_size)
+{
+    std::string host_path;
+    if (!HostPath(archive, path, host_path))
+        return RESULT_FS_INVALID_PATH;
+
+    const int fd = open(host_path.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+    if (fd < 0)
+        return ErrnoResult(errno, false);
+
+    const bool sized = ftruncate(fd, file_size) == 0;
+    close(fd);
+    return sized ? 0 : RESULT_FS_NOT_PERMITTED;
+}
+
+Result FSUSER_DeleteFile(FS_Archive archive, FS_Path path)
+{
+    std::string host_path;
+    if (!HostPath(archive, path, host_path))
+        return RESULT_FS_INVALID_PATH;
+    if (TypeOf(host_path) != S_IFREG)
+        return RESULT_FS_NOT_FOUND;
+
+    return unlink(host_path.c_str()) == 0 ? 0 : ErrnoResult(errno, false);
+}
+
+static Result Rename(FS_Archive src_archive, FS_Path src_path, FS_Archive dst_archive, FS_Path dst_path, bool directory)
+{
+    std::string src, dst;
+    if (!HostPath(src_archive, src_path, src) || !HostPath(dst_archive, dst_path, dst))
+        return RESULT_FS_INVALID_PATH;
+    if (TypeOf(src) != (directory ? S_IFDIR : S_IFREG))
+        return directory ? RESULT_FS_DIRECTORY_NOT_FOUND : RESULT_FS_NOT_FOUND;
+    // rename() would replace the destination
+    if (TypeOf(dst) != 0)
+        return directory ? RESULT_FS_DIRECTORY_ALREADY_EXISTS : RESULT_FS_ALREADY_EXISTS;
+
+    return rename(src.c_str(), dst.c_str()) == 0 ? 0 : ErrnoResult(errno, directory);
+}
+
+Result FSUSER_RenameFile(FS_Archive src_archive, FS_Path src_path, FS_Archive dst_archive, FS_Path dst_path)
+{
+    return Rename(src_archive, src_path, dst_archive, dst_path, false);
+}
+
+Result FSUSER_OpenDirectory(Handle* out, FS_Archive archive, FS_Path path)
+{
+    *out = 0;
+
+    std::string host_path;
+    if (!HostPath(archive, path, host_path))
+        return RESULT_FS_INVALID_PATH;
+
+    DIR* dir = opendir(host_path.c_str());
+    if (dir == nullptr)
+        return ErrnoResult(errno, true);
+
+    // The listing is taken when the directory is opened
+    auto directory = std::make_shared<Directory>();
+    while (dirent* ent = readdir(dir)) {
+        const std::string name = ent->d_name;
+        struct stat info;
+        if (name == "." || name == ".." || stat((host_path + "/" + name).c_str(), &info) != 0)
+            continue;
+
+        directory->entries.emplace_back();
+        FillEntry(directory->entries.back(), name, info);
+    }
+    closedir(dir);
+
+    *out = CreateHandle(directory);
+    return 0;
+}
+
+Result FSUSER_CreateDirectory(FS_Archive archive, FS_Path path, u32 attributes)
+{
+    std::string host_path;
+    if (!HostPath(archive, path, host_path))
+        return RESULT_FS_INVALID_PATH;
+
+    return mkdir(host_path.c_str(), 0777) == 0 ? 0 : ErrnoResult(errno, true);
+}
+
+Result FSUSER_DeleteDirectory(FS_Archive archive, FS_Path path)
+{
+    std::string host_path;
+    if (!HostPath(archive, path, host_path))
+        return RESULT_FS_INVALID_PATH;
+
+    return rmdir(host_path.c_str()) == 0 ? 0 : ErrnoResult(errno, true);
+}
+
+Result FSUSER_RenameDirectory(FS_Archive src_archive, FS_Path src_path, FS_Archive dst_archive, FS_Path dst_path)
+{
+    return Rename(src_archive, src_path, dst_archive, dst_path, true);
+}
+
+Result FSFILE_Read(Handle handle, u32* bytes_read, u64 offset, void* buffer, u32 size)
+{
+    auto file = GetObject<File>(handle);
+    if (!file)
+        return RESULT_INVALID_HANDLE;
+
+    const ssize_t result = pread(file->fd, buffer, size, offset);
+    if (result < 0)
+        return RESULT_FS_NOT_PERMITTED;
+    *bytes_read = result;
+    return 0;
+}
+
+Result FSFILE_Write(Handle handle, u32* bytes_written, u64 offset, const void* buffer, u32 size, u32 flags)
+{
+    auto file = GetObject<File>(handle);
+    if (!file)
+        return RESULT_INVALID_HANDLE;
+
+    const ssize_t result = pwrite(file->fd, buffer, size, offset);
+    if (result < 0)
+        return RESULT_FS_NOT_PERMITTED;
+    *bytes_written = result;
+
+    if ((flags & FS_WRITE_FLUSH) && fdatasync(file->fd) != 0)
+        return RESULT_FS_NOT_PERMITTED;
+    return 0;
+}
+
+Result FSFILE_GetSize(Handle handle, u64* size)
+{
+    auto file = GetObject<File>(handle);
+    if (!file)
+        return RESULT_INVALID_HANDLE;
+
+    struct stat info;
+    if (fstat(file->fd, &info) != 0)
+        return RESULT_FS_NOT_PERMITTED;
+    *size = info.st_size;
+    return 0;
+}
+
+Result FSFILE_SetSize(Handle handle, u64 size)
+{
+    auto file = GetObject<File>(handle);
+    if (!file)
+        return RESULT_INVALID_HANDLE;
+
+    return ftruncate(file->fd, size) == 0 ? 0 : RESULT_FS_NOT_PERMITTED;
+}
+
+Result FSFILE_Flush(Handle handle)
+{
+    auto file = GetObject<File>(handle);
+    if (!file)
+        return RESULT_INVALID_HANDLE;
+
+    return fdatasync(file->fd) == 0 ? 0 : RESULT_FS_NOT_PERMITTED;
+}
+
+Result FSFILE_Close(Handle handle)
+{
+    if (!GetObject<File>(handle))
+        return RESULT_INVALID_HANDLE;
+    return svcCloseHandle(handle);
+}
+
+Result FSDIR_Read(Handle handle, u32* entries_read, u32 entry_count, FS_DirectoryEntry* entries)
+{
+    auto directory = GetObject<Directory>(handle);
+    if (!directory)
+        return RESULT_INVALID_HANDLE;
+
+    u32 count = 0;
+    while (count < entry_count && directory->next < directory->entries.size())
+        entries[count++] = directory->entries[directory->next++];
+    *entries_read = count;
+    return 0;
+}
+
+Result FSDIR_Close(Handle handle)
+{
+    if (!GetObject<Directory>(handle))
+        return RESULT_INVALID_HANDLE;
+    return svcCloseHandle(handle);
+}
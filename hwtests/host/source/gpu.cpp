@@ -0,0 +1,65 @@
+#include <stdlib.h>
+
+#include "host.h"
+#include "pica/display_transfer.h"
+#include "pica/memory_fill.h"
+
+// GPU commands, run on the pica models as they are submitted
+
+// The alignment linearAlloc() gives on the 3DS
+static const size_t LINEAR_ALIGNMENT = 0x80;
+
+void* linearAlloc(size_t size)
+{
+    return aligned_alloc(LINEAR_ALIGNMENT, (size + LINEAR_ALIGNMENT - 1) & ~(LINEAR_ALIGNMENT - 1));
+}
+
+void linearFree(void* mem)
+{
+    free(mem);
+}
+
+void* vramAlloc(size_t size)
+{
+    return linearAlloc(size);
+}
+
+void vramFree(void* mem)
+{
+    linearFree(mem);
+}
+
+Result GX_DisplayTransfer(u32* inadr, u32 indim, u32* outadr, u32 outdim, u32 flags)
+{
+    const Pica::DisplayTransfer::Config config = Pica::DisplayTransfer::Config::FromRegisters(indim, outdim, flags);
+    return Pica::DisplayTransfer::Run(config, (const u8*)inadr, (u8*)outadr) ? 0 : RESULT_INVALID_COMBINATION;
+}
+
+static void MemoryFill(u32* start, u32 value, u32* end, u16 control)
+{
+    if (start == nullptr || !(control & Pica::MemoryFill::START) || end <= start)
+        return;
+
+    Pica::MemoryFill::Fill((u8*)start, (u8*)end - (u8*)start, value, Pica::MemoryFill::WidthFromControl(control));
+}
+
+Result GX_MemoryFill(u32* buf0a, u32 buf0v, u32* buf0e, u16 control0, u32* buf1a, u32 buf1v, u32* buf1e, u16 control1)
+{
+    MemoryFill(buf0a, buf0v, buf0e, control0);
+    MemoryFill(buf1a, buf1v, buf1e, control1);
+    return 0;
+}
+
+void gspWaitForPPF() {}
+void gspWaitForPSC0() {}
+void gspWaitForPSC1() {}
+
+Result GSPGPU_FlushDataCache(const void* adr, u32 size)
+{
+    return 0;
+}
+
+Result GSPGPU_InvalidateDataCache(const void* adr, u32 size)
+{
+    return 0;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <3ds.h>
+
+namespace Host {
+
+/// Anything a handle can refer to. Objects threads can wait on derive from WaitObject, in kernel.h.
+class Object {
+public:
+    virtual ~Object() {}
+
+    virtual bool IsWaitable() const { return false; }
+};
+
+/// Serializes all kernel object state, like the single core the 3DS kernel runs on.
+std::mutex& KernelLock();
+
+/// Returns a new handle to `object`. Handle values are never reused.
+Handle CreateHandle(std::shared_ptr<Object> object);
+
+/// Returns the object `handle` refers to, or nullptr.
+std::shared_ptr<Object> GetObjectImpl(Handle handle);
+
+/// Returns the object `handle` refers to if it is a T, or nullptr.
+template <typename T>
+std::shared_ptr<T> GetObject(Handle handle)
+{
+    return std::dynamic_pointer_cast<T>(GetObjectImpl(handle));
+}
+
+/// Removes `handle`. Returns false if it did not exist.
+bool CloseHandle(Handle handle);
+
+/// Host directory standing in for the root of the SD card.
+const std::string& SdmcRoot();
+
+} // namespace
@@ -0,0 +1,363 @@
+#include <map>
+#include <vector>
+#include <pthread.h>
+
+#include "kernel.h"
+
+namespace Host {
+
+static std::mutex kernel_lock;
+static std::map<Handle, std::shared_ptr<Object>> handles;
+// Starts high, so that handles never look like small integers or 0
+static Handle next_handle = 0x10000;
+
+std::mutex& KernelLock()
+{
+    return kernel_lock;
+}
+
+// Callers of these three hold the kernel lock
+static Handle CreateHandleLocked(std::shared_ptr<Object> object)
+{
+    const Handle handle = next_handle++;
+    handles[handle] = std::move(object);
+    return handle;
+}
+
+static std::shared_ptr<Object> GetObjectLocked(Handle handle)
+{
+    auto it = handles.find(handle);
+    return it == handles.end() ? nullptr : it->second;
+}
+
+template <typename T>
+static std::shared_ptr<T> GetLocked(Handle handle)
+{
+    return std::dynamic_pointer_cast<T>(GetObjectLocked(handle));
+}
+
+Handle CreateHandle(std::shared_ptr<Object> object)
+{
+    std::lock_guard<std::mutex> lock(kernel_lock);
+    return CreateHandleLocked(std::move(object));
+}
+
+std::shared_ptr<Object> GetObjectImpl(Handle handle)
+{
+    std::lock_guard<std::mutex> lock(kernel_lock);
+    return GetObjectLocked(handle);
+}
+
+bool CloseHandle(Handle handle)
+{
+    std::shared_ptr<Object> object;
+    std::lock_guard<std::mutex> lock(kernel_lock);
+    auto it = handles.find(handle);
+    if (it == handles.end())
+        return false;
+    // Destroyed after the lock is released, in case the destructor needs it
+    object = std::move(it->second);
+    handles.erase(it);
+    return true;
+}
+
+class Mutex : public WaitObject, public std::enable_shared_from_this<Mutex> {
+public:
+    bool ShouldWait(const Thread* thread) const override { return lock_count != 0 && owner != thread; }
+
+    void Acquire(Thread* thread) override {
+        if (lock_count++ == 0) {
+            owner = thread;
+            thread->owned.push_back(shared_from_this());
+        }
+    }
+
+    void OnOwnerExit(Thread* thread) override {
+        owner = nullptr;
+        lock_count = 0;
+        WakeWaiters();
+    }
+
+    void Release() {
+        if (--lock_count != 0)
+            return;
+
+        for (auto it = owner->owned.begin(); it != owner->owned.end(); ++it) {
+            if (it->get() == this) {
+                owner->owned.erase(it);
+                break;
+            }
+        }
+        owner = nullptr;
+        WakeWaiters();
+    }
+
+    Thread* owner = nullptr;
+    u32 lock_count = 0;
+};
+
+class Event : public WaitObject {
+public:
+    explicit Event(ResetType reset_type) : reset_type(reset_type) {}
+
+    bool ShouldWait(const Thread* thread) const override { return !signaled; }
+
+    void Acquire(Thread* thread) override {
+        if (reset_type == RESET_ONESHOT)
+            signaled = false;
+    }
+
+    void Signal() {
+        signaled = true;
+        WakeWaiters();
+        // Pulse events wake the threads already waiting, and no others
+        if (reset_type == RESET_PULSE)
+            signaled = false;
+    }
+
+    ResetType reset_type;
+    bool signaled = false;
+};
+
+class Semaphore : public WaitObject {
+public:
+    Semaphore(s32 count, s32 max_count) : count(count), max_count(max_count) {}
+
+    bool ShouldWait(const Thread* thread) const override { return count == 0; }
+
+    void Acquire(Thread* thread) override { count--; }
+
+    s32 count;
+    s32 max_count;
+};
+
+} // namespace
+
+using namespace Host;
+
+Result svcCreateThread(Handle* thread, ThreadFunc entrypoint, u32 arg, u32* stack_top, s32 thread_priority, s32 processor_id)
+{
+    if (thread_priority < PRIORITY_HIGHEST || thread_priority > PRIORITY_LOWEST)
+        return RESULT_OUT_OF_RANGE;
+
+    std::unique_lock<std::mutex> lock(kernel_lock);
+    CurrentThread(lock);
+    auto object = StartThread(entrypoint, (void*)(uintptr_t)arg, thread_priority);
+    if (!object)
+        return RESULT_OUT_OF_HANDLES;
+
+    *thread = CreateHandleLocked(object);
+    Reschedule(lock);
+    return 0;
+}
+
+void svcExitThread()
+{
+    {
+        std::unique_lock<std::mutex> lock(kernel_lock);
+        CurrentThread(lock);
+        ExitThread(lock);
+    }
+    pthread_exit(nullptr);
+}
+
+void svcSleepThread(s64 ns)
+{
+    std::unique_lock<std::mutex> lock(kernel_lock);
+    CurrentThread(lock);
+    if (ns <= 0) {
+        Yield(lock);
+        return;
+    }
+
+    s32 index;
+    Wait(lock, {}, false, KernelTime() + ns, index);
+}
+
+Result svcGetThreadPriority(s32* out, Handle handle)
+{
+    std::unique_lock<std::mutex> lock(kernel_lock);
+    Thread* current = CurrentThread(lock);
+    if (handle == CUR_THREAD_HANDLE) {
+        *out = current->priority;
+        return 0;
+    }
+
+    auto thread = GetLocked<Thread>(handle);
+    if (!thread)
+        return RESULT_INVALID_HANDLE;
+    *out = thread->priority;
+    return 0;
+}
+
+Result svcCreateMutex(Handle* mutex, bool initially_locked)
+{
+    std::unique_lock<std::mutex> lock(kernel_lock);
+    Thread* current = CurrentThread(lock);
+    auto object = std::make_shared<Mutex>();
+    if (initially_locked)
+        object->Acquire(current);
+    *mutex = CreateHandleLocked(object);
+    return 0;
+}
+
+Result svcReleaseMutex(Handle handle)
+{
+    std::unique_lock<std::mutex> lock(kernel_lock);
+    Thread* current = CurrentThread(lock);
+    auto mutex = GetLocked<Mutex>(handle);
+    if (!mutex)
+        return RESULT_INVALID_HANDLE;
+    if (mutex->lock_count == 0 || mutex->owner != current)
+        return RESULT_NOT_OWNER;
+
+    mutex->Release();
+    Reschedule(lock);
+    return 0;
+}
+
+Result svcCreateEvent(Handle* event, ResetType reset_type)
+{
+    *event = CreateHandle(std::make_shared<Event>(reset_type));
+    return 0;
+}
+
+Result svcSignalEvent(Handle handle)
+{
+    std::unique_lock<std::mutex> lock(kernel_lock);
+    CurrentThread(lock);
+    auto event = GetLocked<Event>(handle);
+    if (!event)
+        return RESULT_INVALID_HANDLE;
+
+    event->Signal();
+    Reschedule(lock);
+    return 0;
+}
+
+Result svcClearEvent(Handle handle)
+{
+    std::lock_guard<std::mutex> lock(kernel_lock);
+    auto event = GetLocked<Event>(handle);
+    if (!event)
+        return RESULT_INVALID_HANDLE;
+
+    event->signaled = false;
+    return 0;
+}
+
+Result svcCreateSemaphore(Handle* semaphore, s32 initial_count, s32 max_count)
+{
+    if (initial_count < 0 || max_count < initial_count)
+        return RESULT_OUT_OF_RANGE;
+
+    *semaphore = CreateHandle(std::make_shared<Semaphore>(initial_count, max_count));
+    return 0;
+}
+
+Result svcReleaseSemaphore(s32* count, Handle handle, s32 release_count)
+{
+    std::unique_lock<std::mutex> lock(kernel_lock);
+    CurrentThread(lock);
+    auto semaphore = GetLocked<Semaphore>(handle);
+    if (!semaphore)
+        return RESULT_INVALID_HANDLE;
+    if (release_count < 0 || release_count > semaphore->max_count - semaphore->count)
+        return RESULT_OUT_OF_RANGE;
+
+    *count = semaphore->count;
+    semaphore->count += release_count;
+    semaphore->WakeWaiters();
+    Reschedule(lock);
+    return 0;
+}
+
+Result svcWaitSynchronizationN(s32* out, const Handle* handles, s32 handles_num, bool wait_all, s64 nanoseconds)
+{
+    if (handles_num < 0 || handles_num > 256)
+        return RESULT_INVALID_RANGE;
+    if (handles == nullptr)
+        return RESULT_INVALID_POINTER;
+
+    std::unique_lock<std::mutex> lock(kernel_lock);
+    Thread* current = CurrentThread(lock);
+
+    // Nothing is acquired unless every handle is valid
+    std::vector<std::shared_ptr<WaitObject>> objects;
+    for (s32 i = 0; i < handles_num; ++i) {
+        auto object = GetLocked<WaitObject>(handles[i]);
+        if (!object)
+            return RESULT_INVALID_HANDLE;
+        objects.push_back(object);
+    }
+
+    if (wait_all) {
+        bool ready = true;
+        for (auto& object : objects)
+            ready = ready && !object->ShouldWait(current);
+        if (ready) {
+            // Zero handles pass right through, without an index
+            if (handles_num != 0)
+                *out = -1;
+            for (auto& object : objects)
+                object->Acquire(current);
+            return 0;
+        }
+    } else {
+        // The first of the objects that is available, even if it is also given later
+        for (s32 i = 0; i < handles_num; ++i) {
+            if (!objects[i]->ShouldWait(current)) {
+                objects[i]->Acquire(current);
+                *out = i;
+                return 0;
+            }
+        }
+    }
+
+    if (nanoseconds == 0) {
+        *out = -1;
+        return RESULT_TIMEOUT;
+    }
+
+    // Negative timeouts wait forever. Once woken by an object, the index is the last one it was
+    // given at.
+    const u64 deadline = nanoseconds < 0 ? U64_MAX : KernelTime() + nanoseconds;
+    s32 index;
+    const Result result = Wait(lock, objects, wait_all, deadline, index);
+    *out = index;
+    return result;
+}
+
+Result svcWaitSynchronization(Handle handle, s64 nanoseconds)
+{
+    s32 index;
+    return svcWaitSynchronizationN(&index, &handle, 1, false, nanoseconds);
+}
+
+Result svcDuplicateHandle(Handle* out, Handle original)
+{
+    std::lock_guard<std::mutex> lock(kernel_lock);
+    auto object = GetObjectLocked(original);
+    if (!object)
+        return RESULT_INVALID_HANDLE;
+
+    *out = CreateHandleLocked(object);
+    return 0;
+}
+
+Result svcCloseHandle(Handle handle)
+{
+    return CloseHandle(handle) ? 0 : RESULT_INVALID_HANDLE;
+}
+
+u64 svcGetSystemTick()
+{
+    const u64 ns = KernelTime();
+    return ns / 1000000000 * SYSCLOCK_ARM11 + ns % 1000000000 * SYSCLOCK_ARM11 / 1000000000;
+}
+
+Result svcOutputDebugString(const char* str, s32 length)
+{
+    // Everything logged is also printed to stdout, so there is nowhere else to send it
+    return 0;
+}
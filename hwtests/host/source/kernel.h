@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "host.h"
+
+// The kernel's scheduler and wait queues, shared by the kernel objects in kernel.cpp. Everything
+// here is only used with the kernel lock held.
+
+namespace Host {
+
+class Thread;
+class WaitObject;
+
+/// A thread's place in the wait queue of one object. Threads waiting on an object more than once
+/// get one node, holding the last index the object was given at.
+struct WaitNode {
+    Thread* thread;
+    WaitObject* object;
+    s32 index;
+    WaitNode* prev;
+    WaitNode* next;
+};
+
+/**
+ * An object threads can wait on. Its waiters are queued by priority, first come first served
+ * within one priority, and are handed the object in that order.
+ */
+class WaitObject : public Object {
+public:
+    bool IsWaitable() const override { return true; }
+
+    /// Whether `thread` has to keep waiting for this object.
+    virtual bool ShouldWait(const Thread* thread) const = 0;
+
+    /// Called once a wait of `thread` on this object is satisfied, e.g. to take a mutex or reset
+    /// an event.
+    virtual void Acquire(Thread* thread) {}
+
+    /// Called when `thread` exits while it owns this object, as it does a mutex.
+    virtual void OnOwnerExit(Thread* thread) {}
+
+    /// Hands the object to the waiters that can now have it, highest priority first. Call whenever
+    /// the object may have stopped needing a wait.
+    void WakeWaiters();
+
+    void Enqueue(WaitNode* node);
+    void Dequeue(WaitNode* node);
+
+protected:
+    // Waiters in the order they are woken
+    WaitNode* head = nullptr;
+    WaitNode* tail = nullptr;
+};
+
+class Thread : public WaitObject {
+public:
+    enum class State { Ready, Running, Waiting, Exited };
+
+    bool ShouldWait(const Thread* thread) const override { return state != State::Exited; }
+
+    s32 priority = 0;
+    State state = State::Ready;
+    ThreadFunc entrypoint = nullptr;
+    void* arg = nullptr;
+
+    // The wait in progress: every object waited on, and the result handed back when it ends
+    std::vector<std::shared_ptr<WaitObject>> wait_objects;
+    std::vector<WaitNode> wait_nodes;
+    bool wait_all = false;
+    u64 wait_deadline = 0;
+    u64 wait_sequence = 0;
+    Result wait_result = 0;
+    s32 wait_index = -1;
+    // Address of the arbitration in progress, which arbiters wake threads by
+    uintptr_t arbitration_address = 0;
+
+    /// Objects this thread owns, which are given up when it exits.
+    std::vector<std::shared_ptr<WaitObject>> owned;
+
+    /// Futex word the host thread sleeps on while another thread runs.
+    std::atomic<u32> wake_count{0};
+};
+
+/// Lowest and highest priority, and that of the main thread.
+const s32 PRIORITY_HIGHEST = 0x00;
+const s32 PRIORITY_LOWEST = 0x3F;
+const s32 PRIORITY_MAIN = 0x30;
+
+/// Nanoseconds on the kernel's clock, which svcGetSystemTick() reads.
+u64 KernelTime();
+
+/// The thread of the calling host thread. Host threads that were not created by svcCreateThread
+/// become threads of the main thread's priority, and wait until they are scheduled.
+Thread* CurrentThread(std::unique_lock<std::mutex>& lock);
+
+/// Creates a thread that starts at `entrypoint` once it is scheduled. Returns nullptr if the host
+/// can not create any more threads.
+std::shared_ptr<Thread> StartThread(ThreadFunc entrypoint, void* arg, s32 priority);
+
+/**
+ * Blocks the current thread on `objects`, until any or all of them have been acquired, or until
+ * KernelTime() reaches `deadline` (U64_MAX for never). None of the objects may be available.
+ * Returns the index of the object acquired, or -1 when all were, in `index`.
+ */
+Result Wait(std::unique_lock<std::mutex>& lock, const std::vector<std::shared_ptr<WaitObject>>& objects,
+            bool wait_all, u64 deadline, s32& index);
+
+/// Ends the wait of `thread`, which returns `result` and `index` once it runs again. Objects that
+/// wake their waiters themselves, rather than through WakeWaiters(), call this for each of them.
+void EndWait(Thread* thread, Result result, s32 index);
+
+/// Puts the current thread behind the other ready threads of its priority.
+void Yield(std::unique_lock<std::mutex>& lock);
+
+/// Runs a higher priority thread, if one has become ready. Call after anything that may wake one.
+void Reschedule(std::unique_lock<std::mutex>& lock);
+
+/// Ends the current thread: it gives up what it owns, wakes its waiters, and is never run again.
+void ExitThread(std::unique_lock<std::mutex>& lock);
+
+} // namespace
@@ -0,0 +1,370 @@
+#include <chrono>
+#include <deque>
+#include <map>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "kernel.h"
+
+// Threads are host threads, but only the one the 3DS kernel would run gets to: the highest
+// priority ready thread, first come first served within a priority. It keeps running until it
+// waits, exits, yields or wakes a thread of higher priority, and then hands over to the next one
+// directly. Every other host thread sleeps on its own futex word, so a switch wakes exactly one.
+// Which thread runs when is therefore decided by the program alone, not by the host.
+//
+// For the same reason, timeouts only end once every thread is waiting, as if threads took no time
+// to run. The kernel clock then skips ahead to the earliest one instead of sleeping until it, as
+// emulators do.
+
+namespace Host {
+
+static Thread* running = nullptr;
+
+static std::deque<Thread*> ready_queues[PRIORITY_LOWEST + 1];
+// Bit p is set while ready_queues[p] is not empty
+static u64 ready_mask = 0;
+
+// Threads waiting with a timeout, by deadline and then by when they started waiting
+static std::map<std::pair<u64, u64>, Thread*> timeouts;
+static u64 next_wait_sequence = 0;
+
+static std::atomic<u64> skipped_time{0};
+
+// Set during static initialization, which happens on the main thread
+static const pthread_t main_host_thread = pthread_self();
+
+// Keeps the thread of each host thread alive, and ends it when the host thread ends
+struct CurrentThreadHolder {
+    ~CurrentThreadHolder();
+
+    std::shared_ptr<Thread> thread;
+};
+
+static thread_local CurrentThreadHolder current;
+
+static void SleepOn(std::atomic<u32>& word, u32 value)
+{
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<u32*>(&word), FUTEX_WAIT_PRIVATE, value, nullptr, nullptr, 0);
+#else
+    while (word.load(std::memory_order_acquire) == value)
+        sched_yield();
+#endif
+}
+
+static void WakeOne(std::atomic<u32>& word)
+{
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<u32*>(&word), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#endif
+}
+
+u64 KernelTime()
+{
+    const u64 now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    return now + skipped_time.load(std::memory_order_relaxed);
+}
+
+static void PushReady(Thread* thread, bool front)
+{
+    thread->state = Thread::State::Ready;
+    std::deque<Thread*>& queue = ready_queues[thread->priority];
+    if (front)
+        queue.push_front(thread);
+    else
+        queue.push_back(thread);
+    ready_mask |= 1ull << thread->priority;
+}
+
+static Thread* HighestReady()
+{
+    if (ready_mask == 0)
+        return nullptr;
+    return ready_queues[__builtin_ctzll(ready_mask)].front();
+}
+
+static void PopReady(Thread* thread)
+{
+    std::deque<Thread*>& queue = ready_queues[thread->priority];
+    queue.pop_front();
+    if (queue.empty())
+        ready_mask &= ~(1ull << thread->priority);
+}
+
+static void Dispatch(Thread* thread)
+{
+    running = thread;
+    thread->state = Thread::State::Running;
+    thread->wake_count.fetch_add(1, std::memory_order_release);
+    WakeOne(thread->wake_count);
+}
+
+// Sleeps until `thread` is the one running
+static void Park(Thread* thread, std::unique_lock<std::mutex>& lock)
+{
+    while (running != thread) {
+        // Read with the lock held, so that a Dispatch() after it is released changes the word
+        const u32 seen = thread->wake_count.load(std::memory_order_acquire);
+        lock.unlock();
+        SleepOn(thread->wake_count, seen);
+        lock.lock();
+    }
+}
+
+void EndWait(Thread* thread, Result result, s32 index)
+{
+    for (WaitNode& node : thread->wait_nodes)
+        node.object->Dequeue(&node);
+    if (thread->wait_deadline != U64_MAX)
+        timeouts.erase(std::make_pair(thread->wait_deadline, thread->wait_sequence));
+
+    thread->wait_nodes.clear();
+    thread->wait_objects.clear();
+    thread->wait_result = result;
+    thread->wait_index = index;
+    PushReady(thread, false);
+}
+
+static void ExpireTimeouts(u64 now)
+{
+    while (!timeouts.empty() && timeouts.begin()->first.first <= now)
+        EndWait(timeouts.begin()->second, RESULT_TIMEOUT, -1);
+}
+
+void WaitObject::Enqueue(WaitNode* node)
+{
+    // Behind every waiter of the same or a higher priority
+    WaitNode* prev = tail;
+    while (prev != nullptr && prev->thread->priority > node->thread->priority)
+        prev = prev->prev;
+
+    node->prev = prev;
+    node->next = prev != nullptr ? prev->next : head;
+    if (node->next != nullptr)
+        node->next->prev = node;
+    else
+        tail = node;
+    if (prev != nullptr)
+        prev->next = node;
+    else
+        head = node;
+}
+
+void WaitObject::Dequeue(WaitNode* node)
+{
+    if (node->prev != nullptr)
+        node->prev->next = node->next;
+    else
+        head = node->next;
+    if (node->next != nullptr)
+        node->next->prev = node->prev;
+    else
+        tail = node->prev;
+}
+
+void WaitObject::WakeWaiters()
+{
+    for (WaitNode* node = head; node != nullptr;) {
+        // Ending a wait frees its nodes, but each thread has only one in this queue
+        WaitNode* next = node->next;
+        Thread* thread = node->thread;
+
+        if (!ShouldWait(thread)) {
+            if (!thread->wait_all) {
+                Acquire(thread);
+                EndWait(thread, 0, node->index);
+            } else {
+                bool ready = true;
+                for (const WaitNode& other : thread->wait_nodes)
+                    ready = ready && !other.object->ShouldWait(thread);
+                if (ready) {
+                    for (const WaitNode& other : thread->wait_nodes)
+                        other.object->Acquire(thread);
+                    EndWait(thread, 0, -1);
+                }
+            }
+        }
+        node = next;
+    }
+}
+
+Thread* CurrentThread(std::unique_lock<std::mutex>& lock)
+{
+    if (current.thread)
+        return current.thread.get();
+
+    current.thread = std::make_shared<Thread>();
+    Thread* thread = current.thread.get();
+    thread->priority = PRIORITY_MAIN;
+    if (running == nullptr) {
+        Dispatch(thread);
+    } else {
+        PushReady(thread, false);
+        Park(thread, lock);
+    }
+    return thread;
+}
+
+static void* ThreadMain(void* param)
+{
+    current.thread = std::move(*static_cast<std::shared_ptr<Thread>*>(param));
+    delete static_cast<std::shared_ptr<Thread>*>(param);
+
+    Thread* thread = current.thread.get();
+    {
+        std::unique_lock<std::mutex> lock(KernelLock());
+        Park(thread, lock);
+    }
+
+    thread->entrypoint(thread->arg);
+
+    std::unique_lock<std::mutex> lock(KernelLock());
+    ExitThread(lock);
+    return nullptr;
+}
+
+std::shared_ptr<Thread> StartThread(ThreadFunc entrypoint, void* arg, s32 priority)
+{
+    auto thread = std::make_shared<Thread>();
+    thread->entrypoint = entrypoint;
+    thread->arg = arg;
+    thread->priority = priority;
+
+    // The stack given is for the 3DS. Host stacks are kept small, so that thousands of threads fit.
+    pthread_t host_thread;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    pthread_attr_setstacksize(&attr, 512 * 1024);
+
+    auto param = new std::shared_ptr<Thread>(thread);
+    const int error = pthread_create(&host_thread, &attr, ThreadMain, param);
+    pthread_attr_destroy(&attr);
+    if (error != 0) {
+        delete param;
+        return nullptr;
+    }
+
+    PushReady(thread.get(), false);
+    return thread;
+}
+
+Result Wait(std::unique_lock<std::mutex>& lock, const std::vector<std::shared_ptr<WaitObject>>& objects,
+            bool wait_all, u64 deadline, s32& index)
+{
+    Thread* thread = current.thread.get();
+
+    // One node per object, so that a thread is never queued twice on one object. Filled in
+    // before any is queued, as the vector must not grow once they are.
+    thread->wait_objects = objects;
+    thread->wait_nodes.clear();
+    thread->wait_nodes.reserve(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i) {
+        WaitNode* existing = nullptr;
+        for (WaitNode& node : thread->wait_nodes) {
+            if (node.object == objects[i].get())
+                existing = &node;
+        }
+        if (existing != nullptr)
+            existing->index = (s32)i;
+        else
+            thread->wait_nodes.push_back({ thread, objects[i].get(), (s32)i, nullptr, nullptr });
+    }
+    for (WaitNode& node : thread->wait_nodes)
+        node.object->Enqueue(&node);
+
+    thread->wait_all = wait_all;
+    thread->wait_deadline = deadline;
+    if (deadline != U64_MAX) {
+        thread->wait_sequence = next_wait_sequence++;
+        timeouts[std::make_pair(deadline, thread->wait_sequence)] = thread;
+    }
+    thread->state = Thread::State::Waiting;
+
+    Reschedule(lock);
+
+    index = thread->wait_index;
+    return thread->wait_result;
+}
+
+void Yield(std::unique_lock<std::mutex>& lock)
+{
+    PushReady(current.thread.get(), false);
+    Reschedule(lock);
+}
+
+void Reschedule(std::unique_lock<std::mutex>& lock)
+{
+    Thread* thread = current.thread.get();
+
+    while (true) {
+        Thread* next = HighestReady();
+
+        if (thread->state == Thread::State::Running) {
+            if (next == nullptr || next->priority >= thread->priority)
+                return;
+            // Preempted, so it runs again before the other threads of its priority
+            PushReady(thread, true);
+            continue;
+        }
+
+        if (next != nullptr) {
+            PopReady(next);
+            Dispatch(next);
+            break;
+        }
+
+        if (timeouts.empty()) {
+            running = nullptr;
+            if (thread->state == Thread::State::Exited)
+                return;
+            fprintf(stderr, "Every thread is waiting, without a timeout\n");
+            abort();
+        }
+
+        // Every thread is waiting, so nothing can happen before the first timeout. Any others that
+        // have passed in the meantime end along with it.
+        const u64 deadline = timeouts.begin()->first.first;
+        const u64 now = KernelTime();
+        if (deadline > now)
+            skipped_time.fetch_add(deadline - now, std::memory_order_relaxed);
+        ExpireTimeouts(KernelTime());
+    }
+
+    if (thread->state != Thread::State::Exited)
+        Park(thread, lock);
+}
+
+void ExitThread(std::unique_lock<std::mutex>& lock)
+{
+    Thread* thread = current.thread.get();
+    thread->state = Thread::State::Exited;
+
+    const std::vector<std::shared_ptr<WaitObject>> owned = std::move(thread->owned);
+    thread->owned.clear();
+    for (const auto& object : owned)
+        object->OnOwnerExit(thread);
+    thread->WakeWaiters();
+
+    Reschedule(lock);
+}
+
+CurrentThreadHolder::~CurrentThreadHolder()
+{
+    // The main thread ends with the process, which takes every other thread with it
+    if (!thread || thread->state == Thread::State::Exited || pthread_equal(pthread_self(), main_host_thread))
+        return;
+
+    std::unique_lock<std::mutex> lock(KernelLock());
+    ExitThread(lock);
+}
+
+} // namespace
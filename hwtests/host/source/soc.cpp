@@ -0,0 +1,14 @@
+#include <3ds.h>
+
+Result socInit(u32* context_addr, u32 context_size)
+{
+    // The 3DS requires a page aligned buffer, shared with the service
+    if (context_addr == nullptr || ((uintptr_t)context_addr & 0xFFF) != 0 || (context_size & 0xFFF) != 0)
+        return RESULT_INVALID_POINTER;
+    return 0;
+}
+
+Result socExit()
+{
+    return 0;
+}
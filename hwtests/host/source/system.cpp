@@ -0,0 +1,63 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "host.h"
+
+namespace Host {
+
+const std::string& SdmcRoot()
+{
+    static const std::string root = [] {
+        const char* path = getenv("HWTESTS_SDMC");
+        if (path != nullptr && path[0] != '\0')
+            return std::string(path);
+
+        char cwd[4096];
+        return std::string(getcwd(cwd, sizeof(cwd)) ? cwd : ".");
+    }();
+    return root;
+}
+
+} // namespace
+
+using namespace Host;
+
+void gfxInitDefault() {}
+void gfxExit() {}
+void gfxFlushBuffers() {}
+void gfxSwapBuffers() {}
+
+PrintConsole* consoleInit(gfxScreen_t screen, PrintConsole* console)
+{
+    return console;
+}
+
+void consoleClear()
+{
+    fflush(stdout);
+}
+
+Result sdmcInit()
+{
+    return chdir(SdmcRoot().c_str()) == 0 ? 0 : RESULT_FS_NOT_FOUND;
+}
+
+Result sdmcExit()
+{
+    return 0;
+}
+
+bool aptMainLoop()
+{
+    return false;
+}
+
+void hidScanInput() {}
+
+u32 hidKeysDown()
+{
+    return 0;
+}
+
+void gspWaitForVBlank() {}
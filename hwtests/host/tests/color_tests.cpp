@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "output.h"
+#include "common/string_funcs.h"
+#include "pica/color.h"
+#include "tests/benchmark.h"
+#include "tests/test.h"
+#include "model.h"
+
+namespace Model {
+namespace Color {
+
+using Pica::PixelFormat;
+using Pica::Kernel;
+
+static const std::string tag = "Model::Color";
+
+static const PixelFormat formats[] = {
+    PixelFormat::RGBA8, PixelFormat::RGB8, PixelFormat::RGB565, PixelFormat::RGB5A1, PixelFormat::RGBA4,
+};
+
+static const char* format_names[] = { "RGBA8", "RGB8", "RGB565", "RGB5A1", "RGBA4" };
+
+static const Kernel kernels[] = { Kernel::Scalar, Kernel::Vector, Kernel::SSE41, Kernel::AVX2 };
+
+struct HardwareResult {
+    PixelFormat in;
+    PixelFormat out;
+    u32 input;
+    u32 expected;
+};
+
+// Single pixel results measured on hardware, from the tests in source/tests/gpu/displaytransfer.cpp
+static const HardwareResult hardware_results[] = {
+    { PixelFormat::RGBA8, PixelFormat::RGBA8, 0xFF000000, 0xFF000000 },
+    { PixelFormat::RGBA8, PixelFormat::RGBA8, 0x00FF0000, 0x00FF0000 },
+    { PixelFormat::RGBA8, PixelFormat::RGBA8, 0x0000FF00, 0x0000FF00 },
+    { PixelFormat::RGBA8, PixelFormat::RGBA8, 0x000000FF, 0x000000FF },
+    { PixelFormat::RGBA8, PixelFormat::RGB8, 0xFF000000, 0xFF0000 },
+    { PixelFormat::RGBA8, PixelFormat::RGB8, 0x00FF0000, 0x00FF00 },
+    { PixelFormat::RGBA8, PixelFormat::RGB8, 0x0000FF00, 0x0000FF },
+    { PixelFormat::RGBA8, PixelFormat::RGB8, 0x000000FF, 0x000000 },
+    { PixelFormat::RGBA8, PixelFormat::RGB565, 0xFF000000, 0xF800 },
+    { PixelFormat::RGBA8, PixelFormat::RGB565, 0x00FF0000, 0x07E0 },
+    { PixelFormat::RGBA8, PixelFormat::RGB565, 0x0000FF00, 0x001F },
+    { PixelFormat::RGBA8, PixelFormat::RGB565, 0x000000FF, 0x0000 },
+    { PixelFormat::RGBA8, PixelFormat::RGB5A1, 0xFF000000, 0xF800 },
+    { PixelFormat::RGBA8, PixelFormat::RGB5A1, 0x00FF0000, 0x07C0 },
+    { PixelFormat::RGBA8, PixelFormat::RGB5A1, 0x0000FF00, 0x003E },
+    { PixelFormat::RGBA8, PixelFormat::RGB5A1, 0x000000FF, 0x0001 },
+    { PixelFormat::RGBA8, PixelFormat::RGB5A1, 0x00000064, 0x0000 },
+    { PixelFormat::RGBA8, PixelFormat::RGB5A1, 0x0000007F, 0x0000 },
+    { PixelFormat::RGBA8, PixelFormat::RGB5A1, 0x00000080, 0x0001 },
+    { PixelFormat::RGBA8, PixelFormat::RGB5A1, 0x000000FE, 0x0001 },
+    { PixelFormat::RGBA8, PixelFormat::RGBA4, 0xFF000000, 0xF000 },
+    { PixelFormat::RGBA8, PixelFormat::RGBA4, 0x00FF0000, 0x0F00 },
+    { PixelFormat::RGBA8, PixelFormat::RGBA4, 0x0000FF00, 0x00F0 },
+    { PixelFormat::RGBA8, PixelFormat::RGBA4, 0x000000FF, 0x000F },
+    { PixelFormat::RGBA8, PixelFormat::RGBA4, 0x00000064, 0x0006 },
+    { PixelFormat::RGBA8, PixelFormat::RGBA4, 0x0000007F, 0x0007 },
+    { PixelFormat::RGBA8, PixelFormat::RGBA4, 0x00000080, 0x0008 },
+    { PixelFormat::RGBA8, PixelFormat::RGBA4, 0x000000FE, 0x000F },
+    { PixelFormat::RGB8, PixelFormat::RGB8, 0xFF0000, 0xFF0000 },
+    { PixelFormat::RGB8, PixelFormat::RGB8, 0x00FF00, 0x00FF00 },
+    { PixelFormat::RGB8, PixelFormat::RGB8, 0x0000FF, 0x0000FF },
+    { PixelFormat::RGB5A1, PixelFormat::RGB565, 0xF800, 0xF800 },
+    { PixelFormat::RGB5A1, PixelFormat::RGB565, 0x07C0, 0x07E0 },
+    { PixelFormat::RGB5A1, PixelFormat::RGB565, 0x003E, 0x001F },
+    { PixelFormat::RGB5A1, PixelFormat::RGB565, 0x0001, 0x0000 },
+    { PixelFormat::RGB5A1, PixelFormat::RGB5A1, 0xF800, 0xF800 },
+    { PixelFormat::RGB5A1, PixelFormat::RGB5A1, 0x07C0, 0x07C0 },
+    { PixelFormat::RGB5A1, PixelFormat::RGB5A1, 0x003E, 0x003E },
+    { PixelFormat::RGB5A1, PixelFormat::RGB5A1, 0x0001, 0x0001 },
+    { PixelFormat::RGB5A1, PixelFormat::RGBA4, 0xF800, 0xF000 },
+    { PixelFormat::RGB5A1, PixelFormat::RGBA4, 0x07C0, 0x0F00 },
+    { PixelFormat::RGB5A1, PixelFormat::RGBA4, 0x003E, 0x00F0 },
+    { PixelFormat::RGB5A1, PixelFormat::RGBA4, 0x0001, 0x000F },
+    { PixelFormat::RGBA4, PixelFormat::RGB5A1, 0xF000, 0xF800 },
+    { PixelFormat::RGBA4, PixelFormat::RGB5A1, 0x0F00, 0x07C0 },
+    { PixelFormat::RGBA4, PixelFormat::RGB5A1, 0x00F0, 0x003E },
+    { PixelFormat::RGBA4, PixelFormat::RGB5A1, 0x000F, 0x0001 },
+    { PixelFormat::RGBA4, PixelFormat::RGB5A1, 0x0008, 0x0001 },
+    { PixelFormat::RGBA4, PixelFormat::RGB5A1, 0x0007, 0x0000 },
+};
+
+static std::string PairName(PixelFormat in, PixelFormat out)
+{
+    return Common::FormatString("%s to %s", format_names[(u32)in], format_names[(u32)out]);
+}
+
+// Fills `count` pixels of `format` with a repeatable pseudo random pattern
+static std::vector<u8> RandomPixels(PixelFormat format, size_t count)
+{
+    std::vector<u8> pixels(count * Pica::BytesPerPixel(format));
+    u32 seed = 0x12345678;
+    for (u8& byte : pixels) {
+        seed = seed * 1103515245 + 12345;
+        byte = seed >> 16;
+    }
+    return pixels;
+}
+
+// Every hardware result, converted as part of a run long enough for the vector loops
+static bool HardwareResults(Kernel kernel)
+{
+    const size_t count = 67;
+
+    for (const HardwareResult& result : hardware_results) {
+        const u32 in_bpp = Pica::BytesPerPixel(result.in);
+        const u32 out_bpp = Pica::BytesPerPixel(result.out);
+        std::vector<u8> input(count * in_bpp);
+        std::vector<u8> output(count * out_bpp + 4);
+
+        for (size_t i = 0; i < count; ++i)
+            memcpy(&input[i * in_bpp], &result.input, in_bpp);
+        Pica::Color::Convert(kernel, result.in, result.out, input.data(), output.data(), count);
+
+        for (size_t i = 0; i < count; ++i) {
+            u32 actual = 0;
+            memcpy(&actual, &output[i * out_bpp], out_bpp);
+            TestEquals(actual, result.expected);
+        }
+    }
+    return true;
+}
+
+// Every format pair gives the same bytes as the scalar kernel, for every 16 bit input value and
+// for random 24 and 32 bit ones, at lengths that leave every possible tail
+static bool MatchesScalar(Kernel kernel)
+{
+    for (PixelFormat in : formats) {
+        const size_t count = Pica::BytesPerPixel(in) == 2 ? 0x10000 : 0x4000;
+        std::vector<u8> input = RandomPixels(in, count);
+        if (Pica::BytesPerPixel(in) == 2) {
+            for (u32 i = 0; i < count; ++i)
+                memcpy(&input[i * 2], &i, 2);
+        }
+
+        for (PixelFormat out : formats) {
+            const u32 out_bpp = Pica::BytesPerPixel(out);
+            std::vector<u8> expected(count * out_bpp);
+            std::vector<u8> actual(count * out_bpp);
+
+            Pica::Color::Convert(Kernel::Scalar, in, out, input.data(), expected.data(), count);
+            Pica::Color::Convert(kernel, in, out, input.data(), actual.data(), count);
+            SoftAssert(expected == actual);
+
+            for (size_t length = 0; length < 40; ++length) {
+                std::fill(actual.begin(), actual.end(), 0xCD);
+                Pica::Color::Convert(kernel, in, out, input.data(), actual.data(), length);
+                SoftAssert(memcmp(expected.data(), actual.data(), length * out_bpp) == 0);
+                // Nothing past the end is written
+                SoftAssert(actual[length * out_bpp] == 0xCD);
+            }
+        }
+    }
+    return true;
+}
+
+void TestAll()
+{
+    for (Kernel kernel : kernels) {
+        if (!Pica::IsSupported(kernel)) {
+            Log(Common::FormatString("%s: %s kernel not supported, skipped\n", tag.c_str(), Pica::KernelName(kernel)));
+            continue;
+        }
+
+        const std::string name = Pica::KernelName(kernel);
+        Test(tag, name + ", hardware results", HardwareResults(kernel), true);
+        if (kernel != Kernel::Scalar)
+            Test(tag, name + ", matches scalar", MatchesScalar(kernel), true);
+    }
+}
+
+void BenchmarkAll()
+{
+    // One 400x240 screen
+    const size_t count = 400 * 240;
+
+    for (Kernel kernel : kernels) {
+        if (!Pica::IsSupported(kernel))
+            continue;
+
+        for (PixelFormat in : formats) {
+            const std::vector<u8> input = RandomPixels(in, count);
+            for (PixelFormat out : formats) {
+                if (in == out)
+                    continue;
+
+                std::vector<u8> output(count * Pica::BytesPerPixel(out));
+                const std::string name = Common::FormatString("%s, %s", PairName(in, out).c_str(), Pica::KernelName(kernel));
+                const BenchmarkResult result = Benchmark(tag, name, 20, [&] {
+                    Pica::Color::Convert(kernel, in, out, input.data(), output.data(), count);
+                });
+
+                if (result.median) {
+                    const u64 hundredths = (u64)count * SYSCLOCK_ARM11 / result.median / 10000;
+                    Log(Common::FormatString("    %llu.%02llu megapixels/s\n", hundredths / 100, hundredths % 100));
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+} // namespace
@@ -0,0 +1,511 @@
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "output.h"
+#include "common/string_funcs.h"
+#include "tests/benchmark.h"
+#include "tests/test.h"
+#include "model.h"
+
+// The scheduling the waitsynch.cpp results depend on, but do not check directly. Only one thread
+// runs at a time, so the threads here share plain variables.
+
+namespace Model {
+namespace Kernel {
+
+static const std::string tag = "Model::Kernel";
+
+static const s64 ONE_SECOND = 1000 * 1000 * 1000;
+
+static Handle object;
+static std::vector<u32> trace;
+
+static Result WaitForThreads(const std::vector<Handle>& threads)
+{
+    for (size_t i = 0; i < threads.size(); i += 256) {
+        const s32 count = threads.size() - i < 256 ? threads.size() - i : 256;
+        s32 output;
+        const Result result = svcWaitSynchronizationN(&output, &threads[i], count, true, U64_MAX);
+        if (result != 0)
+            return result;
+    }
+    return 0;
+}
+
+static void CloseThreads(const std::vector<Handle>& threads)
+{
+    for (Handle thread : threads)
+        svcCloseHandle(thread);
+}
+
+static void wait_and_trace_handler(void* arg)
+{
+    svcWaitSynchronization(object, U64_MAX);
+    trace.push_back((u32)(uintptr_t)arg);
+    svcExitThread();
+}
+
+// Waiters are handed a semaphore by priority, first come first served within one
+static bool PriorityWakeOrder()
+{
+    static const s32 priorities[] = { 0x34, 0x32, 0x33, 0x32, 0x31, 0x34, 0x31, 0x33 };
+
+    TestEquals(svcCreateSemaphore(&object, 0, 8), 0);
+    trace.clear();
+
+    std::vector<Handle> threads(8);
+    for (u32 i = 0; i < 8; ++i)
+        TestEquals(svcCreateThread(&threads[i], wait_and_trace_handler, i, nullptr, priorities[i], 0xfffffffe), 0);
+
+    // Every thread runs up to its wait while this one sleeps
+    svcSleepThread(1000);
+    TestEquals(trace.size(), (size_t)0);
+
+    s32 count;
+    TestEquals(svcReleaseSemaphore(&count, object, 3), 0);
+    TestEquals(count, 0);
+    svcSleepThread(1000);
+    TestEquals(trace.size(), (size_t)3);
+
+    TestEquals(svcReleaseSemaphore(&count, object, 5), 0);
+    TestEquals(WaitForThreads(threads), 0);
+
+    static const u32 expected[] = { 4, 6, 1, 3, 2, 7, 0, 5 };
+    TestEquals(trace.size(), (size_t)8);
+    for (u32 i = 0; i < 8; ++i)
+        TestEquals(trace[i], expected[i]);
+
+    CloseThreads(threads);
+    svcCloseHandle(object);
+    return true;
+}
+
+// A waiter of higher priority runs as soon as it is woken, one of lower priority once the thread
+// that woke it waits
+static bool Preemption()
+{
+    TestEquals(svcCreateEvent(&object, RESET_STICKY), 0);
+    trace.clear();
+
+    s32 priority;
+    TestEquals(svcGetThreadPriority(&priority, CUR_THREAD_HANDLE), 0);
+    TestEquals(priority, 0x30);
+
+    std::vector<Handle> threads(2);
+    TestEquals(svcCreateThread(&threads[0], wait_and_trace_handler, 0, nullptr, 0x2F, 0xfffffffe), 0);
+    TestEquals(svcCreateThread(&threads[1], wait_and_trace_handler, 1, nullptr, 0x31, 0xfffffffe), 0);
+    TestEquals(svcGetThreadPriority(&priority, threads[0]), 0);
+    TestEquals(priority, 0x2F);
+
+    svcSleepThread(1000);
+    TestEquals(svcSignalEvent(object), 0);
+    TestEquals(trace.size(), (size_t)1);
+
+    TestEquals(WaitForThreads(threads), 0);
+    TestEquals(trace.size(), (size_t)2);
+
+    CloseThreads(threads);
+    svcCloseHandle(object);
+    return true;
+}
+
+// Signaling wakes every waiter of a sticky or pulse event, and one of a one-shot event. Only the
+// sticky event stays signaled.
+static bool EventResetTypes()
+{
+    static const ResetType types[] = { RESET_ONESHOT, RESET_STICKY, RESET_PULSE };
+    static const u32 woken[] = { 1, 3, 3 };
+
+    for (u32 type = 0; type < 3; ++type) {
+        TestEquals(svcCreateEvent(&object, types[type]), 0);
+        trace.clear();
+
+        std::vector<Handle> threads(3);
+        for (u32 i = 0; i < 3; ++i)
+            TestEquals(svcCreateThread(&threads[i], wait_and_trace_handler, i, nullptr, 0x31, 0xfffffffe), 0);
+        svcSleepThread(1000);
+
+        TestEquals(svcSignalEvent(object), 0);
+        svcSleepThread(1000);
+        TestEquals(trace.size(), (size_t)woken[type]);
+        TestEquals(svcWaitSynchronization(object, 0), types[type] == RESET_STICKY ? 0 : RESULT_TIMEOUT);
+
+        // Lets the rest of the threads go
+        TestEquals(svcClearEvent(object), 0);
+        for (u32 i = woken[type]; i < 3; ++i)
+            TestEquals(svcSignalEvent(object), 0);
+        TestEquals(WaitForThreads(threads), 0);
+        TestEquals(trace[0], 0u);
+
+        CloseThreads(threads);
+        svcCloseHandle(object);
+    }
+    return true;
+}
+
+static void yield_and_trace_handler(void* arg)
+{
+    for (u32 i = 0; i < 3; ++i) {
+        trace.push_back((u32)(uintptr_t)arg);
+        svcSleepThread(0);
+    }
+    svcExitThread();
+}
+
+// Threads of one priority take turns when they yield, in the order they were created
+static bool RoundRobin()
+{
+    trace.clear();
+
+    std::vector<Handle> threads(3);
+    for (u32 i = 0; i < 3; ++i)
+        TestEquals(svcCreateThread(&threads[i], yield_and_trace_handler, i, nullptr, 0x31, 0xfffffffe), 0);
+    TestEquals(WaitForThreads(threads), 0);
+
+    TestEquals(trace.size(), (size_t)9);
+    for (u32 i = 0; i < 9; ++i)
+        TestEquals(trace[i], i % 3);
+
+    CloseThreads(threads);
+    return true;
+}
+
+// Timeouts end as soon as every thread is waiting, with the clock moved on as if they had not
+static bool IdleTimeSkipped()
+{
+    const auto host_start = std::chrono::steady_clock::now();
+    const u64 start = svcGetSystemTick();
+    svcSleepThread(10 * ONE_SECOND);
+    const u64 ticks = svcGetSystemTick() - start;
+    const auto host_elapsed = std::chrono::steady_clock::now() - host_start;
+
+    TestEquals(ticks >= 10 * (u64)SYSCLOCK_ARM11, true);
+    TestEquals(host_elapsed < std::chrono::seconds(1), true);
+    return true;
+}
+
+// Many more waiters than the 3DS could have, all woken by one signal
+static bool ManyWaiters()
+{
+    const u32 count = 1024;
+
+    TestEquals(svcCreateEvent(&object, RESET_STICKY), 0);
+    trace.clear();
+
+    std::vector<Handle> threads(count);
+    for (u32 i = 0; i < count; ++i)
+        TestEquals(svcCreateThread(&threads[i], wait_and_trace_handler, i, nullptr, 0x31, 0xfffffffe), 0);
+    svcSleepThread(1000);
+
+    TestEquals(svcSignalEvent(object), 0);
+    TestEquals(WaitForThreads(threads), 0);
+    TestEquals(trace.size(), (size_t)count);
+    for (u32 i = 0; i < count; ++i)
+        TestEquals(trace[i], i);
+
+    CloseThreads(threads);
+    svcCloseHandle(object);
+    return true;
+}
+
+static Handle arbiter;
+static s32 words[1024];
+
+// Threads wait on words[i], or all on words[0] while shared_word is set
+static bool shared_word;
+
+static void arbitrate_and_trace_handler(void* arg)
+{
+    const u32 index = (u32)(uintptr_t)arg;
+    s32* word = &words[shared_word ? 0 : index];
+    svcArbitrateAddress(arbiter, (uintptr_t)word, ARBITRATION_WAIT_IF_LESS_THAN, 0, 0);
+    trace.push_back(index);
+    svcExitThread();
+}
+
+// Arbiters wake the threads waiting on an address by priority, first come first served within one
+static bool ArbiterWakeOrder()
+{
+    static const s32 priorities[] = { 0x34, 0x32, 0x33, 0x32, 0x31, 0x34, 0x31, 0x33 };
+
+    TestEquals(svcCreateAddressArbiter(&arbiter), 0);
+    trace.clear();
+    shared_word = true;
+    words[0] = -1;
+
+    std::vector<Handle> threads(8);
+    for (u32 i = 0; i < 8; ++i)
+        TestEquals(svcCreateThread(&threads[i], arbitrate_and_trace_handler, i, nullptr, priorities[i], 0xfffffffe), 0);
+    svcSleepThread(1000);
+    TestEquals(trace.size(), (size_t)0);
+
+    TestEquals(svcArbitrateAddress(arbiter, (uintptr_t)&words[0], ARBITRATION_SIGNAL, 3, 0), 0);
+    svcSleepThread(1000);
+    TestEquals(trace.size(), (size_t)3);
+
+    TestEquals(svcArbitrateAddress(arbiter, (uintptr_t)&words[0], ARBITRATION_SIGNAL, -1, 0), 0);
+    TestEquals(WaitForThreads(threads), 0);
+
+    static const u32 expected[] = { 4, 6, 1, 3, 2, 7, 0, 5 };
+    TestEquals(trace.size(), (size_t)8);
+    for (u32 i = 0; i < 8; ++i)
+        TestEquals(trace[i], expected[i]);
+
+    CloseThreads(threads);
+    svcCloseHandle(arbiter);
+    return true;
+}
+
+// More addresses than the table has buckets, so that some share one: a signal still only wakes the
+// thread waiting on its own address
+static bool ArbiterAddresses()
+{
+    const u32 count = 1024;
+
+    TestEquals(svcCreateAddressArbiter(&arbiter), 0);
+    trace.clear();
+    shared_word = false;
+    for (u32 i = 0; i < count; ++i)
+        words[i] = -1;
+
+    std::vector<Handle> threads(count);
+    for (u32 i = 0; i < count; ++i)
+        TestEquals(svcCreateThread(&threads[i], arbitrate_and_trace_handler, i, nullptr, 0x31, 0xfffffffe), 0);
+    svcSleepThread(1000);
+
+    for (u32 i = count; i-- > 0;) {
+        TestEquals(svcArbitrateAddress(arbiter, (uintptr_t)&words[i], ARBITRATION_SIGNAL, -1, 0), 0);
+        svcSleepThread(1000);
+        TestEquals(trace.size(), (size_t)(count - i));
+        TestEquals(trace.back(), i);
+    }
+    TestEquals(WaitForThreads(threads), 0);
+
+    CloseThreads(threads);
+    svcCloseHandle(arbiter);
+    return true;
+}
+
+static bool ArbiterErrors()
+{
+    TestEquals(svcCreateAddressArbiter(&arbiter), 0);
+    words[0] = 0;
+
+    TestEquals(svcArbitrateAddress(arbiter, (uintptr_t)&words[0], (ArbitrationType)5, 0, 0), RESULT_INVALID_ENUM);
+    TestEquals(svcArbitrateAddress(0, (uintptr_t)&words[0], ARBITRATION_SIGNAL, 1, 0), RESULT_INVALID_HANDLE);
+    // Arbiters can not be waited on
+    TestEquals(svcWaitSynchronization(arbiter, 0), RESULT_INVALID_HANDLE);
+
+    svcCloseHandle(arbiter);
+    return true;
+}
+
+static LightLock light_lock;
+static u32 light_lock_count;
+
+static void light_lock_handler(void*)
+{
+    for (u32 i = 0; i < 100; ++i) {
+        LightLock_Lock(&light_lock);
+        const u32 count = light_lock_count;
+        // Lets the others find it locked
+        svcSleepThread(0);
+        light_lock_count = count + 1;
+        LightLock_Unlock(&light_lock);
+    }
+    svcExitThread();
+}
+
+// LightLock sleeps on the arbiter when contended, and hands the lock to one waiter at a time
+static bool LightLockContention()
+{
+    LightLock_Init(&light_lock);
+    light_lock_count = 0;
+
+    std::vector<Handle> threads(16);
+    for (u32 i = 0; i < 16; ++i)
+        TestEquals(svcCreateThread(&threads[i], light_lock_handler, i, nullptr, 0x31, 0xfffffffe), 0);
+    TestEquals(WaitForThreads(threads), 0);
+
+    TestEquals(light_lock_count, 1600u);
+    // Unlocked, with no waiters
+    TestEquals(light_lock, 1);
+    TestEquals(LightLock_TryLock(&light_lock), 0);
+    TestEquals(LightLock_TryLock(&light_lock), 1);
+    LightLock_Unlock(&light_lock);
+
+    CloseThreads(threads);
+    return true;
+}
+
+void TestAll()
+{
+    Test(tag, "Priority wake order", PriorityWakeOrder(), true);
+    Test(tag, "Preemption", Preemption(), true);
+    Test(tag, "Event reset types", EventResetTypes(), true);
+    Test(tag, "Round robin", RoundRobin(), true);
+    Test(tag, "Idle time skipped", IdleTimeSkipped(), true);
+    Test(tag, "Many waiters", ManyWaiters(), true);
+    Test(tag, "Arbiter wake order", ArbiterWakeOrder(), true);
+    Test(tag, "Arbiter addresses", ArbiterAddresses(), true);
+    Test(tag, "Arbiter errors", ArbiterErrors(), true);
+    Test(tag, "LightLock contention", LightLockContention(), true);
+}
+
+// A crowd of waiters of higher priority than this thread. Each one runs as soon as it is woken, and
+// waits again, so that every round ends with the crowd waiting.
+static bool crowd_quit;
+
+static void crowd_handler(void*)
+{
+    while (!crowd_quit)
+        svcWaitSynchronization(object, U64_MAX);
+    svcExitThread();
+}
+
+static void WakeCrowd(bool is_event, s32 size)
+{
+    if (is_event) {
+        svcSignalEvent(object);
+    } else {
+        s32 count;
+        svcReleaseSemaphore(&count, object, size);
+    }
+}
+
+static void BenchmarkCrowd(u32 size, bool is_event)
+{
+    // Pulse events wake the threads waiting, without staying signaled for them to wait on again
+    if (is_event)
+        svcCreateEvent(&object, RESET_PULSE);
+    else
+        svcCreateSemaphore(&object, 0, size);
+    crowd_quit = false;
+
+    std::vector<Handle> threads;
+    for (u32 i = 0; i < size; ++i) {
+        Handle thread;
+        if (svcCreateThread(&thread, crowd_handler, 0, nullptr, 0x2F, 0xfffffffe) != 0)
+            break;
+        threads.push_back(thread);
+    }
+
+    if (threads.size() == size) {
+        const std::string name = Common::FormatString("%s, %u waiters", is_event ? "Pulse event" : "Semaphore", size);
+        const BenchmarkResult result = Benchmark(tag, name, 10, [&] { WakeCrowd(is_event, size); });
+        const u64 ns = result.median * 1000000000ull / SYSCLOCK_ARM11 / size;
+        Log(Common::FormatString("    %llu ns per waiter woken\n", ns));
+    } else {
+        Log(Common::FormatString("%s: could only create %u of %u threads, skipped\n", tag.c_str(),
+                                 (u32)threads.size(), size));
+    }
+
+    crowd_quit = true;
+    WakeCrowd(is_event, threads.size());
+    WaitForThreads(threads);
+    CloseThreads(threads);
+    svcCloseHandle(object);
+}
+
+
+// Threads hammering LightLocks: each takes the locks in turn, yielding while it holds one, so that
+// the threads sharing a lock find it taken. Few locks queue every thread on a few addresses, many
+// spread them over the arbiter's whole table.
+static const u32 LOCKS_PER_RUN = 16;
+
+static std::vector<LightLock> hammer_locks;
+static s32 hammer_run;
+static s32 hammer_done;
+static s32 hammer_threads;
+static bool hammer_quit;
+
+static void hammer_handler(void* arg)
+{
+    const u32 index = (u32)(uintptr_t)arg;
+    for (s32 run = 1;; ++run) {
+        while (hammer_run < run)
+            svcArbitrateAddress(arbiter, (uintptr_t)&hammer_run, ARBITRATION_WAIT_IF_LESS_THAN, run, 0);
+        if (hammer_quit)
+            break;
+
+        for (u32 i = 0; i < LOCKS_PER_RUN; ++i) {
+            LightLock* lock = &hammer_locks[(index + i) % hammer_locks.size()];
+            LightLock_Lock(lock);
+            svcSleepThread(0);
+            LightLock_Unlock(lock);
+        }
+        if (++hammer_done == hammer_threads)
+            svcArbitrateAddress(arbiter, (uintptr_t)&hammer_done, ARBITRATION_SIGNAL, 1, 0);
+    }
+    svcExitThread();
+}
+
+// Starts every thread on a run, and waits until all have finished it
+static void StartRun()
+{
+    hammer_done = 0;
+    hammer_run++;
+    svcArbitrateAddress(arbiter, (uintptr_t)&hammer_run, ARBITRATION_SIGNAL, -1, 0);
+    while (hammer_done < hammer_threads)
+        svcArbitrateAddress(arbiter, (uintptr_t)&hammer_done, ARBITRATION_WAIT_IF_LESS_THAN, hammer_threads, 0);
+}
+
+static void BenchmarkHammer(u32 thread_count, u32 lock_count)
+{
+    svcCreateAddressArbiter(&arbiter);
+    hammer_locks.assign(lock_count, 0);
+    for (LightLock& lock : hammer_locks)
+        LightLock_Init(&lock);
+    hammer_run = 0;
+    hammer_quit = false;
+
+    // Below this thread, so that none runs before it waits for them
+    std::vector<Handle> threads;
+    for (u32 i = 0; i < thread_count; ++i) {
+        Handle thread;
+        if (svcCreateThread(&thread, hammer_handler, i, nullptr, 0x31, 0xfffffffe) != 0)
+            break;
+        threads.push_back(thread);
+    }
+    hammer_threads = threads.size();
+
+    if (threads.size() == thread_count) {
+        const std::string name = Common::FormatString("LightLock, %u threads on %u address%s", thread_count, lock_count,
+                                                    lock_count == 1 ? "" : "es");
+        const BenchmarkResult result = Benchmark(tag, name, 5, StartRun);
+        const u64 ns = result.median * 1000000000ull / SYSCLOCK_ARM11 / (thread_count * LOCKS_PER_RUN);
+        Log(Common::FormatString("    %llu ns per lock taken\n", ns));
+    } else {
+        Log(Common::FormatString("%s: could only create %u of %u threads, skipped\n", tag.c_str(),
+                                 (u32)threads.size(), thread_count));
+    }
+
+    hammer_quit = true;
+    hammer_run++;
+    svcArbitrateAddress(arbiter, (uintptr_t)&hammer_run, ARBITRATION_SIGNAL, -1, 0);
+    WaitForThreads(threads);
+    CloseThreads(threads);
+    svcCloseHandle(arbiter);
+}
+
+void BenchmarkAll()
+{
+    static const u32 sizes[] = { 16, 256, 4096 };
+
+    for (u32 size : sizes) {
+        BenchmarkCrowd(size, true);
+        BenchmarkCrowd(size, false);
+    }
+
+    static const u32 thread_counts[] = { 64, 1024 };
+    static const u32 lock_counts[] = { 1, 16, 4096 };
+
+    for (u32 thread_count : thread_counts) {
+        for (u32 lock_count : lock_counts)
+            BenchmarkHammer(thread_count, lock_count);
+    }
+}
+
+} // namespace
+} // namespace
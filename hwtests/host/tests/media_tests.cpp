@@ -0,0 +1,189 @@
+#include <string>
+#include <vector>
+
+#include "output.h"
+#include "common/string_funcs.h"
+#include "arm/media.h"
+#include "arm/media_fuzz.h"
+#include "tests/benchmark.h"
+#include "tests/test.h"
+#include "model.h"
+
+namespace Model {
+namespace Media {
+
+using Pica::Kernel;
+using ARM::Media::Op;
+
+static const std::string tag = "Model::Media";
+
+static const Kernel kernels[] = { Kernel::Scalar, Kernel::Vector, Kernel::SSE41, Kernel::AVX2 };
+
+struct HardwareResult {
+    Op op;
+    u32 imm;
+    u32 rn, rm, ra;
+    u32 expected;
+};
+
+// Results measured on hardware, from source/tests/cpu/integer.cpp. Its "Rm" operand is the
+// first source register, which the ARM ARM calls Rn.
+static const HardwareResult hardware_results[] = {
+    { Op::QADD16, 0, 0xFFFF8000, 0xFFFF8000, 0, 0xFFFE8000 },
+    { Op::QADD16, 0, 0x00007FFF, 0x00007FFF, 0, 0x00007FFF },
+    { Op::QADD16, 0, 0x00007FFF, 0xFFFF8000, 0, 0xFFFFFFFF },
+    { Op::QSUB16, 0, 0xFFFF8000, 0xFFFF8000, 0, 0x00000000 },
+    { Op::QSUB16, 0, 0x00007FFF, 0x00007FFF, 0, 0x00000000 },
+    { Op::QSUB16, 0, 0x00007FFF, 0xFFFF8000, 0, 98303 },
+    { Op::SASX, 0, 0xFFFFFFFF, 0xFFFFF05F, 0, 4032692224 },
+    { Op::SSAX, 0, 0xFFFFFFFF, 0xFFFFF05F, 0, 262209534 },
+    { Op::UQSUB8, 0, 70, 50, 0, 20 },
+    { Op::UQSUB8, 0, 50, 70, 0, 0 },
+    { Op::USAD8, 0, 50, 10, 0, 40 },
+    { Op::USAD8, 0, 0, 1, 0, 1 },
+    { Op::USADA8, 0, 50, 10, 1, 41 },
+    { Op::USADA8, 0, 0, 1, 9, 10 },
+    { Op::SXTH, 0, 0, 0x0000FFCE, 0, (u32)-50 },
+    { Op::SXTH, 8, 0, 0x00FCE000, 0, (u32)-800 },
+    { Op::SXTH, 16, 0, 0x01410000, 0, 321 },
+    { Op::SXTH, 24, 0, 0xCE0000FF, 0, (u32)-50 },
+    { Op::UXTAB16, 0, 0xFFFFFFFF, 0x7FFFFFFF, 0, 16646398 },
+    { Op::UXTAB16, 8, 0xFFFFFFFF, 0x7FFFFFFF, 0, 8257790 },
+    { Op::UXTAB16, 16, 0xFFFFFFFF, 0x7FFFFFFF, 0, 16646398 },
+    { Op::UXTAB16, 24, 0xFFFFFFFF, 0x7FFFFFFF, 0, 16646270 },
+    { Op::UXTB16, 0, 0, 50, 0, 50 },
+    { Op::UXTB16, 8, 0, 0x0000FFFF, 0, 0x000000FF },
+    { Op::UXTB16, 16, 0, 0x00FFFFFF, 0, 0x00FF00FF },
+    { Op::UXTB16, 24, 0, 0x007FFFFF, 0, 0x00FF0000 },
+};
+
+struct FlagsResult {
+    Op op;
+    u32 rn, rm;
+    u32 expected;
+    u32 expected_ge;
+};
+
+// GE flags, as the ARM ARM defines them: signed results that are not negative, unsigned additions
+// that carry, and unsigned subtractions that do not borrow
+static const FlagsResult flags_results[] = {
+    { Op::SADD16, 0x7FFF0001, 0x0001FFFE, 0x8000FFFF, 0xC },
+    { Op::SADD16, 0x80000001, 0xFFFF0001, 0x7FFF0002, 0x3 },
+    { Op::SSUB8, 0x80017F00, 0x01017F01, 0x7F0000FF, 0x6 },
+    { Op::UADD16, 0xFFFF0001, 0x00010001, 0x00000002, 0xC },
+    { Op::UADD8, 0xFF80017F, 0x01800080, 0x000001FF, 0xC },
+    { Op::USUB16, 0x00010002, 0x00020002, 0xFFFF0000, 0x3 },
+    { Op::UASX, 0xFFFF0000, 0x00010001, 0x0000FFFF, 0xC },
+    { Op::SSAX, 0x00000000, 0x00000001, 0xFFFF0000, 0x3 },
+};
+
+static bool ReferenceFlags()
+{
+    for (const FlagsResult& result : flags_results) {
+        u32 ge = 0xFF;
+        TestEquals(ARM::Media::Execute(result.op, result.rn, result.rm, 0, 0, &ge), result.expected);
+        TestEquals(ge, result.expected_ge);
+    }
+
+    // SEL takes each byte from rn where its GE flag is set, and from rm where it is not
+    TestEquals(ARM::Media::Execute(Op::SEL, 0x44332211, 0xDDCCBBAA, 0x5, 0), 0xDD33BB11);
+    // Instructions that do not set the flags leave them alone
+    u32 ge = 0xFF;
+    ARM::Media::Execute(Op::QADD16, 1, 1, 0, 0, &ge);
+    TestEquals(ge, 0xFFu);
+    return true;
+}
+
+// Every hardware result, repeated across a batch long enough for the vector loops
+static bool HardwareResults(Kernel kernel)
+{
+    const u32 count = 37;
+
+    for (const HardwareResult& result : hardware_results) {
+        const std::vector<u32> rn(count, result.rn), rm(count, result.rm), ra(count, result.ra);
+        std::vector<u32> rd(count);
+        ARM::Media::ExecuteBatch(kernel, result.op, result.imm, rn.data(), rm.data(), ra.data(), rd.data(), nullptr,
+                                 count);
+        for (u32 i = 0; i < count; ++i)
+            TestEquals(rd[i], result.expected);
+    }
+    return true;
+}
+
+// Every instruction on random operand sets, against the reference
+static bool MatchesReference(Kernel kernel)
+{
+    const u64 count = 1 << 16;
+
+    bool passed = true;
+    for (u32 i = 0; i < ARM::Media::NUM_OPS; ++i) {
+        ARM::Media::Mismatch first;
+        const u64 mismatches = ARM::Media::Fuzz(kernel, (Op)i, 0x12345678, count, &first);
+        if (mismatches == 0)
+            continue;
+
+        Log(Common::FormatString("    %s: %llu of %llu differ, first: imm=%u rn=0x%08X rm=0x%08X ra=0x%08X: "
+                                 "0x%08X ge=0x%X, expected 0x%08X ge=0x%X\n",
+                                 ARM::Media::OpName((Op)i), mismatches, count, first.imm, first.rn, first.rm,
+                                 first.ra, first.actual, first.actual_ge, first.expected, first.expected_ge));
+        passed = false;
+    }
+    return passed;
+}
+
+void TestAll()
+{
+    Test(tag, "Reference, GE flags", ReferenceFlags(), true);
+
+    for (Kernel kernel : kernels) {
+        if (!Pica::IsSupported(kernel)) {
+            Log(Common::FormatString("%s: %s kernel not supported, skipped\n", tag.c_str(), Pica::KernelName(kernel)));
+            continue;
+        }
+
+        const std::string name = Pica::KernelName(kernel);
+        Test(tag, name + ", hardware results", HardwareResults(kernel), true);
+        Test(tag, name + ", matches reference", MatchesReference(kernel), true);
+    }
+}
+
+void BenchmarkAll()
+{
+    // A few instructions from each family, on a batch that fits in the L2 cache
+    static const Op ops[] = { Op::QADD16, Op::SADD8, Op::SHASX, Op::UQSUB8, Op::USADA8, Op::UXTAB16, Op::SEL,
+                              Op::SSAT16 };
+    const u32 count = 16384;
+
+    std::vector<u32> rn(count), rm(count), ra(count), rd(count);
+    std::vector<u8> ge(count);
+    u32 seed = 0x12345678;
+    for (u32 i = 0; i < count; ++i) {
+        seed = seed * 1103515245 + 12345;
+        rn[i] = (seed >> 16) | (seed << 16);
+        seed = seed * 1103515245 + 12345;
+        rm[i] = (seed >> 16) | (seed << 16);
+        ra[i] = rn[i] ^ rm[i];
+    }
+
+    for (Op op : ops) {
+        for (Kernel kernel : kernels) {
+            if (!Pica::IsSupported(kernel))
+                continue;
+
+            const std::string name = Common::FormatString("%s, %u operand sets, %s", ARM::Media::OpName(op), count,
+                                                          Pica::KernelName(kernel));
+            const BenchmarkResult result = Benchmark(tag, name, 20, [&] {
+                ARM::Media::ExecuteBatch(kernel, op, 8, rn.data(), rm.data(), ra.data(), rd.data(), ge.data(), count);
+            });
+
+            if (result.median) {
+                const u64 hundredths = (u64)count * SYSCLOCK_ARM11 / result.median / 10000;
+                Log(Common::FormatString("    %llu.%02llu million instructions/s\n", hundredths / 100,
+                                         hundredths % 100));
+            }
+        }
+    }
+}
+
+} // namespace
+} // namespace
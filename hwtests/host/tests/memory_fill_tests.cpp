@@ -0,0 +1,151 @@
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "output.h"
+#include "common/string_funcs.h"
+#include "pica/memory_fill.h"
+#include "tests/benchmark.h"
+#include "tests/test.h"
+#include "model.h"
+
+namespace Model {
+namespace MemoryFill {
+
+using Pica::Kernel;
+using Pica::MemoryFill::Width;
+
+static const std::string tag = "Model::MemoryFill";
+
+static const Kernel kernels[] = { Kernel::Scalar, Kernel::Vector, Kernel::SSE41, Kernel::AVX2 };
+
+static const Width widths[] = { Width::Bits16, Width::Bits24, Width::Bits32 };
+
+static const char* width_names[] = { "16 bit", "24 bit", "32 bit" };
+
+struct HardwareResult {
+    u32 control;
+    u32 value;
+    u8 expected[8]; // First bytes of a 48 byte fill
+};
+
+// Results measured on hardware, from Fill24Bits and Fill32Bits in source/tests/gpu/memoryfills.cpp
+static const HardwareResult hardware_results[] = {
+    { 0x101, 0x00FFFFFF, { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF } },
+    { 0x101, 0xFFFFFFFF, { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF } },
+    { 0x101, 0x00FFFF00, { 0x00, 0xFF, 0xFF, 0x00, 0xFF, 0xFF, 0x00, 0xFF } },
+    { 0x201, 0x00FFFFFF, { 0xFF, 0xFF, 0xFF, 0x00, 0xFF, 0xFF, 0xFF, 0x00 } },
+    { 0x201, 0x0000FFFF, { 0xFF, 0xFF, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00 } },
+};
+
+// The fill written one byte at a time
+static std::vector<u8> Reference(size_t size, u32 value, Width width)
+{
+    const u32 bytes = (u32)width + 2;
+    std::vector<u8> expected(size);
+    for (size_t i = 0; i < size; ++i)
+        expected[i] = value >> (i % bytes * 8);
+    return expected;
+}
+
+static bool HardwareResults(Kernel kernel)
+{
+    for (const HardwareResult& result : hardware_results) {
+        u8 buffer[48];
+        memset(buffer, 0xCD, sizeof(buffer));
+        Pica::MemoryFill::Fill(kernel, buffer, sizeof(buffer), result.value,
+                               Pica::MemoryFill::WidthFromControl(result.control));
+        for (u32 i = 0; i < 8; ++i)
+            TestEquals((u32)buffer[i], (u32)result.expected[i]);
+    }
+    return true;
+}
+
+// Every width gives the reference bytes at every alignment and every size up to a few pattern
+// periods, and for fills large enough to bypass the caches, without writing outside the range
+static bool MatchesReference(Kernel kernel)
+{
+    const u32 value = 0x12345678;
+    const size_t guard = 64;
+
+    std::vector<size_t> sizes;
+    for (size_t size = 0; size < 300; ++size)
+        sizes.push_back(size);
+    sizes.push_back(0x60000);
+    sizes.push_back(4 * 1024 * 1024 + 7);
+
+    for (Width width : widths) {
+        for (size_t size : sizes) {
+            const std::vector<u8> expected = Reference(size, value, width);
+            // Large fills only at a few alignments, to keep the test fast
+            const u32 alignments = size < 300 ? 32 : 3;
+
+            std::vector<u8> buffer(size + 32 + guard * 2);
+            for (u32 alignment = 0; alignment < alignments; ++alignment) {
+                memset(buffer.data(), 0xCD, buffer.size());
+                u8* dst = buffer.data() + guard + alignment;
+                Pica::MemoryFill::Fill(kernel, dst, size, value, width);
+
+                SoftAssert(size == 0 || memcmp(dst, expected.data(), size) == 0);
+                SoftAssert(dst[-1] == 0xCD && dst[size] == 0xCD);
+            }
+        }
+    }
+    return true;
+}
+
+static bool Control()
+{
+    TestEquals((u32)Pica::MemoryFill::WidthFromControl(0x001), (u32)Width::Bits16);
+    TestEquals((u32)Pica::MemoryFill::WidthFromControl(0x101), (u32)Width::Bits24);
+    TestEquals((u32)Pica::MemoryFill::WidthFromControl(0x201), (u32)Width::Bits32);
+    TestEquals((u32)Pica::MemoryFill::WidthFromControl(0x301), (u32)Width::Bits32);
+    return true;
+}
+
+void TestAll()
+{
+    Test(tag, "Control", Control(), true);
+
+    for (Kernel kernel : kernels) {
+        if (!Pica::IsSupported(kernel)) {
+            Log(Common::FormatString("%s: %s kernel not supported, skipped\n", tag.c_str(), Pica::KernelName(kernel)));
+            continue;
+        }
+
+        const std::string name = Pica::KernelName(kernel);
+        Test(tag, name + ", hardware results", HardwareResults(kernel), true);
+        Test(tag, name + ", matches reference", MatchesReference(kernel), true);
+    }
+}
+
+void BenchmarkAll()
+{
+    // One and two 400x240 RGBA8 framebuffers, as in the MemoryFills benchmark, and a fill too large for the caches
+    static const u32 sizes[] = { 0x60000, 0xC0000, 0x800000 };
+
+    std::vector<u8> buffer(sizes[2]);
+
+    for (u32 size : sizes) {
+        // The baseline: a byte fill, which every width equals when all bytes of the value are the same
+        LogBandwidth(size, Benchmark(tag, Common::FormatString("memset, 0x%X bytes", size), 20, [&] {
+            memset(buffer.data(), 0x5A, size);
+        }));
+
+        for (Width width : widths) {
+            for (Kernel kernel : kernels) {
+                if (!Pica::IsSupported(kernel))
+                    continue;
+
+                const std::string name = Common::FormatString("%s, %s, 0x%X bytes", width_names[(u32)width],
+                                                              Pica::KernelName(kernel), size);
+                LogBandwidth(size, Benchmark(tag, name, 20, [&] {
+                    Pica::MemoryFill::Fill(kernel, buffer.data(), size, 0x12345678, width);
+                }));
+            }
+        }
+    }
+}
+
+} // namespace
+} // namespace
@@ -0,0 +1,38 @@
+#pragma once
+
+// Tests and benchmarks of the host models in host/pica and host/arm, and of the shim's kernel, run
+// by the host build only.
+
+namespace Model {
+
+namespace Color {
+void TestAll();
+void BenchmarkAll();
+}
+
+namespace Tiling {
+void TestAll();
+void BenchmarkAll();
+}
+
+namespace Scale {
+void TestAll();
+void BenchmarkAll();
+}
+
+namespace MemoryFill {
+void TestAll();
+void BenchmarkAll();
+}
+
+namespace Media {
+void TestAll();
+void BenchmarkAll();
+}
+
+namespace Kernel {
+void TestAll();
+void BenchmarkAll();
+}
+
+} // namespace
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "output.h"
+#include "common/string_funcs.h"
+#include "pica/scale.h"
+#include "tests/benchmark.h"
+#include "tests/test.h"
+#include "model.h"
+
+namespace Model {
+namespace Scale {
+
+using Pica::Kernel;
+using Pica::Scale::Scaling;
+
+static const std::string tag = "Model::Scale";
+
+static const Kernel kernels[] = { Kernel::Scalar, Kernel::Vector, Kernel::SSE41, Kernel::AVX2 };
+
+struct HardwareResult {
+    Scaling scaling;
+    u32 input[4]; // Top left, top right, bottom left, bottom right
+    u32 expected;
+};
+
+// Results measured on hardware, from RGBA8_To_RGBA8_Scaled_Blending in source/tests/gpu/displaytransfer.cpp
+static const HardwareResult hardware_results[] = {
+    { Scaling::Horizontal, { 0xFF000000, 0x00000000 }, 0x7F000000 },
+    { Scaling::Horizontal, { 0xFFFF0000, 0x00000000 }, 0x7F7F0000 },
+    { Scaling::Horizontal, { 0xFFFF0000, 0xFF000000 }, 0xFF7F0000 },
+    { Scaling::Horizontal, { 0xFFFF0000, 0xFF0000FF }, 0xFF7F007F },
+    { Scaling::Horizontal, { 0xFFFF0000, 0x00FF0000 }, 0x7FFF0000 },
+    { Scaling::Both, { 0xFFFF0000, 0xFF0000FF, 0x00000000, 0x00000000 }, 0x7F3F003F },
+};
+
+// Fills `count` pixels with a repeatable pseudo random pattern
+static std::vector<u32> RandomPixels(size_t count)
+{
+    std::vector<u32> pixels(count);
+    u32 seed = 0x12345678;
+    for (u32& pixel : pixels) {
+        seed = seed * 1103515245 + 12345;
+        pixel = (seed >> 16) | (seed << 16);
+    }
+    return pixels;
+}
+
+// Every hardware result, repeated across rows long enough for the vector loops
+static bool HardwareResults(Kernel kernel)
+{
+    const u32 width = 37;
+
+    for (const HardwareResult& result : hardware_results) {
+        std::vector<u32> input(width * 2 * 2);
+        std::vector<u32> output(width);
+        for (u32 x = 0; x < width; ++x) {
+            input[x * 2] = result.input[0];
+            input[x * 2 + 1] = result.input[1];
+            input[width * 2 + x * 2] = result.input[2];
+            input[width * 2 + x * 2 + 1] = result.input[3];
+        }
+
+        Pica::Scale::Downscale(kernel, result.scaling, input.data(), width * 2, output.data(), width, width, 1);
+        for (u32 x = 0; x < width; ++x)
+            TestEquals(output[x], result.expected);
+    }
+    return true;
+}
+
+// Gives the same pixels as the scalar kernel, at every width up to a few vectors and at the frame
+// widths of the two screens, and writes nothing past the end of output rows
+static bool MatchesScalar(Kernel kernel)
+{
+    const u32 height = 4;
+
+    for (Scaling scaling : { Scaling::Horizontal, Scaling::Both }) {
+        std::vector<u32> widths;
+        for (u32 width = 0; width < 40; ++width)
+            widths.push_back(width);
+        widths.push_back(200);
+        widths.push_back(400);
+
+        for (u32 width : widths) {
+            const size_t src_stride = width * 2 + 3;
+            const size_t dst_stride = width + 1;
+            const std::vector<u32> input = RandomPixels(src_stride * height * 2);
+            std::vector<u32> expected(dst_stride * height, 0xCDCDCDCD);
+            std::vector<u32> actual(dst_stride * height, 0xCDCDCDCD);
+
+            Pica::Scale::Downscale(Kernel::Scalar, scaling, input.data(), src_stride, expected.data(), dst_stride, width, height);
+            Pica::Scale::Downscale(kernel, scaling, input.data(), src_stride, actual.data(), dst_stride, width, height);
+            SoftAssert(expected == actual);
+        }
+    }
+    return true;
+}
+
+// The scalar kernel against a direct per channel computation, over every pair of channel values
+static bool ScalarArithmetic()
+{
+    std::vector<u32> input(256 * 2 * 2);
+    std::vector<u32> output(256);
+
+    for (u32 a = 0; a < 256; ++a) {
+        for (u32 b = 0; b < 256; ++b) {
+            // Each channel of the top pixels gets different values, and the bottom row their complements
+            input[b * 2] = a << 24 | b << 16 | (255 - a) << 8 | (a ^ b);
+            input[b * 2 + 1] = b << 24 | a << 16 | (255 - b) << 8 | (a & b);
+            input[512 + b * 2] = ~input[b * 2] & 0xFFFF00FF;
+            input[512 + b * 2 + 1] = ~input[b * 2 + 1];
+        }
+
+        Pica::Scale::Downscale(Kernel::Scalar, Scaling::Horizontal, input.data(), 512, output.data(), 256, 256, 1);
+        for (u32 i = 0; i < 256; ++i) {
+            for (u32 shift = 0; shift < 32; shift += 8) {
+                const u32 sum = ((input[i * 2] >> shift) & 0xFF) + ((input[i * 2 + 1] >> shift) & 0xFF);
+                SoftAssert(((output[i] >> shift) & 0xFF) == sum / 2);
+            }
+        }
+
+        Pica::Scale::Downscale(Kernel::Scalar, Scaling::Both, input.data(), 512, output.data(), 256, 256, 1);
+        for (u32 i = 0; i < 256; ++i) {
+            for (u32 shift = 0; shift < 32; shift += 8) {
+                u32 sum = 0;
+                for (u32 index : { i * 2, i * 2 + 1, 512 + i * 2, 512 + i * 2 + 1 })
+                    sum += (input[index] >> shift) & 0xFF;
+                SoftAssert(((output[i] >> shift) & 0xFF) == sum / 4);
+            }
+        }
+    }
+    return true;
+}
+
+void TestAll()
+{
+    Test(tag, "Scalar arithmetic", ScalarArithmetic(), true);
+
+    for (Kernel kernel : kernels) {
+        if (!Pica::IsSupported(kernel)) {
+            Log(Common::FormatString("%s: %s kernel not supported, skipped\n", tag.c_str(), Pica::KernelName(kernel)));
+            continue;
+        }
+
+        const std::string name = Pica::KernelName(kernel);
+        Test(tag, name + ", hardware results", HardwareResults(kernel), true);
+        if (kernel != Kernel::Scalar)
+            Test(tag, name + ", matches scalar", MatchesScalar(kernel), true);
+    }
+}
+
+void BenchmarkAll()
+{
+    struct Frame {
+        u32 width;
+        u32 height;
+    };
+
+    // Input frames: one 400x240 screen, and the 800x480 buffer that is rendered at twice its size
+    static const Frame frames[] = { { 400, 240 }, { 800, 480 } };
+
+    for (const Frame& frame : frames) {
+        const std::vector<u32> input = RandomPixels((size_t)frame.width * frame.height);
+        std::vector<u32> output((size_t)frame.width * frame.height);
+
+        for (Scaling scaling : { Scaling::Horizontal, Scaling::Both }) {
+            const u32 width = frame.width / Pica::Scale::ScaleX(scaling);
+            const u32 height = frame.height / Pica::Scale::ScaleY(scaling);
+
+            for (Kernel kernel : kernels) {
+                if (!Pica::IsSupported(kernel))
+                    continue;
+
+                const std::string name = Common::FormatString("%ux%u, %s, %s", frame.width, frame.height,
+                                                              scaling == Scaling::Both ? "2x2" : "2x1",
+                                                              Pica::KernelName(kernel));
+                const BenchmarkResult result = Benchmark(tag, name, 20, [&] {
+                    Pica::Scale::Downscale(kernel, scaling, input.data(), frame.width, output.data(), width, width, height);
+                });
+
+                if (result.median) {
+                    const u64 pixels = (u64)frame.width * frame.height;
+                    const u64 hundredths = pixels * SYSCLOCK_ARM11 / result.median / 10000;
+                    const u64 microseconds = result.median * 1000000 / SYSCLOCK_ARM11;
+                    Log(Common::FormatString("    %llu.%02llu input megapixels/s, %llu us per frame\n", hundredths / 100,
+                                             hundredths % 100, microseconds));
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+} // namespace
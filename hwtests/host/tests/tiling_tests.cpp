@@ -0,0 +1,169 @@
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "output.h"
+#include "common/string_funcs.h"
+#include "pica/tiling.h"
+#include "tests/benchmark.h"
+#include "tests/test.h"
+#include "model.h"
+
+namespace Model {
+namespace Tiling {
+
+using Pica::Kernel;
+
+static const std::string tag = "Model::Tiling";
+
+static const Kernel kernels[] = { Kernel::Scalar, Kernel::Vector, Kernel::SSE41, Kernel::AVX2 };
+
+struct Size {
+    u32 width;
+    u32 height;
+};
+
+static const Size sizes[] = { { 8, 8 }, { 16, 24 }, { 56, 8 }, { 240, 400 }, { 400, 240 } };
+
+// Fills `size` bytes with a repeatable pseudo random pattern
+static std::vector<u8> RandomBytes(size_t size)
+{
+    std::vector<u8> bytes(size);
+    u32 seed = 0x12345678;
+    for (u8& byte : bytes) {
+        seed = seed * 1103515245 + 12345;
+        byte = seed >> 16;
+    }
+    return bytes;
+}
+
+// The pixel order seen on hardware by Test_ZCurve in source/tests/gpu/displaytransfer.cpp: the
+// second pixel of a tiled surface is (1, 0), the third (0, 1), and the fourteenth (3, 2).
+static bool HardwareOrder(Kernel kernel)
+{
+    const u32 width = 128, height = 128;
+    std::vector<u32> linear(width * height);
+    std::vector<u32> tiled(width * height);
+    for (u32 i = 0; i < linear.size(); ++i)
+        linear[i] = i;
+
+    Pica::Tiling::LinearToTiled(kernel, (const u8*)linear.data(), width * 4, (u8*)tiled.data(), width, height, 4, 1);
+    TestEquals(tiled[1], 1u);
+    TestEquals(tiled[2], width);
+    TestEquals(tiled[13], 2 * width + 3);
+
+    for (u32 y = 0; y < height; ++y) {
+        for (u32 x = 0; x < width; ++x)
+            TestEquals(tiled[Pica::Tiling::TiledIndex(x, y, width)], y * width + x);
+    }
+    return true;
+}
+
+// Gives the same bytes as the scalar kernel both ways, for every pixel size, and leaves the
+// padding at the end of linear rows alone
+static bool MatchesScalar(Kernel kernel)
+{
+    for (const Size& size : sizes) {
+        for (u32 bpp = 1; bpp <= 4; ++bpp) {
+            const size_t stride = size.width * bpp + 12;
+            const size_t tiled_size = (size_t)size.width * size.height * bpp;
+            const std::vector<u8> linear = RandomBytes(stride * size.height);
+
+            std::vector<u8> expected(tiled_size);
+            std::vector<u8> tiled(tiled_size);
+            Pica::Tiling::LinearToTiled(Kernel::Scalar, linear.data(), stride, expected.data(), size.width, size.height, bpp, 1);
+            Pica::Tiling::LinearToTiled(kernel, linear.data(), stride, tiled.data(), size.width, size.height, bpp, 1);
+            SoftAssert(expected == tiled);
+
+            std::vector<u8> detiled(linear.size(), 0xCD);
+            Pica::Tiling::TiledToLinear(kernel, tiled.data(), detiled.data(), stride, size.width, size.height, bpp, 1);
+            for (u32 y = 0; y < size.height; ++y) {
+                const u8* row = &detiled[y * stride];
+                SoftAssert(memcmp(row, &linear[y * stride], size.width * bpp) == 0);
+                SoftAssert(row[size.width * bpp] == 0xCD && row[stride - 1] == 0xCD);
+            }
+        }
+    }
+    return true;
+}
+
+// Splitting a surface across threads changes nothing
+static bool Threaded()
+{
+    const u32 width = 1024, height = 1024, bpp = 4;
+    const std::vector<u8> linear = RandomBytes((size_t)width * height * bpp);
+    std::vector<u8> expected(linear.size());
+    std::vector<u8> tiled(linear.size());
+    std::vector<u8> detiled(linear.size());
+
+    Pica::Tiling::LinearToTiled(Kernel::Scalar, linear.data(), width * bpp, expected.data(), width, height, bpp, 1);
+    for (unsigned threads : { 0u, 2u, 3u, 7u }) {
+        Pica::Tiling::LinearToTiled(linear.data(), width * bpp, tiled.data(), width, height, bpp, threads);
+        SoftAssert(tiled == expected);
+        Pica::Tiling::TiledToLinear(tiled.data(), detiled.data(), width * bpp, width, height, bpp, threads);
+        SoftAssert(detiled == linear);
+    }
+    return true;
+}
+
+void TestAll()
+{
+    for (Kernel kernel : kernels) {
+        if (!Pica::IsSupported(kernel)) {
+            Log(Common::FormatString("%s: %s kernel not supported, skipped\n", tag.c_str(), Pica::KernelName(kernel)));
+            continue;
+        }
+
+        const std::string name = Pica::KernelName(kernel);
+        Test(tag, name + ", hardware order", HardwareOrder(kernel), true);
+        if (kernel != Kernel::Scalar)
+            Test(tag, name + ", matches scalar", MatchesScalar(kernel), true);
+    }
+    Test(tag, "Threaded", Threaded(), true);
+}
+
+static void LogRate(size_t pixels, const BenchmarkResult& result)
+{
+    if (result.median) {
+        const u64 hundredths = (u64)pixels * SYSCLOCK_ARM11 / result.median / 10000;
+        Log(Common::FormatString("    %llu.%02llu megapixels/s\n", hundredths / 100, hundredths % 100));
+    }
+}
+
+void BenchmarkAll()
+{
+    // A 400x240 screen, a framebuffer twice that size, and a large texture to show threading
+    static const Size bench_sizes[] = { { 400, 240 }, { 800, 480 }, { 2048, 2048 } };
+
+    for (const Size& size : bench_sizes) {
+        const size_t pixels = (size_t)size.width * size.height;
+        for (u32 bpp : { 2u, 3u, 4u }) {
+            const size_t stride = size.width * bpp;
+            const std::vector<u8> linear = RandomBytes(pixels * bpp);
+            std::vector<u8> tiled(pixels * bpp);
+
+            for (Kernel kernel : kernels) {
+                if (!Pica::IsSupported(kernel))
+                    continue;
+
+                const std::string name = Common::FormatString("%ux%u, %u bytes per pixel, %s", size.width, size.height,
+                                                              bpp, Pica::KernelName(kernel));
+                LogRate(pixels, Benchmark(tag, "LinearToTiled " + name, 20, [&] {
+                    Pica::Tiling::LinearToTiled(kernel, linear.data(), stride, tiled.data(), size.width, size.height, bpp, 1);
+                }));
+                LogRate(pixels, Benchmark(tag, "TiledToLinear " + name, 20, [&] {
+                    Pica::Tiling::TiledToLinear(kernel, linear.data(), tiled.data(), stride, size.width, size.height, bpp, 1);
+                }));
+            }
+
+            const std::string name = Common::FormatString("%ux%u, %u bytes per pixel, %s, threaded", size.width,
+                                                          size.height, bpp, Pica::KernelName(Pica::BestKernel()));
+            LogRate(pixels, Benchmark(tag, "LinearToTiled " + name, 20, [&] {
+                Pica::Tiling::LinearToTiled(linear.data(), stride, tiled.data(), size.width, size.height, bpp);
+            }));
+        }
+    }
+}
+
+} // namespace
+} // namespace
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Wire format of the result stream, shared by hwtests (source/stream.cpp) and the collector
+// (host/collector). A run is a sequence of records, each a type byte, the length of its payload as
+// a varint, and the payload. Integers in payloads are unsigned LEB128 varints, and strings a
+// varint length followed by the bytes. Readers skip records of types they do not know, so that
+// new ones can be added without breaking old collectors.
+
+namespace StreamFormat {
+
+/// First field of the hello record, "HWTS" read as a little endian word.
+const uint32_t MAGIC = 0x53545748;
+const uint32_t VERSION = 1;
+
+enum RecordType : uint8_t {
+    // Magic, version, platform name, system ticks per second. Always the first record.
+    RECORD_HELLO = 1,
+    // Group name. Starts a group of main()'s, which the records up to the next one belong to.
+    RECORD_GROUP = 2,
+    // Group, name, passed, ticks since the previous result
+    RECORD_TEST = 3,
+    // Group, name, iterations, overhead in ticks, samples in ticks
+    RECORD_BENCHMARK = 4,
+    // Groups run, tests failed. Always the last record of a run that was not cut short.
+    RECORD_END = 5,
+};
+
+/// Strings are cut to this many bytes.
+const size_t MAX_STRING = 255;
+
+/// Benchmarks with more samples send this many of them, evenly spaced through the sorted samples,
+/// which keeps the shape of the distribution and every record under 4 KiB.
+const size_t MAX_SAMPLES = 256;
+
+inline void PutVarint(std::string& out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out += (char)((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += (char)value;
+}
+
+inline void PutString(std::string& out, const std::string& text)
+{
+    const size_t length = text.length() < MAX_STRING ? text.length() : MAX_STRING;
+    PutVarint(out, length);
+    out.append(text, 0, length);
+}
+
+/// Sorted samples, each as its difference from the one before, so that most take one or two bytes.
+template <typename T>
+void PutSamples(std::string& out, const std::vector<T>& sorted)
+{
+    const size_t count = sorted.size() < MAX_SAMPLES ? sorted.size() : MAX_SAMPLES;
+    PutVarint(out, count);
+
+    uint64_t previous = 0;
+    for (size_t i = 0; i < count; ++i) {
+        // The smallest and the largest are always kept
+        const size_t index = count < 2 ? 0 : i * (sorted.size() - 1) / (count - 1);
+        PutVarint(out, sorted[index] - previous);
+        previous = sorted[index];
+    }
+}
+
+inline std::string MakeRecord(RecordType type, const std::string& payload)
+{
+    std::string record(1, (char)type);
+    PutVarint(record, payload.length());
+    return record + payload;
+}
+
+/// Reads the fields of a payload. Reading past its end fails, and every later read returns zero.
+class Reader {
+public:
+    Reader(const char* data, size_t size) : data((const uint8_t*)data), end((const uint8_t*)data + size) {}
+
+    uint64_t Varint()
+    {
+        uint64_t value = 0;
+        for (unsigned shift = 0; ok && shift < 64; shift += 7) {
+            if (data == end)
+                break;
+            const uint8_t byte = *data++;
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return value;
+        }
+        ok = false;
+        return 0;
+    }
+
+    std::string String()
+    {
+        const uint64_t length = Varint();
+        if (!ok || length > (uint64_t)(end - data)) {
+            ok = false;
+            return std::string();
+        }
+        const std::string text((const char*)data, length);
+        data += length;
+        return text;
+    }
+
+    std::vector<uint64_t> Samples()
+    {
+        const uint64_t count = Varint();
+        std::vector<uint64_t> samples;
+        // Every sample takes at least a byte
+        if (!ok || count > (uint64_t)(end - data)) {
+            ok = false;
+            return samples;
+        }
+        uint64_t value = 0;
+        for (uint64_t i = 0; i < count && ok; ++i) {
+            value += Varint();
+            samples.push_back(value);
+        }
+        return samples;
+    }
+
+    bool Ok() const { return ok; }
+    size_t Remaining() const { return end - data; }
+
+private:
+    const uint8_t* data;
+    const uint8_t* end;
+    bool ok = true;
+};
+
+} // namespace
@@ -1,27 +1,189 @@
+#include <fstream>
+#include <string.h>
+#include <string>
+#include <vector>
 #include <3ds.h>
 
 #include "output.h"
+#include "stream.h"
+#include "common/string_funcs.h"
 #include "tests/test.h"
 #include "tests/fs/fs.h"
 #include "tests/cpu/cputests.h"
 #include "tests/kernel/kernel.h"
 #include "tests/gpu/gpu.h"
+#ifdef HWTESTS_HOST
+#include "model.h"
+#endif
+
+struct TestGroup {
+    const char* name;
+    TestCaller caller;
+};
 
 static unsigned int test_counter = 0;
-static TestCaller tests[] = {
-    FS::TestAll,
-    CPU::Integer::TestAll,
-    CPU::Memory::TestAll,
-    Kernel::TestAll,
-    GPU::TestAll
+static const TestGroup tests[] = {
+    { "FS", FS::TestAll },
+#ifndef HWTESTS_HOST
+    // These need ARM code or hardware that the host build does not model
+    { "CPU::Integer", CPU::Integer::TestAll },
+    { "CPU::Memory", CPU::Memory::TestAll },
+    { "Kernel", Kernel::TestAll },
+#else
+    // On the shim's model of the kernel
+    { "Kernel::WaitSynch", Kernel::WaitSynch::TestAll },
+    { "Kernel::AddressArbiter", Kernel::AddressArbiter::TestAll },
+#endif
+    // The host build runs these on its models of the GPU engines
+    { "GPU", GPU::TestAll },
+#ifndef HWTESTS_HOST
+    { "Benchmark::Kernel", Kernel::BenchmarkAll },
+    { "Benchmark::CPU::Timing", CPU::Timing::BenchmarkAll },
+    { "Benchmark::CPU::Memory", CPU::Memory::BenchmarkAll },
+#else
+    { "Benchmark::Kernel::AddressArbiter", Kernel::AddressArbiter::BenchmarkAll },
+#endif
+    { "Benchmark::GPU", GPU::BenchmarkAll },
+#ifdef HWTESTS_HOST
+    // Host models of the hardware, checked against results recorded on it
+    { "Model::Color", Model::Color::TestAll },
+    { "Model::Tiling", Model::Tiling::TestAll },
+    { "Model::Scale", Model::Scale::TestAll },
+    { "Model::MemoryFill", Model::MemoryFill::TestAll },
+    { "Model::Media", Model::Media::TestAll },
+    { "Model::Kernel", Model::Kernel::TestAll },
+    { "Benchmark::Model::Color", Model::Color::BenchmarkAll },
+    { "Benchmark::Model::Tiling", Model::Tiling::BenchmarkAll },
+    { "Benchmark::Model::Scale", Model::Scale::BenchmarkAll },
+    { "Benchmark::Model::MemoryFill", Model::MemoryFill::BenchmarkAll },
+    { "Benchmark::Model::Media", Model::Media::BenchmarkAll },
+    { "Benchmark::Model::Kernel", Model::Kernel::BenchmarkAll },
+#endif
+    { "Benchmark::FS", FS::BenchmarkAll }
 };
 
+static const unsigned int test_count = sizeof(tests) / sizeof(tests[0]);
+
+// If this file exists, or "--batch" is passed, all groups are run without waiting for input
+static const char* batch_file_path = "hwtest_batch.txt";
+static const char* results_path = "hwtest_results.json";
+// If this file exists, or "--collector <address>" is passed, results are also streamed to the
+// collector at the address on its first line
+static const char* collector_file_path = "hwtest_collector.txt";
+
+// A filter selects the group of the same name, and any group nested in it: "CPU" selects
+// "CPU::Integer" and "CPU::Memory", "Benchmark" selects every benchmark. No filters select all.
+static bool IsSelected(const TestGroup& group, const std::vector<std::string>& filters)
+{
+    if (filters.empty())
+        return true;
+
+    const std::string name = group.name;
+    for (const std::string& filter : filters) {
+        if (name == filter || name.compare(0, filter.length() + 2, filter + "::") == 0)
+            return true;
+    }
+    return false;
+}
+
+// Reads one filter per line of the batch file, skipping empty lines and lines starting with '#'
+static bool ReadBatchFile(std::vector<std::string>& filters)
+{
+    std::ifstream file(batch_file_path);
+    if (!file.is_open())
+        return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        const size_t begin = line.find_first_not_of(" \t\r");
+        if (begin == std::string::npos || line[begin] == '#')
+            continue;
+        const size_t end = line.find_last_not_of(" \t\r");
+        filters.push_back(line.substr(begin, end - begin + 1));
+    }
+    return true;
+}
+
+// The first line that is not empty or a comment, as in the batch file
+static bool ReadCollectorFile(std::string& address)
+{
+    std::ifstream file(collector_file_path);
+    std::string line;
+    while (std::getline(file, line)) {
+        const size_t begin = line.find_first_not_of(" \t\r");
+        if (begin == std::string::npos || line[begin] == '#')
+            continue;
+        const size_t end = line.find_last_not_of(" \t\r");
+        address = line.substr(begin, end - begin + 1);
+        return true;
+    }
+    return false;
+}
+
+static void RunGroup(const TestGroup& group)
+{
+    BeginTestGroup(group.name);
+    group.caller();
+    EndTestGroup();
+    FlushOutput();
+}
+
+// Returns false if any test failed, or no group was selected
+static bool RunBatch(const std::vector<std::string>& filters)
+{
+    unsigned int groups_run = 0;
+    for (const TestGroup& group : tests) {
+        if (!IsSelected(group, filters))
+            continue;
+
+        Log(Common::FormatString("=== %s\n", group.name));
+        RunGroup(group);
+        groups_run++;
+    }
+
+    if (groups_run == 0)
+        Log("No test group matches the filters\n");
+
+    if (!WriteTestResults(results_path))
+        Log(Common::FormatString("Could not write %s\n", results_path));
+    StreamEnd(groups_run, FailedTestCount());
+    Log(Common::FormatString("Ran %u groups, %u failures\n", groups_run, FailedTestCount()));
+    FlushOutput();
+    return groups_run != 0 && FailedTestCount() == 0;
+}
+
 int main(int argc, char** argv)
 {
     gfxInitDefault();
     InitOutput();
 
     consoleClear();
+
+    std::vector<std::string> filters;
+    bool batch = ReadBatchFile(filters);
+    std::string collector;
+    ReadCollectorFile(collector);
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--batch") == 0)
+            batch = true;
+        else if (strcmp(argv[i], "--collector") == 0 && i + 1 < argc)
+            collector = argv[++i];
+        else
+            filters.push_back(argv[i]);
+    }
+
+    if (!collector.empty() && !StreamConnect(collector))
+        Log(Common::FormatString("Could not connect to the collector at %s\n", collector.c_str()));
+
+    if (batch) {
+        const bool passed = RunBatch(filters);
+
+        DeinitOutput();
+        StreamDisconnect();
+        gfxExit();
+        return passed ? 0 : 1;
+    }
+
     Print("Press A to begin...\n");
 
     while (aptMainLoop()) {
@@ -34,8 +196,8 @@ int main(int argc, char** argv)
         } else if (hidKeysDown() & KEY_A) {
             consoleClear();
 
-            if (test_counter < (sizeof(tests) / sizeof(tests[0]))) {
-                tests[test_counter]();
+            if (test_counter < test_count) {
+                RunGroup(tests[test_counter]);
                 test_counter++;
             } else {
                 break;
@@ -50,8 +212,12 @@ int main(int argc, char** argv)
 
     consoleClear();
 
-    gfxExit();
+    WriteTestResults(results_path);
+    StreamEnd(test_counter, FailedTestCount());
+
     DeinitOutput();
+    StreamDisconnect();
+    gfxExit();
 
     return 0;
 }
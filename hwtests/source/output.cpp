@@ -1,42 +1,262 @@
 #include <3ds.h>
 
 #include "output.h"
+#include "stream.h"
 
 #include <fstream>
+#include <string.h>
 
 //#include "common/string_funcs.h"
 
 static FILE* log_file = nullptr;
+static FILE* bench_file = nullptr;
+
+enum Target {
+    TARGET_SCREEN = 1 << 0,
+    TARGET_LOG = 1 << 1,
+    TARGET_BENCH = 1 << 2,
+    TARGET_STREAM = 1 << 3,
+};
+
+// Queued output is a sequence of records, each a RecordHeader followed by its text
+struct RecordHeader {
+    u16 length;
+    u8 targets;
+    u8 padding;
+};
+
+static const u32 RING_SIZE = 0x10000;
+static const u32 MAX_RECORD_LENGTH = 0x1000;
+
+static char ring[RING_SIZE];
+// Bytes ever written to and read from the ring. RING_SIZE divides 2^32, so these can wrap.
+static u32 ring_write = 0;
+static u32 ring_read = 0;
+// Bytes of output lost because the ring was full while output was paused
+static u32 dropped = 0;
+static LightLock ring_lock;
+
+// Held while writing output, and while output is paused
+static Handle output_mutex;
+// Also read by threads waiting for the mutex, to tell a pause from a drain
+static volatile u32 pause_depth = 0;
+
+static Handle writer_event;
+static Handle writer_thread;
+static volatile bool writer_exit = false;
+static u32 writer_stack[0x400];
+
+static void RingCopyIn(const void* data, u32 size)
+{
+    const u32 pos = ring_write % RING_SIZE;
+    const u32 first = size < RING_SIZE - pos ? size : RING_SIZE - pos;
+    memcpy(ring + pos, data, first);
+    memcpy(ring, (const char*)data + first, size - first);
+    ring_write += size;
+}
+
+static void RingCopyOut(void* data, u32 size)
+{
+    const u32 pos = ring_read % RING_SIZE;
+    const u32 first = size < RING_SIZE - pos ? size : RING_SIZE - pos;
+    memcpy(data, ring + pos, first);
+    memcpy((char*)data + first, ring, size - first);
+    ring_read += size;
+}
+
+static void WriteRecord(u32 targets, const char* text, u32 length)
+{
+    if (targets & TARGET_SCREEN)
+        printf("%s", text);
+    if (targets & TARGET_LOG) {
+        svcOutputDebugString(text, length);
+        fprintf(log_file, "%s", text);
+    }
+    if (targets & TARGET_BENCH)
+        fprintf(bench_file, "%s", text);
+    // Binary, so sent by length rather than as a string
+    if (targets & TARGET_STREAM)
+        StreamSend(text, length);
+}
+
+// Writes out everything queued. The caller must hold output_mutex, with output not paused.
+static void Drain()
+{
+    static char record[MAX_RECORD_LENGTH + 1];
+    u32 targets = 0;
+
+    while (true) {
+        RecordHeader header;
+
+        LightLock_Lock(&ring_lock);
+        if (ring_read == ring_write) {
+            LightLock_Unlock(&ring_lock);
+            break;
+        }
+        RingCopyOut(&header, sizeof(header));
+        RingCopyOut(record, header.length);
+        LightLock_Unlock(&ring_lock);
+
+        record[header.length] = '\0';
+        WriteRecord(header.targets, record, header.length);
+        targets |= header.targets;
+    }
+
+    LightLock_Lock(&ring_lock);
+    const u32 lost = dropped;
+    dropped = 0;
+    LightLock_Unlock(&ring_lock);
+    if (lost) {
+        const int length = snprintf(record, sizeof(record), "[%lu bytes of output dropped]\n", (unsigned long)lost);
+        WriteRecord(TARGET_SCREEN | TARGET_LOG, record, length);
+        targets |= TARGET_SCREEN | TARGET_LOG;
+    }
+
+    if (targets & TARGET_LOG)
+        fflush(log_file);
+    if (targets & TARGET_BENCH)
+        fflush(bench_file);
+    if (targets & TARGET_SCREEN) {
+        gfxFlushBuffers();
+        gfxSwapBuffers();
+    }
+}
+
+enum DrainResult {
+    DRAIN_DONE,
+    // Another thread is writing output
+    DRAIN_BUSY,
+    // Output is paused, by this thread or another one
+    DRAIN_PAUSED,
+};
+
+// Drains without waiting for the output mutex
+static DrainResult TryDrain()
+{
+    if (svcWaitSynchronization(output_mutex, 0) != 0)
+        return pause_depth != 0 ? DRAIN_PAUSED : DRAIN_BUSY;
+
+    const bool paused = pause_depth != 0;
+    if (!paused)
+        Drain();
+    svcReleaseMutex(output_mutex);
+    return paused ? DRAIN_PAUSED : DRAIN_DONE;
+}
+
+static void Queue(u32 targets, const std::string& text)
+{
+    const u32 length = text.length() < MAX_RECORD_LENGTH ? text.length() : MAX_RECORD_LENGTH;
+    const u32 size = sizeof(RecordHeader) + length;
+
+    LightLock_Lock(&ring_lock);
+    while (RING_SIZE - (ring_write - ring_read) < size) {
+        // Make room, unless that would mean writing in the middle of timed code
+        LightLock_Unlock(&ring_lock);
+        const DrainResult result = TryDrain();
+        if (result == DRAIN_PAUSED) {
+            LightLock_Lock(&ring_lock);
+            dropped += length;
+            LightLock_Unlock(&ring_lock);
+            return;
+        }
+        // The thread writing output empties the ring before it lets go of the mutex
+        if (result == DRAIN_BUSY)
+            FlushOutput();
+        LightLock_Lock(&ring_lock);
+    }
+
+    const RecordHeader header = { (u16)length, (u8)targets, 0 };
+    RingCopyIn(&header, sizeof(header));
+    RingCopyIn(text.data(), length);
+    LightLock_Unlock(&ring_lock);
+
+    svcSignalEvent(writer_event);
+}
+
+// Lowest priority, so it only writes when nothing else wants to run
+static void writer_handler(void*)
+{
+    while (!writer_exit) {
+        svcWaitSynchronization(writer_event, U64_MAX);
+        FlushOutput();
+    }
+    svcExitThread();
+}
 
 void InitOutput()
 {
     sdmcInit();
     consoleInit(GFX_TOP, nullptr);
     log_file = fopen("hwtest_log.txt", "w");
+    bench_file = fopen("hwtest_bench.csv", "w");
+    fprintf(bench_file, "group,name,iterations,overhead,min,median,p99\n");
+
+    LightLock_Init(&ring_lock);
+    svcCreateMutex(&output_mutex, false);
+    svcCreateEvent(&writer_event, RESET_ONESHOT);
+    writer_exit = false;
+    svcCreateThread(&writer_thread, writer_handler, 0x0, (u32*)(&writer_stack[0x400]), 0x3F, 0xfffffffe);
 }
 
 void Print(const std::string& text)
 {
-    printf("%s", text.c_str());
-    gfxFlushBuffers();
-    gfxSwapBuffers();
+    Queue(TARGET_SCREEN, text);
+    FlushOutput();
 }
 
 void Log(const std::string& text)
 {
-    Print(text);
-    LogToFile(text);
+    Queue(TARGET_SCREEN | TARGET_LOG, text);
 }
 
 void LogToFile(const std::string& text)
 {
-    svcOutputDebugString(text.c_str(), text.length());
-    fprintf(log_file, "%s", text.c_str());
-    fflush(log_file);
+    Queue(TARGET_LOG, text);
+}
+
+void LogBenchmark(const std::string& text)
+{
+    Queue(TARGET_BENCH, text);
+}
+
+void LogStreamRecord(const std::string& record)
+{
+    Queue(TARGET_STREAM, record);
+}
+
+void FlushOutput()
+{
+    svcWaitSynchronization(output_mutex, U64_MAX);
+    if (pause_depth == 0)
+        Drain();
+    svcReleaseMutex(output_mutex);
+}
+
+void PauseOutput()
+{
+    svcWaitSynchronization(output_mutex, U64_MAX);
+    pause_depth++;
+}
+
+void ResumeOutput()
+{
+    pause_depth--;
+    svcReleaseMutex(output_mutex);
 }
 
 void DeinitOutput()
 {
+    writer_exit = true;
+    svcSignalEvent(writer_event);
+    svcWaitSynchronization(writer_thread, U64_MAX);
+    svcCloseHandle(writer_thread);
+
+    FlushOutput();
+    svcCloseHandle(writer_event);
+    svcCloseHandle(output_mutex);
+
+    fclose(bench_file);
+    bench_file = nullptr;
     fclose(log_file);
     log_file = nullptr;
     sdmcExit();
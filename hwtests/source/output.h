@@ -4,9 +4,12 @@
 
 #include <3ds.h>
 
+// Log(), LogToFile(), LogBenchmark() and LogStreamRecord() only queue their text. It is written out by a low priority
+// thread, or by FlushOutput(), except while output is paused.
+
 void InitOutput();
 
-/// Prints `text` to `screen`.
+/// Prints `text` to `screen`, after any queued output.
 void Print(const std::string& text);
 
 /// Prints `text` to `screen`, and logs it in the log file.
@@ -15,4 +18,20 @@ void Log(const std::string& text);
 /// Logs `text` to the log file.
 void LogToFile(const std::string& text);
 
+/// Appends `text` to the machine-readable benchmark results file.
+void LogBenchmark(const std::string& text);
+
+/// Sends binary `record` to the result collector: see stream.h.
+void LogStreamRecord(const std::string& record);
+
+/// Writes out all queued output. Does nothing while output is paused.
+void FlushOutput();
+
+/**
+ * Waits for any output being written to finish, then keeps queued output from being written
+ * until ResumeOutput(). Use around timed code. Calls nest.
+ */
+void PauseOutput();
+void ResumeOutput();
+
 void DeinitOutput();
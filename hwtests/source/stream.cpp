@@ -0,0 +1,170 @@
+#include "stream.h"
+
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "output.h"
+#include "common/stream_format.h"
+#include "common/string_funcs.h"
+
+using namespace StreamFormat;
+
+// soc:U wants a page aligned buffer of its own, of the size libctru's examples give it
+static const u32 SOC_BUFFER_SIZE = 0x100000;
+
+static u32* soc_buffer = nullptr;
+static int stream_socket = -1;
+// Set once a send fails, after which nothing more is sent
+static bool stream_failed = false;
+
+#ifdef _3DS
+static const char* platform = "3ds";
+#else
+static const char* platform = "host";
+#endif
+
+static bool SendAll(const char* data, u32 length)
+{
+#ifdef MSG_NOSIGNAL
+    // A collector that went away is reported by StreamEnd(), rather than by SIGPIPE
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+
+    while (length != 0) {
+        const int sent = send(stream_socket, data, length, flags);
+        if (sent <= 0)
+            return false;
+        data += sent;
+        length -= sent;
+    }
+    return true;
+}
+
+static void CloseSocket()
+{
+    if (stream_socket >= 0)
+        close(stream_socket);
+    stream_socket = -1;
+    if (soc_buffer != nullptr) {
+        socExit();
+        free(soc_buffer);
+        soc_buffer = nullptr;
+    }
+}
+
+bool StreamConnect(const std::string& address)
+{
+    const size_t colon = address.rfind(':');
+    if (colon == std::string::npos)
+        return false;
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr(address.substr(0, colon).c_str());
+    const int port = atoi(address.c_str() + colon + 1);
+    if (addr.sin_addr.s_addr == INADDR_NONE || port <= 0 || port > 0xFFFF)
+        return false;
+    addr.sin_port = htons(port);
+
+    soc_buffer = (u32*)memalign(0x1000, SOC_BUFFER_SIZE);
+    if (soc_buffer == nullptr)
+        return false;
+    if (socInit(soc_buffer, SOC_BUFFER_SIZE) != 0) {
+        free(soc_buffer);
+        soc_buffer = nullptr;
+        return false;
+    }
+
+    stream_socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (stream_socket < 0 || connect(stream_socket, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        CloseSocket();
+        return false;
+    }
+    stream_failed = false;
+
+    // Sent right away, ahead of any queued output
+    std::string hello;
+    PutVarint(hello, MAGIC);
+    PutVarint(hello, VERSION);
+    PutString(hello, platform);
+    PutVarint(hello, SYSCLOCK_ARM11);
+    const std::string record = MakeRecord(RECORD_HELLO, hello);
+    if (!SendAll(record.data(), record.length())) {
+        CloseSocket();
+        return false;
+    }
+    return true;
+}
+
+void StreamGroup(const std::string& name)
+{
+    if (stream_socket < 0)
+        return;
+
+    std::string payload;
+    PutString(payload, name);
+    LogStreamRecord(MakeRecord(RECORD_GROUP, payload));
+}
+
+void StreamTest(const std::string& group, const std::string& name, bool passed, u64 ticks)
+{
+    if (stream_socket < 0)
+        return;
+
+    std::string payload;
+    PutString(payload, group);
+    PutString(payload, name);
+    PutVarint(payload, passed);
+    PutVarint(payload, ticks);
+    LogStreamRecord(MakeRecord(RECORD_TEST, payload));
+}
+
+void StreamBenchmark(const std::string& group, const std::string& name, u64 overhead, const std::vector<u64>& samples)
+{
+    if (stream_socket < 0)
+        return;
+
+    std::string payload;
+    PutString(payload, group);
+    PutString(payload, name);
+    PutVarint(payload, samples.size());
+    PutVarint(payload, overhead);
+    PutSamples(payload, samples);
+    LogStreamRecord(MakeRecord(RECORD_BENCHMARK, payload));
+}
+
+void StreamEnd(u32 groups_run, u32 failures)
+{
+    if (stream_socket < 0)
+        return;
+
+    std::string payload;
+    PutVarint(payload, groups_run);
+    PutVarint(payload, failures);
+    LogStreamRecord(MakeRecord(RECORD_END, payload));
+    FlushOutput();
+
+    if (stream_failed)
+        Log("Lost the connection to the collector, results were only partly sent\n");
+}
+
+void StreamSend(const char* data, u32 length)
+{
+    if (stream_socket < 0 || stream_failed)
+        return;
+    if (!SendAll(data, length))
+        stream_failed = true;
+}
+
+void StreamDisconnect()
+{
+    CloseSocket();
+}
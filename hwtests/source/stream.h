@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <3ds.h>
+
+// Streams test results and benchmark samples to a collector on another machine (host/collector),
+// over soc:U. Records are queued with the rest of the output, and sent along with it, so that
+// nothing is sent while timed code runs. Every function does nothing unless connected.
+
+/// Connects to the collector at `address`, an IPv4 address and a port, e.g. "192.168.1.2:5123".
+/// Returns false if the address is not one, or nothing accepted the connection.
+bool StreamConnect(const std::string& address);
+
+/// Starts a group of tests, as run from main().
+void StreamGroup(const std::string& name);
+
+void StreamTest(const std::string& group, const std::string& name, bool passed, u64 ticks);
+
+/// Streams the benchmark's `samples`, in ticks, which must be sorted.
+void StreamBenchmark(const std::string& group, const std::string& name, u64 overhead, const std::vector<u64>& samples);
+
+/// Ends the run. Logs whether the collector was sent everything up to this point.
+void StreamEnd(u32 groups_run, u32 failures);
+
+/// Sends `data` to the collector. Called by the output writer, for records queued with
+/// LogStreamRecord().
+void StreamSend(const char* data, u32 length);
+
+/// Closes the connection, once all output has been written.
+void StreamDisconnect();
@@ -0,0 +1,71 @@
+#include "benchmark.h"
+
+#include <algorithm>
+
+#include "output.h"
+#include "stream.h"
+#include "common/string_funcs.h"
+
+// Iterations used to measure the cost of an empty body
+static const u32 CALIBRATION_ITERATIONS = 1000;
+
+u64 BenchmarkOverhead()
+{
+    static bool calibrated = false;
+    static u64 overhead = 0;
+
+    if (!calibrated) {
+        // Take the fastest empty iteration, so that subtracting it never hides work done by a body
+        auto empty = [] {};
+        std::vector<u64> samples;
+        PauseOutput();
+        detail::MeasureBenchmark(CALIBRATION_ITERATIONS, 0, empty, samples);
+        ResumeOutput();
+        overhead = *std::min_element(samples.begin(), samples.end());
+        calibrated = true;
+    }
+    return overhead;
+}
+
+u64 BenchmarkElapsed(u64 start, u64 end)
+{
+    const u64 ticks = end - start;
+    const u64 overhead = BenchmarkOverhead();
+    return ticks > overhead ? ticks - overhead : 0;
+}
+
+// Nearest-rank percentile of sorted, non-empty samples
+static u64 Percentile(const std::vector<u64>& samples, u32 percent)
+{
+    const size_t rank = (samples.size() * percent + 99) / 100;
+    return samples[rank ? rank - 1 : 0];
+}
+
+BenchmarkResult ReportBenchmark(const std::string& group, const std::string& name, std::vector<u64>& samples)
+{
+    BenchmarkResult result = {};
+    result.iterations = samples.size();
+
+    if (samples.empty()) {
+        Log(Common::FormatString("BENCHMARK: [%s] %s: no samples\n", group.c_str(), name.c_str()));
+        return result;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    result.min = samples.front();
+    result.median = Percentile(samples, 50);
+    result.p99 = Percentile(samples, 99);
+
+    Log(Common::FormatString("BENCHMARK: [%s] %s: min %llu, median %llu, p99 %llu ticks\n",
+                             group.c_str(), name.c_str(), result.min, result.median, result.p99));
+    LogBenchmark(Common::FormatString("%s,%s,%u,%llu,%llu,%llu,%llu\n", group.c_str(), name.c_str(),
+                                      result.iterations, BenchmarkOverhead(), result.min, result.median, result.p99));
+    StreamBenchmark(group, name, BenchmarkOverhead(), samples);
+    return result;
+}
+
+void LogBandwidth(u64 bytes, const BenchmarkResult& result)
+{
+    if (result.median)
+        Log(Common::FormatString("    %llu MB/s\n", bytes * SYSCLOCK_ARM11 / result.median / 1000000));
+}
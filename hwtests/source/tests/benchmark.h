@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <3ds.h>
+
+#include "output.h"
+
+struct BenchmarkResult {
+    u32 iterations;
+    u64 min;
+    u64 median;
+    u64 p99;
+};
+
+/// Ticks an empty Benchmark() iteration takes, measured once on first use.
+u64 BenchmarkOverhead();
+
+/// Ticks from `start` to `end`, less BenchmarkOverhead(). For timestamps taken on different threads.
+u64 BenchmarkElapsed(u64 start, u64 end);
+
+/**
+ * Prints min/median/p99 of `samples` (in system ticks) and appends them to the benchmark results
+ * file. Use directly for measurements that Benchmark() cannot take, e.g. when the end timestamp
+ * comes from another thread, pausing output while they are taken. Sorts `samples`.
+ */
+BenchmarkResult ReportBenchmark(const std::string& group, const std::string& name, std::vector<u64>& samples);
+
+/// Prints the bandwidth of moving `bytes` in the median time of `result`.
+void LogBandwidth(u64 bytes, const BenchmarkResult& result);
+
+namespace detail {
+    /// Keeps the compiler from moving memory accesses of the body across the tick reads.
+    inline void BenchmarkBarrier() { asm volatile ("" ::: "memory"); }
+
+    template <typename Func>
+    void MeasureBenchmark(u32 iterations, u64 overhead, Func& body, std::vector<u64>& samples) {
+        samples.clear();
+        samples.reserve(iterations);
+        for (u32 i = 0; i < iterations; ++i) {
+            BenchmarkBarrier();
+            const u64 start = svcGetSystemTick();
+            BenchmarkBarrier();
+            body();
+            BenchmarkBarrier();
+            const u64 ticks = svcGetSystemTick() - start;
+            BenchmarkBarrier();
+            samples.push_back(ticks > overhead ? ticks - overhead : 0);
+        }
+    }
+}
+
+/**
+ * Runs `body` once untimed to warm up caches, then `iterations` more times, timing each call with
+ * svcGetSystemTick. The calibrated loop overhead is subtracted from every sample before reporting.
+ * Output is paused while `body` runs.
+ *
+ * Example usage:
+ * \code
+ * Benchmark("Kernel::Events", "SignalEvent", 1000, [&] { svcSignalEvent(event); });
+ * \endcode
+ */
+template <typename Func>
+BenchmarkResult Benchmark(const std::string& group, const std::string& name, u32 iterations, Func body)
+{
+    std::vector<u64> samples;
+    const u64 overhead = BenchmarkOverhead();
+
+    PauseOutput();
+    body();
+    detail::MeasureBenchmark(iterations, overhead, body, samples);
+    ResumeOutput();
+
+    return ReportBenchmark(group, name, samples);
+}
@@ -2,5 +2,6 @@
 
 namespace CPU {
     namespace Integer { void TestAll(); }
-    namespace Memory { void TestAll(); }
+    namespace Memory { void TestAll(); void BenchmarkAll(); }
+    namespace Timing { void BenchmarkAll(); }
 }
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <malloc.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "output.h"
+#include "common/scope_exit.h"
+#include "common/string_funcs.h"
+#include "tests/benchmark.h"
+
+namespace CPU {
+namespace Memory {
+
+static const std::string tag = "Memory";
+
+static const u32 ITERATIONS = 20;
+
+// Loads per pointer chasing sample
+static const u32 CHASE_STEPS = 4096;
+
+// Size of an ARM11 data cache line, and of a pointer chasing node
+static const u32 LINE_SIZE = 32;
+
+struct Region {
+    const char* name;
+    void* (*alloc)(size_t size);
+    void (*free)(void* ptr);
+};
+
+static void* HeapAlloc(size_t size) {
+    return memalign(LINE_SIZE, size);
+}
+
+static const Region regions[] = {
+    { "heap", HeapAlloc, free },
+    { "linear", linearAlloc, linearFree },
+    { "VRAM", vramAlloc, vramFree },
+};
+
+static const u32 sizes[] = { 0x1000, 0x4000, 0x10000, 0x40000, 0x100000, 0x400000 };
+
+// Reads `size` bytes with LDMIA, 32 bytes at a time
+static void ReadLdm(const void* buffer, u32 size) {
+    const u8* ptr = (const u8*)buffer;
+    const u8* end = ptr + size;
+    asm volatile ("1:\n"
+                  "LDMIA %[ptr]!, {r4-r10, r12}\n"
+                  "CMP %[ptr], %[end]\n"
+                  "BLO 1b\n"
+                  : [ptr] "+r"(ptr)
+                  : [end] "r"(end)
+                  : "r4", "r5", "r6", "r7", "r8", "r9", "r10", "r12", "cc", "memory");
+}
+
+// Writes `size` bytes with STMIA, 32 bytes at a time
+static void WriteStm(void* buffer, u32 size) {
+    u8* ptr = (u8*)buffer;
+    const u8* end = ptr + size;
+    asm volatile ("1:\n"
+                  "STMIA %[ptr]!, {r4-r10, r12}\n"
+                  "CMP %[ptr], %[end]\n"
+                  "BLO 1b\n"
+                  : [ptr] "+r"(ptr)
+                  : [end] "r"(end)
+                  : "r4", "r5", "r6", "r7", "r8", "r9", "r10", "r12", "cc", "memory");
+}
+
+// Links one node per cache line into a single random cycle, so that every load misses the
+// prefetcher and depends on the one before it
+static void BuildChase(void* buffer, u32 size) {
+    const u32 count = size / LINE_SIZE;
+    std::vector<u32> order(count);
+    for (u32 i = 0; i < count; ++i)
+        order[i] = i;
+
+    // Sattolo's algorithm, with a fixed seed so that runs are comparable
+    u32 seed = 0x12345678;
+    for (u32 i = count - 1; i > 0; --i) {
+        seed = seed * 1103515245 + 12345;
+        const u32 j = (seed >> 8) % i;
+        std::swap(order[i], order[j]);
+    }
+
+    u8* base = (u8*)buffer;
+    for (u32 i = 0; i < count; ++i)
+        *(void**)(base + order[i] * LINE_SIZE) = base + order[(i + 1) % count] * LINE_SIZE;
+}
+
+static void* Chase(void* start) {
+    void* ptr = start;
+    for (u32 i = 0; i < CHASE_STEPS; ++i)
+        ptr = *(void* volatile*)ptr;
+    return ptr;
+}
+
+static void BenchmarkRegion(const Region& region, u32 size) {
+    PauseOutput();
+    SCOPE_EXIT({ ResumeOutput(); });
+
+    u8* buffer = (u8*)region.alloc(size);
+    if (buffer == nullptr) {
+        Log(Common::FormatString("BENCHMARK: [%s] could not allocate 0x%X bytes of %s\n", tag.c_str(), size, region.name));
+        return;
+    }
+
+    const std::string suffix = Common::FormatString(", %s, %u KiB", region.name, size / 1024);
+    BenchmarkResult result;
+
+    result = Benchmark(tag, "memset" + suffix, ITERATIONS, [&] { memset(buffer, 0, size); });
+    LogBandwidth(size, result);
+
+    // Copies one half of the buffer into the other, so the working set stays `size` bytes
+    result = Benchmark(tag, "memcpy" + suffix, ITERATIONS, [&] { memcpy(buffer, buffer + size / 2, size / 2); });
+    LogBandwidth(size / 2, result);
+
+    result = Benchmark(tag, "LDM read" + suffix, ITERATIONS, [&] { ReadLdm(buffer, size); });
+    LogBandwidth(size, result);
+
+    result = Benchmark(tag, "STM write" + suffix, ITERATIONS, [&] { WriteStm(buffer, size); });
+    LogBandwidth(size, result);
+
+    // Cost of writing back dirty lines, and of reading the buffer again after dropping it from
+    // the cache
+    std::vector<u64> samples;
+    samples.reserve(ITERATIONS);
+    for (u32 i = 0; i < ITERATIONS; ++i) {
+        WriteStm(buffer, size);
+        const u64 start = svcGetSystemTick();
+        GSPGPU_FlushDataCache(buffer, size);
+        samples.push_back(BenchmarkElapsed(start, svcGetSystemTick()));
+    }
+    ReportBenchmark(tag, "FlushDataCache, dirty" + suffix, samples);
+
+    samples.clear();
+    for (u32 i = 0; i < ITERATIONS; ++i) {
+        GSPGPU_InvalidateDataCache(buffer, size);
+        const u64 start = svcGetSystemTick();
+        ReadLdm(buffer, size);
+        samples.push_back(BenchmarkElapsed(start, svcGetSystemTick()));
+    }
+    result = ReportBenchmark(tag, "LDM read after InvalidateDataCache" + suffix, samples);
+    LogBandwidth(size, result);
+
+    BuildChase(buffer, size);
+    result = Benchmark(tag, Common::FormatString("Pointer chase x%u", CHASE_STEPS) + suffix, ITERATIONS, [&] { Chase(buffer); });
+    const u64 hundredths = result.min * 100 / CHASE_STEPS;
+    Log(Common::FormatString("    %llu.%02llu cycles per load\n", hundredths / 100, hundredths % 100));
+
+    region.free(buffer);
+}
+
+void BenchmarkAll() {
+    for (const Region& region : regions) {
+        for (u32 size : sizes)
+            BenchmarkRegion(region, size);
+    }
+}
+
+}
+}
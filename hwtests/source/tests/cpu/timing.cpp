@@ -0,0 +1,97 @@
+#include <string>
+#include "output.h"
+#include "common/string_funcs.h"
+#include "tests/benchmark.h"
+
+namespace CPU {
+namespace Timing {
+
+static const std::string tag = "Timing";
+
+static const u32 ITERATIONS = 100;
+
+// Instructions in each timed chain. A multiple of the number of throughput accumulators.
+#define CHAIN_LENGTH 1200
+#define STRINGIFY(x) #x
+#define TO_STRING(x) STRINGIFY(x)
+
+// Zeroes for the loads and stores to use, so that loaded values can feed the next address
+static u32 zeroes[4] = {};
+
+// Each instruction is written as the body of the assembler macro `bench_op d, s`, with \d as both
+// its destination and an input, and \s as a second input register.
+//
+// The latency chain runs the macro CHAIN_LENGTH times on one register, so every instruction waits
+// for the previous one. The throughput chain rotates through six registers, leaving enough
+// independent work in flight to hide the latency of everything timed here.
+#define BENCH_OP(body) ".macro bench_op d, s\n" body "\n.endm\n"
+
+#define LATENCY_CHAIN(body) \
+    BENCH_OP(body) \
+    ".rept " TO_STRING(CHAIN_LENGTH) "\n" \
+    "bench_op %[a0], %[s]\n" \
+    ".endr\n" \
+    ".purgem bench_op\n"
+
+#define THROUGHPUT_CHAIN(body) \
+    BENCH_OP(body) \
+    ".rept " TO_STRING(CHAIN_LENGTH) " / 6\n" \
+    "bench_op %[a0], %[s]\n" \
+    "bench_op %[a1], %[s]\n" \
+    "bench_op %[a2], %[s]\n" \
+    "bench_op %[a3], %[s]\n" \
+    "bench_op %[a4], %[s]\n" \
+    "bench_op %[a5], %[s]\n" \
+    ".endr\n" \
+    ".purgem bench_op\n"
+
+#define RUN_CHAIN(chain) \
+    [] { \
+        u32 a0 = 0, a1 = 0, a2 = 0, a3 = 0, a4 = 0, a5 = 0; \
+        asm volatile (chain \
+                      : [a0] "+r"(a0), [a1] "+r"(a1), [a2] "+r"(a2), [a3] "+r"(a3), [a4] "+r"(a4), [a5] "+r"(a5) \
+                      : [s] "r"(zeroes) \
+                      : "memory"); \
+    }
+
+template <typename Func>
+static void TimeChain(const std::string& name, const char* kind, Func chain) {
+    const BenchmarkResult result = Benchmark(tag, Common::FormatString("%s %s, x%u", name.c_str(), kind, CHAIN_LENGTH), ITERATIONS, chain);
+
+    // The system tick runs at the ARM11 clock of the original 3DS
+    const u64 hundredths = result.min * 100 / CHAIN_LENGTH;
+    Log(Common::FormatString("    %llu.%02llu cycles per instruction\n", hundredths / 100, hundredths % 100));
+}
+
+#define TIME_INSTRUCTION(name, body) \
+    do { \
+        TimeChain(name, "latency", RUN_CHAIN(LATENCY_CHAIN(body))); \
+        TimeChain(name, "throughput", RUN_CHAIN(THROUGHPUT_CHAIN(body))); \
+    } while (0)
+
+void BenchmarkAll() {
+    TIME_INSTRUCTION("ADD", "ADD \\d, \\d, \\s");
+    TIME_INSTRUCTION("SUB", "SUB \\d, \\d, \\s");
+    TIME_INSTRUCTION("MUL", "MUL \\d, \\d, \\s");
+    TIME_INSTRUCTION("MLA", "MLA \\d, \\d, \\s, \\d");
+    TIME_INSTRUCTION("QADD16", "QADD16 \\d, \\d, \\s");
+    TIME_INSTRUCTION("QSUB16", "QSUB16 \\d, \\d, \\s");
+    TIME_INSTRUCTION("SASX", "SASX \\d, \\d, \\s");
+    TIME_INSTRUCTION("SSAX", "SSAX \\d, \\d, \\s");
+    TIME_INSTRUCTION("UQSUB8", "UQSUB8 \\d, \\d, \\s");
+    TIME_INSTRUCTION("USAD8", "USAD8 \\d, \\d, \\s");
+    TIME_INSTRUCTION("USADA8", "USADA8 \\d, \\s, \\s, \\d");
+    TIME_INSTRUCTION("SXTH", "SXTH \\d, \\d");
+    TIME_INSTRUCTION("UXTAB16", "UXTAB16 \\d, \\d, \\s");
+    TIME_INSTRUCTION("UXTB16", "UXTB16 \\d, \\d");
+
+    // \d stays zero, so adding it to the address makes each load wait for the previous one
+    TIME_INSTRUCTION("LDR", "LDR \\d, [\\s, \\d]");
+    TIME_INSTRUCTION("LDRSH", "LDRSH \\d, [\\s, \\d]");
+
+    // Stores have no result to wait for, so both chains measure throughput
+    TIME_INSTRUCTION("STRH", "STRH \\d, [\\s]");
+}
+
+}
+}
@@ -8,4 +8,9 @@ void TestAll()
     SDMC::TestAll();
 }
 
+void BenchmarkAll()
+{
+    SDMC::BenchmarkAll();
+}
+
 } // namespace
@@ -3,5 +3,6 @@
 namespace FS {
 
 void TestAll();
+void BenchmarkAll();
 
 }
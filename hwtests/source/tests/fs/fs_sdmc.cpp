@@ -99,7 +99,7 @@ static bool TestFileWriteRead(FS_Archive sdmcArchive)
     // Verify file size
     SoftAssert(fileSize == bytesWritten);
 
-    std::unique_ptr<char> stringRead(new char[fileSize]);
+    std::unique_ptr<char[]> stringRead(new char[fileSize]);
     // Read from file
     SoftAssert(FSFILE_Read(fileHandle, &bytesRead, 0, stringRead.get(), fileSize) == 0);
     // Verify string contents
@@ -160,13 +160,13 @@ void TestAll()
 {
     FS_Archive sdmcArchive;
 
-    Test("SDMC", "Opening archive", FSUSER_OpenArchive(&sdmcArchive, ARCHIVE_SDMC, fsMakePath(PATH_EMPTY, "")), 0L);
+    Test("SDMC", "Opening archive", FSUSER_OpenArchive(&sdmcArchive, ARCHIVE_SDMC, fsMakePath(PATH_EMPTY, "")), (Result)0);
     Test("SDMC", "Creating and deleting file", TestFileCreateDelete(sdmcArchive), true);
     Test("SDMC", "Renaming file", TestFileRename(sdmcArchive), true);
     Test("SDMC", "Writing and reading file", TestFileWriteRead(sdmcArchive), true);
     Test("SDMC", "Creating and deleting directory", TestDirCreateDelete(sdmcArchive), true);
     Test("SDMC", "Renaming directory", TestDirRename(sdmcArchive), true);
-    Test("SDMC", "Closing archive", FSUSER_CloseArchive(sdmcArchive), 0L);
+    Test("SDMC", "Closing archive", FSUSER_CloseArchive(sdmcArchive), (Result)0);
 }
 
 } // namespace
@@ -4,6 +4,7 @@ namespace FS {
 namespace SDMC {
 
 void TestAll();
+void BenchmarkAll();
 
 }
 }
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include <memory>
+#include <string>
+#include <vector>
+#include <3ds.h>
+
+#include "output.h"
+#include "common/scope_exit.h"
+#include "common/string_funcs.h"
+#include "tests/benchmark.h"
+#include "tests/fs/fs_sdmc.h"
+
+namespace FS {
+namespace SDMC {
+
+static const std::string tag = "SDMC";
+
+static const u32 ITERATIONS = 100;
+
+static const u32 FILE_SIZE = 8 * 1024 * 1024;
+static const u32 MAX_CHUNK_SIZE = 1024 * 1024;
+
+// Most requests timed per chunk size, so that small chunks do not take minutes
+static const u32 MAX_REQUESTS = 256;
+
+static const u32 DIRECTORY_ENTRIES = 512;
+static const u32 ENTRIES_PER_READ = 32;
+
+static const u32 chunk_sizes[] = { 0x200, 0x1000, 0x8000, 0x40000, MAX_CHUNK_SIZE };
+
+// Times one FSFILE_Read or FSFILE_Write per sample, at sequential or random chunk aligned offsets
+static void TimeTransfers(Handle file, u8* buffer, u32 chunk_size, bool write, bool random) {
+    PauseOutput();
+    SCOPE_EXIT({ ResumeOutput(); });
+
+    const u32 chunks = FILE_SIZE / chunk_size;
+    const u32 requests = chunks < MAX_REQUESTS ? chunks : MAX_REQUESTS;
+
+    std::vector<u64> samples;
+    samples.reserve(requests);
+
+    // Fixed seed, so that every run uses the same offsets
+    u32 seed = 0x12345678;
+    Result res = 0;
+    for (u32 i = 0; i < requests && res == 0; ++i) {
+        u32 chunk = i;
+        if (random) {
+            seed = seed * 1103515245 + 12345;
+            chunk = (seed >> 8) % chunks;
+        }
+
+        u32 bytes;
+        const u64 offset = (u64)chunk * chunk_size;
+        const u64 start = svcGetSystemTick();
+        if (write)
+            res = FSFILE_Write(file, &bytes, offset, buffer, chunk_size, 0);
+        else
+            res = FSFILE_Read(file, &bytes, offset, buffer, chunk_size);
+        samples.push_back(BenchmarkElapsed(start, svcGetSystemTick()));
+    }
+
+    const std::string name = Common::FormatString("%s %s, 0x%X bytes", random ? "Random" : "Sequential",
+                                                  write ? "FSFILE_Write" : "FSFILE_Read", chunk_size);
+    if (res != 0) {
+        Log(Common::FormatString("BENCHMARK: [%s] %s: failed: 0x%08X\n", tag.c_str(), name.c_str(), (u32)res));
+        return;
+    }
+    LogBandwidth(chunk_size, ReportBenchmark(tag, name, samples));
+}
+
+static void BenchmarkFile(FS_Archive archive) {
+    PauseOutput();
+    SCOPE_EXIT({ ResumeOutput(); });
+
+    const FS_Path path = fsMakePath(PATH_ASCII, "/hwtest_bench.bin");
+    std::unique_ptr<u8[]> buffer(new u8[MAX_CHUNK_SIZE]());
+
+    Handle file;
+    if (FSUSER_OpenFile(&file, archive, path, FS_OPEN_CREATE | FS_OPEN_READ | FS_OPEN_WRITE, 0) != 0) {
+        Log(Common::FormatString("BENCHMARK: [%s] could not create the test file\n", tag.c_str()));
+        return;
+    }
+    SCOPE_EXIT({
+        FSFILE_Close(file);
+        FSUSER_DeleteFile(archive, path);
+    });
+
+    // Allocate the whole file up front, so that writes below do not also grow it
+    u32 bytes;
+    for (u32 offset = 0; offset < FILE_SIZE; offset += MAX_CHUNK_SIZE)
+        FSFILE_Write(file, &bytes, offset, buffer.get(), MAX_CHUNK_SIZE, 0);
+    FSFILE_Flush(file);
+
+    for (u32 chunk_size : chunk_sizes) {
+        TimeTransfers(file, buffer.get(), chunk_size, false, false);
+        TimeTransfers(file, buffer.get(), chunk_size, false, true);
+        TimeTransfers(file, buffer.get(), chunk_size, true, false);
+        TimeTransfers(file, buffer.get(), chunk_size, true, true);
+    }
+
+    // Cost of writing back a small change, explicitly or as part of the write
+    std::vector<u64> samples;
+    samples.reserve(ITERATIONS);
+    for (u32 i = 0; i < ITERATIONS; ++i) {
+        FSFILE_Write(file, &bytes, 0, buffer.get(), 0x1000, 0);
+        const u64 start = svcGetSystemTick();
+        FSFILE_Flush(file);
+        samples.push_back(BenchmarkElapsed(start, svcGetSystemTick()));
+    }
+    ReportBenchmark(tag, "FSFILE_Flush after a 0x1000 byte write", samples);
+
+    Benchmark(tag, "FSFILE_Write 0x1000 bytes, FS_WRITE_FLUSH", ITERATIONS, [&] {
+        FSFILE_Write(file, &bytes, 0, buffer.get(), 0x1000, FS_WRITE_FLUSH);
+    });
+
+    Benchmark(tag, "FSUSER_OpenFile + FSFILE_Close", ITERATIONS, [&] {
+        Handle handle;
+        if (FSUSER_OpenFile(&handle, archive, path, FS_OPEN_READ, 0) == 0)
+            FSFILE_Close(handle);
+    });
+}
+
+static void BenchmarkDirectory(FS_Archive archive) {
+    PauseOutput();
+    SCOPE_EXIT({ ResumeOutput(); });
+
+    const FS_Path dir_path = fsMakePath(PATH_ASCII, "/hwtest_bench_dir");
+    if (FSUSER_CreateDirectory(archive, dir_path, 0) != 0) {
+        Log(Common::FormatString("BENCHMARK: [%s] could not create the test directory\n", tag.c_str()));
+        return;
+    }
+    SCOPE_EXIT({ FSUSER_DeleteDirectory(archive, dir_path); });
+
+    std::vector<std::string> names;
+    names.reserve(DIRECTORY_ENTRIES);
+    for (u32 i = 0; i < DIRECTORY_ENTRIES; ++i)
+        names.push_back(Common::FormatString("/hwtest_bench_dir/file%04u.bin", i));
+
+    std::vector<u64> samples;
+    samples.reserve(DIRECTORY_ENTRIES);
+    for (const std::string& name : names) {
+        const u64 start = svcGetSystemTick();
+        FSUSER_CreateFile(archive, fsMakePath(PATH_ASCII, name.c_str()), 0, 0);
+        samples.push_back(BenchmarkElapsed(start, svcGetSystemTick()));
+    }
+    ReportBenchmark(tag, Common::FormatString("FSUSER_CreateFile, %u files in one directory", DIRECTORY_ENTRIES), samples);
+
+    // Every sample lists the whole directory
+    std::unique_ptr<FS_DirectoryEntry[]> entries(new FS_DirectoryEntry[ENTRIES_PER_READ]);
+    u32 listed = 0;
+    const BenchmarkResult result = Benchmark(tag, Common::FormatString("List %u entries", DIRECTORY_ENTRIES), 10, [&] {
+        Handle dir;
+        if (FSUSER_OpenDirectory(&dir, archive, dir_path) != 0)
+            return;
+
+        listed = 0;
+        u32 read = 0;
+        do {
+            if (FSDIR_Read(dir, &read, ENTRIES_PER_READ, entries.get()) != 0)
+                break;
+            listed += read;
+        } while (read == ENTRIES_PER_READ);
+        FSDIR_Close(dir);
+    });
+    if (listed != DIRECTORY_ENTRIES)
+        Log(Common::FormatString("    Listed %u of %u entries\n", listed, DIRECTORY_ENTRIES));
+    if (result.median)
+        Log(Common::FormatString("    %llu entries/s\n", (u64)listed * SYSCLOCK_ARM11 / result.median));
+
+    samples.clear();
+    for (const std::string& name : names) {
+        const u64 start = svcGetSystemTick();
+        FSUSER_DeleteFile(archive, fsMakePath(PATH_ASCII, name.c_str()));
+        samples.push_back(BenchmarkElapsed(start, svcGetSystemTick()));
+    }
+    ReportBenchmark(tag, Common::FormatString("FSUSER_DeleteFile, %u files in one directory", DIRECTORY_ENTRIES), samples);
+}
+
+void BenchmarkAll() {
+    FS_Archive archive;
+    if (FSUSER_OpenArchive(&archive, ARCHIVE_SDMC, fsMakePath(PATH_EMPTY, "")) != 0) {
+        Log(Common::FormatString("BENCHMARK: [%s] could not open the archive\n", tag.c_str()));
+        return;
+    }
+    SCOPE_EXIT({ FSUSER_CloseArchive(archive); });
+
+    BenchmarkFile(archive);
+    BenchmarkDirectory(archive);
+}
+
+} // namespace
+} // namespace
@@ -9,28 +9,6 @@
 namespace GPU {
 namespace DisplayTransfer {
 
-enum PixelFormat {
-    IN_RGBA8  = 0 << 8,
-    IN_RGB8   = 1 << 8,
-    IN_RGB565 = 2 << 8,
-    IN_RGB5A1 = 3 << 8,
-    IN_RGBA4  = 4 << 8,
-    OUT_RGBA8  = 0 << 12,
-    OUT_RGB8   = 1 << 12,
-    OUT_RGB565 = 2 << 12,
-    OUT_RGB5A1 = 3 << 12,
-    OUT_RGBA4  = 4 << 12,
-};
-
-enum Flags {
-    LINEAR_TO_TILED = 1 << 1,
-    RAW_COPY = 1 << 3,
-    NO_SWIZZLE = 1 << 5,
-    UNKNOWN1 = 1 << 16,
-    HORIZONTAL_DOWNSCALE = 1 << 24,
-    DOUBLE_DOWNSCALE = 1 << 25,
-};
-
 union Dimensions {
     struct {
         u16 height;
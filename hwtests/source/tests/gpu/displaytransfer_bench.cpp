@@ -0,0 +1,128 @@
+#include <string.h>
+#include <string>
+#include "output.h"
+#include "common/scope_exit.h"
+#include "common/string_funcs.h"
+#include "tests/benchmark.h"
+#include "tests/gpu/displaytransfer.h"
+
+namespace GPU {
+namespace DisplayTransfer {
+
+static const std::string tag = "DisplayTransfer";
+
+static const u32 ITERATIONS = 20;
+
+struct Format {
+    const char* name;
+    u32 in;
+    u32 out;
+    u32 bytes_per_pixel;
+};
+
+static const Format formats[] = {
+    { "RGBA8", IN_RGBA8, OUT_RGBA8, 4 },
+    { "RGB8", IN_RGB8, OUT_RGB8, 3 },
+    { "RGB565", IN_RGB565, OUT_RGB565, 2 },
+    { "RGB5A1", IN_RGB5A1, OUT_RGB5A1, 2 },
+    { "RGBA4", IN_RGBA4, OUT_RGBA4, 2 },
+};
+
+struct Size {
+    u16 width;
+    u16 height;
+};
+
+// From the fixed cost of a transfer up to a full 400x480 buffer
+static const Size sizes[] = { { 8, 8 }, { 64, 64 }, { 128, 128 }, { 240, 400 }, { 400, 480 } };
+
+static const u32 MAX_BUFFER_SIZE = 400 * 480 * 4;
+
+struct Scaling {
+    const char* name;
+    u32 flags;
+    u16 width_divisor;
+    u16 height_divisor;
+};
+
+static const Scaling scalings[] = {
+    { "", 0, 1, 1 },
+    { ", horizontal downscale", HORIZONTAL_DOWNSCALE, 2, 1 },
+    { ", double downscale", DOUBLE_DOWNSCALE, 2, 2 },
+};
+
+static u32 BufferDimensions(u16 width, u16 height) {
+    return (u32)height << 16 | width;
+}
+
+// The engine only converts to formats no wider than the input. RGB8 to the 16 bit formats is
+// also left out, it freezes the GPU (see TestAll).
+static bool IsSupported(const Format& in, const Format& out) {
+    if (out.bytes_per_pixel > in.bytes_per_pixel)
+        return false;
+    return !(in.in == IN_RGB8 && out.bytes_per_pixel == 2);
+}
+
+static void TimeTransfer(u32* input, u32* output, const Format& in, const Format& out, const Size& size,
+                         bool linear_to_tiled, const Scaling& scaling) {
+    const u32 input_dimensions = BufferDimensions(size.width, size.height);
+    const u32 output_dimensions = BufferDimensions(size.width / scaling.width_divisor, size.height / scaling.height_divisor);
+    const u32 flags = in.in | out.out | scaling.flags | (linear_to_tiled ? LINEAR_TO_TILED : 0);
+
+    const std::string name = Common::FormatString("%s to %s, %s, %ux%u%s", in.name, out.name,
+                                                  linear_to_tiled ? "linear to tiled" : "tiled to linear",
+                                                  size.width, size.height, scaling.name);
+
+    Result res = GX_DisplayTransfer(input, input_dimensions, output, output_dimensions, flags);
+    if ((u32)res != 0) {
+        Log(Common::FormatString("BENCHMARK: [%s] %s: transfer failed: 0x%08X\n", tag.c_str(), name.c_str(), (u32)res));
+        return;
+    }
+    gspWaitForPPF();
+
+    const BenchmarkResult result = Benchmark(tag, name, ITERATIONS, [&] {
+        GX_DisplayTransfer(input, input_dimensions, output, output_dimensions, flags);
+        gspWaitForPPF();
+    });
+
+    if (result.median) {
+        const u64 pixels = (u64)size.width * size.height;
+        const u64 hundredths = pixels * SYSCLOCK_ARM11 / result.median / 10000;
+        Log(Common::FormatString("    %llu.%02llu megapixels/s\n", hundredths / 100, hundredths % 100));
+    }
+}
+
+void BenchmarkAll() {
+    u32* input = (u32*)linearAlloc(MAX_BUFFER_SIZE);
+    u32* output = (u32*)linearAlloc(MAX_BUFFER_SIZE);
+    SCOPE_EXIT({
+        linearFree(input);
+        linearFree(output);
+    });
+
+    memset(input, 0x5A, MAX_BUFFER_SIZE);
+    GSPGPU_FlushDataCache(input, MAX_BUFFER_SIZE);
+
+    for (const Format& in : formats) {
+        for (const Format& out : formats) {
+            if (!IsSupported(in, out))
+                continue;
+
+            for (const Size& size : sizes) {
+                TimeTransfer(input, output, in, out, size, true, scalings[0]);
+                // Downscaling is used when presenting a tiled render target, so only time it that way
+                for (const Scaling& scaling : scalings) {
+                    // Tiled buffers are made of 8x8 tiles, on both sides
+                    if ((size.width / scaling.width_divisor) % 8 || (size.height / scaling.height_divisor) % 8)
+                        continue;
+                    TimeTransfer(input, output, in, out, size, false, scaling);
+                }
+            }
+        }
+    }
+
+    GSPGPU_InvalidateDataCache(output, MAX_BUFFER_SIZE);
+}
+
+}
+}
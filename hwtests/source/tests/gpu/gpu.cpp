@@ -10,4 +10,9 @@ void TestAll() {
     MemoryFills::TestAll();
 }
 
+void BenchmarkAll() {
+    DisplayTransfer::BenchmarkAll();
+    MemoryFills::BenchmarkAll();
+}
+
 }
@@ -3,5 +3,6 @@
 namespace GPU {
 
 void TestAll();
+void BenchmarkAll();
 
 }
\ No newline at end of file
@@ -4,6 +4,7 @@ namespace GPU {
 namespace MemoryFills {
 
 void TestAll();
+void BenchmarkAll();
 
 }
 }
@@ -0,0 +1,95 @@
+#include <string>
+#include "output.h"
+#include "common/scope_exit.h"
+#include "common/string_funcs.h"
+#include "tests/benchmark.h"
+#include "tests/gpu/memoryfills.h"
+
+namespace GPU {
+namespace MemoryFills {
+
+static const std::string tag = "MemoryFills";
+
+static const u32 ITERATIONS = 20;
+
+struct Width {
+    const char* name;
+    u32 control;
+};
+
+// Bit 0 starts the fill, bits 8-9 select the width of the fill value
+static const Width widths[] = {
+    { "16 bit", 0x001 },
+    { "24 bit", 0x101 },
+    { "32 bit", 0x201 },
+};
+
+// Multiples of 48 bytes, so that every width fills whole values. 0x60000 is about one 400x240
+// RGBA8 framebuffer, 0xC0000 two of them.
+static const u32 sizes[] = { 0x600, 0x6000, 0x30000, 0x60000, 0xC0000 };
+
+static const u32 MAX_SIZE = 0xC0000;
+
+static void BenchmarkFill(u8* buffer0, u8* buffer1, const Width& width, u32 size) {
+    const u32 control = width.control;
+    const std::string suffix = Common::FormatString(", %s, 0x%X bytes", width.name, size);
+    BenchmarkResult result;
+
+    result = Benchmark(tag, "PSC0" + suffix, ITERATIONS, [&] {
+        GX_MemoryFill((u32*)buffer0, 0x12345678, (u32*)(buffer0 + size), control, 0, 0, 0, 0);
+        gspWaitForPSC0();
+    });
+    LogBandwidth(size, result);
+
+    result = Benchmark(tag, "PSC1" + suffix, ITERATIONS, [&] {
+        GX_MemoryFill(0, 0, 0, control, (u32*)buffer1, 0x12345678, (u32*)(buffer1 + size), control);
+        gspWaitForPSC1();
+    });
+    LogBandwidth(size, result);
+
+    // Two fills on one engine, one after the other
+    const BenchmarkResult back_to_back = Benchmark(tag, "PSC0 back-to-back x2" + suffix, ITERATIONS, [&] {
+        GX_MemoryFill((u32*)buffer0, 0x12345678, (u32*)(buffer0 + size), control, 0, 0, 0, 0);
+        gspWaitForPSC0();
+        GX_MemoryFill((u32*)buffer1, 0x12345678, (u32*)(buffer1 + size), control, 0, 0, 0, 0);
+        gspWaitForPSC0();
+    });
+    LogBandwidth(size * 2, back_to_back);
+
+    // The same two fills started together on both engines
+    const BenchmarkResult both = Benchmark(tag, "PSC0 + PSC1 together" + suffix, ITERATIONS, [&] {
+        GX_MemoryFill((u32*)buffer0, 0x12345678, (u32*)(buffer0 + size), control,
+                      (u32*)buffer1, 0x12345678, (u32*)(buffer1 + size), control);
+        gspWaitForPSC0();
+        gspWaitForPSC1();
+    });
+    LogBandwidth(size * 2, both);
+
+    // 50% if the engines fully overlap, 100% if they take turns
+    if (back_to_back.median)
+        Log(Common::FormatString("    Both engines take %llu%% of the back-to-back time\n", both.median * 100 / back_to_back.median));
+}
+
+void BenchmarkAll() {
+    u8* buffer0 = (u8*)vramAlloc(MAX_SIZE);
+    u8* buffer1 = (u8*)vramAlloc(MAX_SIZE);
+    SCOPE_EXIT({
+        if (buffer0)
+            vramFree(buffer0);
+        if (buffer1)
+            vramFree(buffer1);
+    });
+
+    if (buffer0 == nullptr || buffer1 == nullptr) {
+        Log(Common::FormatString("BENCHMARK: [%s] could not allocate 2x 0x%X bytes of VRAM\n", tag.c_str(), MAX_SIZE));
+        return;
+    }
+
+    for (const Width& width : widths) {
+        for (u32 size : sizes)
+            BenchmarkFill(buffer0, buffer1, width, size);
+    }
+}
+
+}
+}
@@ -18,19 +18,19 @@ static bool Test_ArbitrateAddress() {
     s32 arbitration_value = 0;
 
     // Test ARBITRATION_WAIT_IF_LESS_THAN, should not wait
-    TestEquals(svcArbitrateAddress(arbiter, (u32)&arbitration_value, ARBITRATION_WAIT_IF_LESS_THAN, 0, 0), 0);
+    TestEquals(svcArbitrateAddress(arbiter, (uintptr_t)&arbitration_value, ARBITRATION_WAIT_IF_LESS_THAN, 0, 0), 0);
     TestEquals(arbitration_value, 0);
 
     // Test ARBITRATION_WAIT_IF_LESS_THAN_TIMEOUT, this one should _not_ wait, however, it still returns a Timeout error
-    TestEquals(svcArbitrateAddress(arbiter, (u32)&arbitration_value, ARBITRATION_WAIT_IF_LESS_THAN_TIMEOUT, 0, 3000000000), ERR_TIMEOUT);
+    TestEquals(svcArbitrateAddress(arbiter, (uintptr_t)&arbitration_value, ARBITRATION_WAIT_IF_LESS_THAN_TIMEOUT, 0, 3000000000), ERR_TIMEOUT);
     TestEquals(arbitration_value, 0);
 
     // Test ARBITRATION_WAIT_IF_LESS_THAN_TIMEOUT, this should wait and return a Timeout error
-    TestEquals(svcArbitrateAddress(arbiter, (u32)&arbitration_value, ARBITRATION_WAIT_IF_LESS_THAN_TIMEOUT, 1, 3000000000), ERR_TIMEOUT);
+    TestEquals(svcArbitrateAddress(arbiter, (uintptr_t)&arbitration_value, ARBITRATION_WAIT_IF_LESS_THAN_TIMEOUT, 1, 3000000000), ERR_TIMEOUT);
     TestEquals(arbitration_value, 0);
 
     // Test ARBITRATION_DECREMENT_AND_WAIT_IF_LESS_THAN_TIMEOUT, this one should wait and return a Timeout error
-    TestEquals(svcArbitrateAddress(arbiter, (u32)&arbitration_value, ARBITRATION_DECREMENT_AND_WAIT_IF_LESS_THAN_TIMEOUT, 1, 3000000000), ERR_TIMEOUT);
+    TestEquals(svcArbitrateAddress(arbiter, (uintptr_t)&arbitration_value, ARBITRATION_DECREMENT_AND_WAIT_IF_LESS_THAN_TIMEOUT, 1, 3000000000), ERR_TIMEOUT);
     // The value must be modified if the thread was put to sleep
     TestEquals(arbitration_value, -1);
 
@@ -38,7 +38,7 @@ static bool Test_ArbitrateAddress() {
     arbitration_value = 0;
 
     // Test ARBITRATION_DECREMENT_AND_WAIT_IF_LESS_THAN, this one should not wait and return RESULT_SUCCESS
-    TestEquals(svcArbitrateAddress(arbiter, (u32)&arbitration_value, ARBITRATION_DECREMENT_AND_WAIT_IF_LESS_THAN, 0, 0), 0);
+    TestEquals(svcArbitrateAddress(arbiter, (uintptr_t)&arbitration_value, ARBITRATION_DECREMENT_AND_WAIT_IF_LESS_THAN, 0, 0), 0);
     // The value must not be modified if the thread was not put to sleep
     TestEquals(arbitration_value, 0);
 
@@ -0,0 +1,342 @@
+#include <string>
+#include <vector>
+#include <3ds.h>
+
+#include "output.h"
+#include "common/scope_exit.h"
+#include "common/string_funcs.h"
+#include "tests/benchmark.h"
+
+namespace Kernel {
+namespace AddressArbiter {
+
+static const std::string group = "Kernel::AddressArbiter";
+
+static const u32 ITERATIONS = 1000;
+static const u32 CONTENDED_ITERATIONS = 100;
+static const u32 WAKE_ITERATIONS = 100;
+
+static const s32 MAX_THREADS = 8;
+static const s32 WAKE_QUEUE_SIZE = WAKE_ITERATIONS * MAX_THREADS + MAX_THREADS;
+
+static Handle arbiter;
+
+static u32 thread_stacks[MAX_THREADS][0x400];
+
+static volatile u64 signal_tick;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Userland synchronization built on svcArbitrateAddress
+
+static s32 CompareExchange(volatile s32* value, s32 expected, s32 desired) {
+    __atomic_compare_exchange_n(value, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    return expected;
+}
+
+static s32 Exchange(volatile s32* value, s32 desired) {
+    return __atomic_exchange_n(value, desired, __ATOMIC_SEQ_CST);
+}
+
+static s32 FetchAdd(volatile s32* value, s32 add) {
+    return __atomic_fetch_add(value, add, __ATOMIC_SEQ_CST);
+}
+
+static void WaitIfLessThan(volatile s32* address, s32 value) {
+    svcArbitrateAddress(arbiter, (uintptr_t)address, ARBITRATION_WAIT_IF_LESS_THAN, value, 0);
+}
+
+// Sleeps unless *address >= value, decrementing *address if it does
+static void DecrementAndWaitIfLessThan(volatile s32* address, s32 value) {
+    svcArbitrateAddress(arbiter, (uintptr_t)address, ARBITRATION_DECREMENT_AND_WAIT_IF_LESS_THAN, value, 0);
+}
+
+// Wakes up to `count` threads waiting on `address`, or all of them if count is -1
+static void Wake(volatile s32* address, s32 count) {
+    svcArbitrateAddress(arbiter, (uintptr_t)address, ARBITRATION_SIGNAL, count, 0);
+}
+
+// 0: unlocked, -1: locked, -2: locked and possibly contended. The states are negative so that
+// waiters can sleep with ARBITRATION_WAIT_IF_LESS_THAN.
+struct Mutex {
+    volatile s32 state;
+};
+
+static void Lock(Mutex& mutex) {
+    s32 state = CompareExchange(&mutex.state, 0, -1);
+    if (state == 0)
+        return;
+
+    if (state != -2)
+        state = Exchange(&mutex.state, -2);
+    while (state != 0) {
+        WaitIfLessThan(&mutex.state, -1);
+        state = Exchange(&mutex.state, -2);
+    }
+}
+
+static void Unlock(Mutex& mutex) {
+    if (FetchAdd(&mutex.state, 1) != -1) {
+        mutex.state = 0;
+        Wake(&mutex.state, 1);
+    }
+}
+
+struct CondVar {
+    volatile s32 sequence;
+};
+
+static void Wait(CondVar& cond, Mutex& mutex) {
+    const s32 sequence = cond.sequence;
+    Unlock(mutex);
+    // Sleeps unless Signal() has been called since sequence was read
+    WaitIfLessThan(&cond.sequence, sequence + 1);
+    Lock(mutex);
+}
+
+static void Signal(CondVar& cond, s32 count) {
+    FetchAdd(&cond.sequence, 1);
+    Wake(&cond.sequence, count);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Handoff: a 0x2F thread blocks on a mutex or condition variable owned by the main thread, and
+// records how long it took to get it once the main thread lets go
+
+static Mutex handoff_mutex;
+static CondVar handoff_cond;
+static volatile s32 handoff_round;
+static std::vector<u64> handoff_samples;
+
+static void mutex_handoff_handler(void*) {
+    for (s32 round = 1; round <= (s32)ITERATIONS; ++round) {
+        while (handoff_round < round)
+            WaitIfLessThan(&handoff_round, round);
+
+        // Blocks, the main thread holds the mutex
+        Lock(handoff_mutex);
+        handoff_samples.push_back(BenchmarkElapsed(signal_tick, svcGetSystemTick()));
+        Unlock(handoff_mutex);
+    }
+    svcExitThread();
+}
+
+static void cond_handoff_handler(void*) {
+    Lock(handoff_mutex);
+    for (s32 round = 1; round <= (s32)ITERATIONS; ++round) {
+        while (handoff_round < round)
+            Wait(handoff_cond, handoff_mutex);
+        handoff_samples.push_back(BenchmarkElapsed(signal_tick, svcGetSystemTick()));
+    }
+    Unlock(handoff_mutex);
+    svcExitThread();
+}
+
+static void MutexHandoff() {
+    PauseOutput();
+    SCOPE_EXIT({ ResumeOutput(); });
+
+    handoff_mutex.state = 0;
+    handoff_round = 0;
+    handoff_samples.clear();
+    handoff_samples.reserve(ITERATIONS);
+
+    Handle thread;
+    svcCreateThread(&thread, mutex_handoff_handler, 0x0, (u32*)(&thread_stacks[0][0x400]), 0x2F, 0xfffffffe);
+
+    for (s32 round = 1; round <= (s32)ITERATIONS; ++round) {
+        Lock(handoff_mutex);
+        handoff_round = round;
+        Wake(&handoff_round, 1);
+
+        signal_tick = svcGetSystemTick();
+        Unlock(handoff_mutex);
+    }
+
+    svcWaitSynchronization(thread, U64_MAX);
+    svcCloseHandle(thread);
+    ReportBenchmark(group, "Mutex handoff to 0x2F", handoff_samples);
+}
+
+static void CondHandoff() {
+    PauseOutput();
+    SCOPE_EXIT({ ResumeOutput(); });
+
+    handoff_mutex.state = 0;
+    handoff_cond.sequence = 0;
+    handoff_round = 0;
+    handoff_samples.clear();
+    handoff_samples.reserve(ITERATIONS);
+
+    Handle thread;
+    svcCreateThread(&thread, cond_handoff_handler, 0x0, (u32*)(&thread_stacks[0][0x400]), 0x2F, 0xfffffffe);
+
+    for (s32 round = 1; round <= (s32)ITERATIONS; ++round) {
+        Lock(handoff_mutex);
+        handoff_round = round;
+        Unlock(handoff_mutex);
+
+        signal_tick = svcGetSystemTick();
+        Signal(handoff_cond, 1);
+    }
+
+    svcWaitSynchronization(thread, U64_MAX);
+    svcCloseHandle(thread);
+    ReportBenchmark(group, "CondVar signal to 0x2F", handoff_samples);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Contention: threads of the same priority take the mutex and yield while holding it, so that
+// the others find it locked
+
+static Mutex contended_mutex;
+static u64 contended_samples[MAX_THREADS][CONTENDED_ITERATIONS];
+
+static void contender_handler(void* arg) {
+    const u32 index = (u32)(uintptr_t)arg;
+    for (u32 i = 0; i < CONTENDED_ITERATIONS; ++i) {
+        const u64 start = svcGetSystemTick();
+        Lock(contended_mutex);
+        contended_samples[index][i] = BenchmarkElapsed(start, svcGetSystemTick());
+        svcSleepThread(0);
+        Unlock(contended_mutex);
+    }
+    svcExitThread();
+}
+
+static void Contention(s32 thread_count) {
+    PauseOutput();
+    SCOPE_EXIT({ ResumeOutput(); });
+
+    contended_mutex.state = 0;
+
+    Handle threads[MAX_THREADS];
+    for (s32 i = 0; i < thread_count; ++i)
+        svcCreateThread(&threads[i], contender_handler, (u32)i, (u32*)(&thread_stacks[i][0x400]), 0x31, 0xfffffffe);
+
+    std::vector<u64> samples;
+    samples.reserve(thread_count * CONTENDED_ITERATIONS);
+    for (s32 i = 0; i < thread_count; ++i) {
+        svcWaitSynchronization(threads[i], U64_MAX);
+        svcCloseHandle(threads[i]);
+        samples.insert(samples.end(), contended_samples[i], contended_samples[i] + CONTENDED_ITERATIONS);
+    }
+
+    ReportBenchmark(group, Common::FormatString("Mutex lock, %d threads contending", thread_count), samples);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Wake-N: threads sleep on a gate with decrement-and-wait and are woken one or all at a time.
+// The order they went to sleep in is recorded, to check whether they are woken in that order.
+
+static volatile s32 gate;
+static volatile bool gate_closed;
+
+static volatile s32 sleep_order[WAKE_QUEUE_SIZE];
+static volatile s32 sleep_count;
+static volatile s32 wake_order[WAKE_QUEUE_SIZE];
+static volatile u64 wake_ticks[WAKE_QUEUE_SIZE];
+static volatile s32 wake_count;
+
+static void sleeper_handler(void* arg) {
+    const s32 index = (s32)(uintptr_t)arg;
+    while (true) {
+        sleep_order[FetchAdd(&sleep_count, 1)] = index;
+        DecrementAndWaitIfLessThan(&gate, 1);
+        if (gate_closed)
+            break;
+
+        const s32 wake = FetchAdd(&wake_count, 1);
+        wake_ticks[wake] = svcGetSystemTick();
+        wake_order[wake] = index;
+    }
+    svcExitThread();
+}
+
+static void WakeN(s32 thread_count, bool wake_all) {
+    PauseOutput();
+    SCOPE_EXIT({ ResumeOutput(); });
+
+    gate = 0;
+    gate_closed = false;
+    sleep_count = 0;
+    wake_count = 0;
+
+    // All above the main thread, so that they are asleep again by the time it runs
+    Handle threads[MAX_THREADS];
+    for (s32 i = 0; i < thread_count; ++i)
+        svcCreateThread(&threads[i], sleeper_handler, (u32)i, (u32*)(&thread_stacks[i][0x400]), 0x2F, 0xfffffffe);
+
+    std::vector<u64> first_samples;
+    std::vector<u64> last_samples;
+    first_samples.reserve(WAKE_ITERATIONS);
+    last_samples.reserve(WAKE_ITERATIONS);
+
+    for (u32 i = 0; i < WAKE_ITERATIONS; ++i) {
+        const s32 first = wake_count;
+        gate = 0;
+        signal_tick = svcGetSystemTick();
+        Wake(&gate, wake_all ? -1 : 1);
+
+        const s32 last = wake_count - 1;
+        if (last < first)
+            continue;
+        first_samples.push_back(BenchmarkElapsed(signal_tick, wake_ticks[first]));
+        last_samples.push_back(BenchmarkElapsed(signal_tick, wake_ticks[last]));
+    }
+
+    gate_closed = true;
+    gate = 1;
+    Wake(&gate, -1);
+    for (s32 i = 0; i < thread_count; ++i) {
+        svcWaitSynchronization(threads[i], U64_MAX);
+        svcCloseHandle(threads[i]);
+    }
+
+    const char* mode = wake_all ? "all" : "one";
+    ReportBenchmark(group, Common::FormatString("Wake %s of %d, first", mode, thread_count), first_samples);
+    if (wake_all)
+        ReportBenchmark(group, Common::FormatString("Wake %s of %d, last", mode, thread_count), last_samples);
+
+    // Every wake consumes the oldest sleep if waiters are woken first in, first out
+    s32 in_order = 0;
+    for (s32 i = 0; i < wake_count; ++i) {
+        if (wake_order[i] == sleep_order[i])
+            in_order++;
+    }
+    Log(Common::FormatString("    %d of %d wakes in the order the threads went to sleep\n", in_order, wake_count));
+}
+
+void BenchmarkAll() {
+    if (svcCreateAddressArbiter(&arbiter) != 0) {
+        Log(Common::FormatString("BENCHMARK: [%s] could not create an address arbiter\n", group.c_str()));
+        return;
+    }
+    SCOPE_EXIT({ svcCloseHandle(arbiter); });
+
+    s32 value = 0;
+    Benchmark(group, "Signal, no waiters", ITERATIONS, [&] { Wake(&value, 1); });
+    Benchmark(group, "Wait if less than, not waiting", ITERATIONS, [&] { WaitIfLessThan(&value, 0); });
+
+    Mutex mutex = { 0 };
+    Benchmark(group, "Mutex lock + unlock, uncontended", ITERATIONS, [&] {
+        Lock(mutex);
+        Unlock(mutex);
+    });
+
+    CondVar cond = { 0 };
+    Benchmark(group, "CondVar signal, no waiters", ITERATIONS, [&] { Signal(cond, 1); });
+
+    MutexHandoff();
+    CondHandoff();
+
+    for (s32 count = 2; count <= MAX_THREADS; count *= 2)
+        Contention(count);
+
+    for (s32 count = 1; count <= MAX_THREADS; count *= 2) {
+        WakeN(count, false);
+        WakeN(count, true);
+    }
+}
+
+} // namespace
+} // namespace
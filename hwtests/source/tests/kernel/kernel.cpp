@@ -2,9 +2,7 @@
 
 namespace Kernel {
 
-namespace Ports { void TestAll(); }
-namespace WaitSynch { void TestAll(); }
-namespace AddressArbiter { void TestAll(); }
+namespace Ports { void TestAll(); void BenchmarkAll(); }
 
 void TestAll() {
     Ports::TestAll();
@@ -12,4 +10,10 @@ void TestAll() {
     AddressArbiter::TestAll();
 }
 
+void BenchmarkAll() {
+    Ports::BenchmarkAll();
+    WaitSynch::BenchmarkAll();
+    AddressArbiter::BenchmarkAll();
+}
+
 } // namespace
@@ -2,4 +2,9 @@
 
 namespace Kernel {
     void TestAll();
+    void BenchmarkAll();
+
+    // The host build runs these on their own, as the others need ARM code
+    namespace WaitSynch { void TestAll(); void BenchmarkAll(); }
+    namespace AddressArbiter { void TestAll(); void BenchmarkAll(); }
 }
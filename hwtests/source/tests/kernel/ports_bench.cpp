@@ -0,0 +1,174 @@
+#include <string>
+#include <3ds.h>
+
+#include "output.h"
+#include "common/scope_exit.h"
+#include "common/string_funcs.h"
+#include "tests/benchmark.h"
+
+namespace Kernel {
+namespace Ports {
+
+static const std::string group = "Kernel::Ports";
+
+static const u32 ITERATIONS = 1000;
+static const u32 CONNECT_ITERATIONS = 100;
+static const u32 BATCH_SIZE = 100;
+static const u32 BATCHES = 20;
+
+static const Result ERR_SESSION_CLOSED = 0xC920181A;
+
+static const u32 MAX_STATIC_SIZE = 0x1000;
+
+static Handle server_port;
+static u32 server_stack[0x400];
+static u32 receive_buffer[MAX_STATIC_SIZE / sizeof(u32)];
+static u32 send_buffer[MAX_STATIC_SIZE / sizeof(u32)];
+
+// Serves one session on server_port, replying to every request with a success result, until the
+// client closes it
+static void server_handler(void*) {
+    u32* cmdbuf = getThreadCommandBuffer();
+    u32* staticbufs = getThreadStaticBuffers();
+    staticbufs[0] = IPC_Desc_StaticBuffer(sizeof(receive_buffer), 0);
+    staticbufs[1] = (u32)receive_buffer;
+
+    Handle handles[2] = { server_port, 0 };
+    s32 count = 1;
+    Handle reply_target = 0;
+
+    while (true) {
+        s32 index = -1;
+        const Result res = svcReplyAndReceive(&index, handles, count, reply_target);
+        if (res == ERR_SESSION_CLOSED || (u32)res >> 31)
+            break;
+
+        if (index == 0) {
+            svcAcceptSession(&handles[1], server_port);
+            count = 2;
+            reply_target = 0;
+            continue;
+        }
+
+        cmdbuf[0] = IPC_MakeHeader(cmdbuf[0] >> 16, 1, 0);
+        cmdbuf[1] = 0;
+        reply_target = handles[1];
+    }
+
+    if (handles[1])
+        svcCloseHandle(handles[1]);
+    svcExitThread();
+}
+
+// Sends a request with `normal_words` parameters and, if `static_size` is not 0, that many bytes
+// through static buffer 0
+static Result SendRequest(Handle session, u32 normal_words, u32 static_size) {
+    u32* cmdbuf = getThreadCommandBuffer();
+    cmdbuf[0] = IPC_MakeHeader(1, normal_words, static_size ? 2 : 0);
+    for (u32 i = 1; i <= normal_words; ++i)
+        cmdbuf[i] = i;
+    if (static_size) {
+        cmdbuf[normal_words + 1] = IPC_Desc_StaticBuffer(static_size, 0);
+        cmdbuf[normal_words + 2] = (u32)send_buffer;
+    }
+
+    const Result res = svcSendSyncRequest(session);
+    return res ? res : cmdbuf[1];
+}
+
+// Times single requests, then batches of them to get requests per second
+static void RoundTrip(const std::string& name, Handle session, u32 normal_words, u32 static_size) {
+    const Result res = SendRequest(session, normal_words, static_size);
+    if (res != 0) {
+        Log(Common::FormatString("BENCHMARK: [%s] %s: request failed: 0x%08X\n", group.c_str(), name.c_str(), (u32)res));
+        return;
+    }
+
+    Benchmark(group, name, ITERATIONS, [&] { SendRequest(session, normal_words, static_size); });
+
+    const BenchmarkResult batch = Benchmark(group, Common::FormatString("%s, x%u", name.c_str(), BATCH_SIZE), BATCHES, [&] {
+        for (u32 i = 0; i < BATCH_SIZE; ++i)
+            SendRequest(session, normal_words, static_size);
+    });
+    if (batch.median)
+        Log(Common::FormatString("    %llu requests/s\n", (u64)BATCH_SIZE * SYSCLOCK_ARM11 / batch.median));
+}
+
+// srv:RegisterClient, which only asks the kernel for the calling process ID
+static Result RegisterClient(Handle srv) {
+    u32* cmdbuf = getThreadCommandBuffer();
+    cmdbuf[0] = IPC_MakeHeader(0x1, 0, 2);
+    cmdbuf[1] = IPC_Desc_CurProcessHandle();
+
+    const Result res = svcSendSyncRequest(srv);
+    return res ? res : cmdbuf[1];
+}
+
+static void BenchmarkSrv() {
+    Benchmark(group, "ConnectToPort srv: + CloseHandle", CONNECT_ITERATIONS, [] {
+        Handle handle;
+        svcConnectToPort(&handle, "srv:");
+        svcCloseHandle(handle);
+    });
+
+    Handle srv;
+    if (svcConnectToPort(&srv, "srv:") != 0) {
+        Log(Common::FormatString("BENCHMARK: [%s] could not connect to srv:\n", group.c_str()));
+        return;
+    }
+    SCOPE_EXIT({ svcCloseHandle(srv); });
+
+    const Result res = RegisterClient(srv);
+    if (res != 0) {
+        Log(Common::FormatString("BENCHMARK: [%s] srv:RegisterClient failed: 0x%08X\n", group.c_str(), (u32)res));
+        return;
+    }
+
+    Benchmark(group, "srv:RegisterClient", ITERATIONS, [&] { RegisterClient(srv); });
+    const BenchmarkResult batch = Benchmark(group, Common::FormatString("srv:RegisterClient, x%u", BATCH_SIZE), BATCHES, [&] {
+        for (u32 i = 0; i < BATCH_SIZE; ++i)
+            RegisterClient(srv);
+    });
+    if (batch.median)
+        Log(Common::FormatString("    %llu requests/s\n", (u64)BATCH_SIZE * SYSCLOCK_ARM11 / batch.median));
+}
+
+static void BenchmarkOwnPort() {
+    Handle client_port;
+    if (svcCreatePort(&server_port, &client_port, nullptr, 1) != 0) {
+        Log(Common::FormatString("BENCHMARK: [%s] could not create a port\n", group.c_str()));
+        return;
+    }
+    SCOPE_EXIT({
+        svcCloseHandle(client_port);
+        svcCloseHandle(server_port);
+    });
+
+    // Above the main thread, so that requests are served as soon as they are sent
+    Handle server;
+    svcCreateThread(&server, server_handler, 0x0, (u32*)(&server_stack[0x400]), 0x2F, 0xfffffffe);
+    SCOPE_EXIT({
+        svcWaitSynchronization(server, U64_MAX);
+        svcCloseHandle(server);
+    });
+
+    Handle session;
+    svcCreateSessionToPort(&session, client_port);
+    SCOPE_EXIT({ svcCloseHandle(session); });
+
+    const u32 normal_words[] = { 0, 8, 32, 61 };
+    for (u32 words : normal_words)
+        RoundTrip(Common::FormatString("Own port, %u words", words), session, words, 0);
+
+    const u32 static_sizes[] = { 0x40, 0x400, MAX_STATIC_SIZE };
+    for (u32 size : static_sizes)
+        RoundTrip(Common::FormatString("Own port, static buffer 0x%X bytes", size), session, 0, size);
+}
+
+void BenchmarkAll() {
+    BenchmarkSrv();
+    BenchmarkOwnPort();
+}
+
+} // namespace
+} // namespace
@@ -724,6 +724,8 @@ bool Test_WaitSynchN_22() {
     return true;
 }
 
+// The host build has no services
+#ifndef HWTESTS_HOST
 // Call WaitSynchN with a service handle
 
 bool Test_WaitSynchN_23() {
@@ -742,6 +744,7 @@ bool Test_WaitSynchN_23() {
 
     return true;
 }
+#endif
 
 // WaitSynchN with an invalid handle passed in, nothing should wait
 
@@ -851,6 +854,7 @@ bool Test_WaitSynch1_02() {
     return true;
 }
 
+#ifndef HWTESTS_HOST
 // Test WaitSynch1 with a service handle
 
 bool Test_WaitSynch1_03() {
@@ -865,6 +869,7 @@ bool Test_WaitSynch1_03() {
 
     return true;
 }
+#endif
 
 // WaitSynch1; unlocked mutex0,  Make sure mutex0 locks
 
@@ -983,6 +988,9 @@ bool Test_WaitSynch1_07() {
     return true;
 }
 
+// The host build has no services or shared memory, and the last test creates its address arbiter
+// with ARM code
+#ifndef HWTESTS_HOST
 // Test WaitSynch with all Kernel Object types
 
 bool Test_WaitSynch_KernelType_SharedMem() {
@@ -1075,6 +1083,7 @@ bool Test_WaitSynch_KernelType_AddressArbiter() {
 
     return true;
 }
+#endif
 
 void TestAll() {
     svcCreateEvent(&events[0], RESET_STICKY);
@@ -1110,20 +1119,26 @@ void TestAll() {
     Test("Test_WaitSynchN_20", "Test_WaitSynchN_20", Test_WaitSynchN_20(), true);
     Test("Test_WaitSynchN_21", "Test_WaitSynchN_21", Test_WaitSynchN_21(), true);
     Test("Test_WaitSynchN_22", "Test_WaitSynchN_22", Test_WaitSynchN_22(), true);
+#ifndef HWTESTS_HOST
     Test("Test_WaitSynchN_23", "Test_WaitSynchN_23", Test_WaitSynchN_23(), true);
+#endif
     Test("Test_WaitSynchN_24", "Test_WaitSynchN_24", Test_WaitSynchN_24(), true);
     Test("Test_WaitSynchN_25", "Test_WaitSynchN_25", Test_WaitSynchN_25(), true);
     Test("Test_WaitSynch1_00", "Test_WaitSynch1_00", Test_WaitSynch1_00(), true);
     Test("Test_WaitSynch1_01", "Test_WaitSynch1_01", Test_WaitSynch1_01(), true);
     Test("Test_WaitSynch1_02", "Test_WaitSynch1_02", Test_WaitSynch1_02(), true);
+#ifndef HWTESTS_HOST
     Test("Test_WaitSynch1_03", "Test_WaitSynch1_03", Test_WaitSynch1_03(), true);
+#endif
     Test("Test_WaitSynch1_04", "Test_WaitSynch1_04", Test_WaitSynch1_04(), true);
     Test("Test_WaitSynch1_05", "Test_WaitSynch1_05", Test_WaitSynch1_05(), true);
     Test("Test_WaitSynch1_06", "Test_WaitSynch1_06", Test_WaitSynch1_06(), true);
     Test("Test_WaitSynch1_07", "Test_WaitSynch1_07", Test_WaitSynch1_07(), true);
+#ifndef HWTESTS_HOST
     Test("Test_WaitSynch_KernelType_Session", "Test_WaitSynch_KernelType_Session", Test_WaitSynch_KernelType_Session(), true);
     Test("Test_WaitSynch_KernelType_SharedMem", "Test_WaitSynch_KernelType_SharedMem", Test_WaitSynch_KernelType_SharedMem(), true);
     Test("Test_WaitSynch_KernelType_AddressArbiter", "Test_WaitSynch_KernelType_AddressArbiter", Test_WaitSynch_KernelType_AddressArbiter(), true);
+#endif
 
     svcCloseHandle(events[0]);
     svcCloseHandle(events[1]);
@@ -0,0 +1,277 @@
+#include <string>
+#include <vector>
+#include <3ds.h>
+
+#include "output.h"
+#include "common/scope_exit.h"
+#include "common/string_funcs.h"
+#include "tests/benchmark.h"
+
+namespace Kernel {
+namespace WaitSynch {
+
+static const std::string group = "Kernel::WaitSynch";
+
+static const u32 ITERATIONS = 1000;
+static const u32 INVERSION_ITERATIONS = 20;
+static const u32 TIMEOUT_ITERATIONS = 100;
+
+static const s32 MAX_HANDLES = 64;
+
+// How long the main thread sleeps so that a waiter of any priority can block before it is signaled
+static const s64 SETTLE_NS = 100000;
+
+// How long the low priority thread holds the mutex, and how long the medium priority one runs
+static const u64 HOLD_TICKS = SYSCLOCK_ARM11 / 10000;
+static const u64 SPIN_TICKS = SYSCLOCK_ARM11 / 1000;
+
+static u32 waiter_stack[0x400];
+static u32 holder_stack[0x400];
+static u32 contender_stack[0x400];
+static u32 spinner_stack[0x400];
+
+// Set by the signaling thread right before it signals
+static volatile u64 signal_tick;
+
+static void Spin(u64 ticks) {
+    const u64 start = svcGetSystemTick();
+    while (svcGetSystemTick() - start < ticks) {
+    }
+}
+
+static Result SignalEvent(Handle event) {
+    return svcSignalEvent(event);
+}
+
+static Result ReleaseSemaphore(Handle semaphore) {
+    s32 count;
+    return svcReleaseSemaphore(&count, semaphore, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Signal-to-wake latency
+
+struct Waiter {
+    const Handle* handles;
+    s32 count;
+    bool wait_all;
+    Handle ready;
+    std::vector<u64> samples;
+};
+
+static void waiter_handler(void* arg) {
+    Waiter& waiter = *static_cast<Waiter*>(arg);
+    for (u32 i = 0; i < ITERATIONS; ++i) {
+        s32 output;
+        svcSignalEvent(waiter.ready);
+        svcWaitSynchronizationN(&output, waiter.handles, waiter.count, waiter.wait_all, U64_MAX);
+        waiter.samples.push_back(BenchmarkElapsed(signal_tick, svcGetSystemTick()));
+    }
+    svcExitThread();
+}
+
+// Times from signaling the last of `count` handles until a thread at `priority` waiting on them
+// returns. The waiter is always blocked by the time it is signaled: it signals `ready` right before
+// it waits, and the main thread then sleeps, which lets a waiter below its priority get there too.
+// Such waiters only run once the main thread blocks again, so their numbers include that switch.
+static void WakeLatency(const std::string& name, const Handle* handles, s32 count, bool wait_all,
+                        s32 priority, Result (*signal)(Handle)) {
+    PauseOutput();
+    SCOPE_EXIT({ ResumeOutput(); });
+
+    Waiter waiter;
+    waiter.handles = handles;
+    waiter.count = count;
+    waiter.wait_all = wait_all;
+    waiter.samples.reserve(ITERATIONS);
+    svcCreateEvent(&waiter.ready, RESET_ONESHOT);
+    SCOPE_EXIT({ svcCloseHandle(waiter.ready); });
+
+    Handle thread;
+    svcCreateThread(&thread, waiter_handler, (u32)&waiter, (u32*)(&waiter_stack[0x400]), priority, 0xfffffffe);
+    SCOPE_EXIT({ svcCloseHandle(thread); });
+
+    for (u32 i = 0; i < ITERATIONS; ++i) {
+        svcWaitSynchronization(waiter.ready, U64_MAX);
+        svcSleepThread(SETTLE_NS);
+
+        // With wait_all, only the last signal can wake the waiter
+        if (wait_all) {
+            for (s32 j = 0; j < count - 1; ++j)
+                signal(handles[j]);
+        }
+        signal_tick = svcGetSystemTick();
+        signal(handles[count - 1]);
+    }
+
+    svcWaitSynchronization(thread, U64_MAX);
+    ReportBenchmark(group, name, waiter.samples);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Priority inversion: a 0x2F thread waits on a mutex held by a 0x32 thread, optionally while a
+// 0x31 thread is ready to run. Without priority inheritance, the 0x31 thread delays the handoff.
+
+static Handle inversion_mutex;
+static Handle holder_locked;
+static Handle holder_release;
+static volatile u64 acquired_tick;
+
+static void holder_handler(void*) {
+    svcWaitSynchronization(inversion_mutex, U64_MAX);
+    svcSignalEvent(holder_locked);
+    svcWaitSynchronization(holder_release, U64_MAX);
+    Spin(HOLD_TICKS);
+    svcReleaseMutex(inversion_mutex);
+    svcExitThread();
+}
+
+static void contender_handler(void*) {
+    svcWaitSynchronization(inversion_mutex, U64_MAX);
+    acquired_tick = svcGetSystemTick();
+    svcReleaseMutex(inversion_mutex);
+    svcExitThread();
+}
+
+static void spinner_handler(void*) {
+    Spin(SPIN_TICKS);
+    svcExitThread();
+}
+
+static void PriorityInversion(bool with_spinner) {
+    PauseOutput();
+    SCOPE_EXIT({ ResumeOutput(); });
+
+    std::vector<u64> samples;
+    samples.reserve(INVERSION_ITERATIONS);
+
+    for (u32 i = 0; i < INVERSION_ITERATIONS; ++i) {
+        Handle holder, contender, spinner = 0;
+
+        svcCreateThread(&holder, holder_handler, 0x0, (u32*)(&holder_stack[0x400]), 0x32, 0xfffffffe);
+        svcWaitSynchronization(holder_locked, U64_MAX);
+
+        // Runs right away and blocks on the mutex
+        svcCreateThread(&contender, contender_handler, 0x0, (u32*)(&contender_stack[0x400]), 0x2F, 0xfffffffe);
+        if (with_spinner)
+            svcCreateThread(&spinner, spinner_handler, 0x0, (u32*)(&spinner_stack[0x400]), 0x31, 0xfffffffe);
+
+        signal_tick = svcGetSystemTick();
+        svcSignalEvent(holder_release);
+        svcWaitSynchronization(contender, U64_MAX);
+        samples.push_back(BenchmarkElapsed(signal_tick, acquired_tick));
+
+        svcWaitSynchronization(holder, U64_MAX);
+        svcCloseHandle(holder);
+        svcCloseHandle(contender);
+        if (with_spinner) {
+            svcWaitSynchronization(spinner, U64_MAX);
+            svcCloseHandle(spinner);
+        }
+    }
+
+    ReportBenchmark(group, with_spinner ? "Mutex handoff 0x32 -> 0x2F, 0x31 ready" : "Mutex handoff 0x32 -> 0x2F", samples);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Timeout accuracy
+
+static void TimeoutAccuracy(Handle event, s64 timeout) {
+    PauseOutput();
+    SCOPE_EXIT({ ResumeOutput(); });
+
+    const u64 expected = (u64)timeout * SYSCLOCK_ARM11 / 1000000000;
+    std::vector<u64> samples;
+    samples.reserve(TIMEOUT_ITERATIONS);
+
+    u32 early = 0;
+    for (u32 i = 0; i < TIMEOUT_ITERATIONS; ++i) {
+        const u64 start = svcGetSystemTick();
+        svcWaitSynchronization(event, timeout);
+        const u64 elapsed = BenchmarkElapsed(start, svcGetSystemTick());
+        if (elapsed < expected)
+            early++;
+        samples.push_back(elapsed > expected ? elapsed - expected : 0);
+    }
+
+    ReportBenchmark(group, Common::FormatString("Timeout overshoot, %lld us", timeout / 1000), samples);
+    if (early)
+        Log(Common::FormatString("    %u of %u waits returned early\n", early, TIMEOUT_ITERATIONS));
+}
+
+void BenchmarkAll() {
+    s32 priority = 0;
+    svcGetThreadPriority(&priority, CUR_THREAD_HANDLE);
+    Log(Common::FormatString("Main thread priority: 0x%X\n", priority));
+
+    Handle sticky[MAX_HANDLES];
+    Handle oneshot[MAX_HANDLES];
+    for (s32 i = 0; i < MAX_HANDLES; ++i) {
+        svcCreateEvent(&sticky[i], RESET_STICKY);
+        svcCreateEvent(&oneshot[i], RESET_ONESHOT);
+    }
+    SCOPE_EXIT({
+        for (s32 i = 0; i < MAX_HANDLES; ++i) {
+            svcCloseHandle(sticky[i]);
+            svcCloseHandle(oneshot[i]);
+        }
+    });
+
+    Handle semaphore;
+    svcCreateSemaphore(&semaphore, 0, 1);
+    SCOPE_EXIT({ svcCloseHandle(semaphore); });
+
+    Benchmark(group, "SignalEvent, no waiter", ITERATIONS, [&] { svcSignalEvent(sticky[0]); });
+    Benchmark(group, "ClearEvent", ITERATIONS, [&] { svcClearEvent(sticky[0]); });
+
+    // Cost of waits that are already satisfied. For wait-any only the last handle is signaled, so
+    // the kernel has to look at all of them.
+    for (s32 count = 1; count <= MAX_HANDLES; count *= 2) {
+        for (s32 i = 0; i < MAX_HANDLES; ++i)
+            svcClearEvent(sticky[i]);
+        svcSignalEvent(sticky[count - 1]);
+        Benchmark(group, Common::FormatString("WaitSynchN any, %d handles, signaled", count), ITERATIONS, [&] {
+            s32 output;
+            svcWaitSynchronizationN(&output, sticky, count, false, 0);
+        });
+
+        for (s32 i = 0; i < count; ++i)
+            svcSignalEvent(sticky[i]);
+        Benchmark(group, Common::FormatString("WaitSynchN all, %d handles, signaled", count), ITERATIONS, [&] {
+            s32 output;
+            svcWaitSynchronizationN(&output, sticky, count, true, 0);
+        });
+    }
+
+    for (s32 waiter_priority = 0x2F; waiter_priority <= 0x32; ++waiter_priority) {
+        WakeLatency(Common::FormatString("Event wake, waiter 0x%X", waiter_priority),
+                    oneshot, 1, false, waiter_priority, SignalEvent);
+    }
+    WakeLatency("Semaphore wake, waiter 0x2F", &semaphore, 1, false, 0x2F, ReleaseSemaphore);
+
+    for (s32 count = 1; count <= MAX_HANDLES; count *= 2) {
+        WakeLatency(Common::FormatString("WaitSynchN any wake, %d handles", count),
+                    oneshot, count, false, 0x2F, SignalEvent);
+        WakeLatency(Common::FormatString("WaitSynchN all wake, %d handles", count),
+                    oneshot, count, true, 0x2F, SignalEvent);
+    }
+
+    svcCreateMutex(&inversion_mutex, false);
+    svcCreateEvent(&holder_locked, RESET_ONESHOT);
+    svcCreateEvent(&holder_release, RESET_ONESHOT);
+    SCOPE_EXIT({
+        svcCloseHandle(inversion_mutex);
+        svcCloseHandle(holder_locked);
+        svcCloseHandle(holder_release);
+    });
+    PriorityInversion(false);
+    PriorityInversion(true);
+
+    svcClearEvent(sticky[0]);
+    const s64 timeouts[] = { 0, 10000, 100000, 1000000, 10000000 };
+    for (s64 timeout : timeouts)
+        TimeoutAccuracy(sticky[0], timeout);
+}
+
+} // namespace
+} // namespace
@@ -1,17 +1,173 @@
 #include "test.h"
 
+#include <stdio.h>
+#include <vector>
 #include <3ds.h>
 
 #include "output.h"
+#include "stream.h"
 #include "common/string_funcs.h"
 
-void SoftAssertLog(const std::string& function, int line, const std::string& condition)
+struct FailureLocation {
+    std::string file;
+    std::string function;
+    int line;
+    std::string condition;
+};
+
+struct TestResult {
+    std::string group;
+    std::string name;
+    bool passed;
+    u64 ticks;
+    bool has_location;
+    FailureLocation location;
+};
+
+struct GroupResult {
+    std::string name;
+    u64 ticks;
+    std::vector<TestResult> tests;
+};
+
+static std::vector<GroupResult> groups;
+static bool recording = false;
+static u64 group_start;
+static u64 last_result;
+static unsigned int failed_count = 0;
+
+// Last failed soft assertion, attached to the next failed test
+static bool has_pending_location = false;
+static FailureLocation pending_location;
+
+// Paths relative to the source directory, so that results do not depend on where it was built
+static std::string SourcePath(const std::string& file)
+{
+    const size_t pos = file.rfind("source/");
+    return pos == std::string::npos ? file : file.substr(pos + 7);
+}
+
+void SoftAssertLog(const std::string& file, const std::string& function, int line, const std::string& condition)
 {
     Log(Common::FormatString("SOFTASSERT FAILURE: `%s`\n", condition.c_str()));
     Log(Common::FormatString("    At `%s` L%i\n", function.c_str(), line));
+
+    has_pending_location = true;
+    pending_location.file = SourcePath(file);
+    pending_location.function = function;
+    pending_location.line = line;
+    pending_location.condition = condition;
 }
 
 void PrintSuccess(const std::string& group, const std::string& name, bool val)
 {
     Log(Common::FormatString("%s: [%s] %s\n", val ? "SUCCESS" : "FAILURE", group.c_str(), name.c_str()));
+
+    if (!val)
+        failed_count++;
+
+    if (!recording) {
+        StreamTest(group, name, val, 0);
+    } else {
+        const u64 now = svcGetSystemTick();
+        TestResult result;
+        result.group = group;
+        result.name = name;
+        result.passed = val;
+        result.ticks = now - last_result;
+        StreamTest(group, name, val, result.ticks);
+        result.has_location = !val && has_pending_location;
+        if (result.has_location)
+            result.location = pending_location;
+        groups.back().tests.push_back(result);
+        last_result = now;
+    }
+    has_pending_location = false;
+}
+
+void BeginTestGroup(const std::string& name)
+{
+    GroupResult group;
+    group.name = name;
+    group.ticks = 0;
+    groups.push_back(group);
+    StreamGroup(name);
+
+    recording = true;
+    has_pending_location = false;
+    group_start = last_result = svcGetSystemTick();
+}
+
+void EndTestGroup()
+{
+    if (!recording)
+        return;
+
+    groups.back().ticks = svcGetSystemTick() - group_start;
+    recording = false;
+}
+
+unsigned int FailedTestCount()
+{
+    return failed_count;
+}
+
+static std::string JsonString(const std::string& text)
+{
+    std::string out = "\"";
+    for (char c : text) {
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if ((unsigned char)c < 0x20)
+                out += Common::FormatString("\\u%04x", c);
+            else
+                out += c;
+        }
+    }
+    return out + "\"";
+}
+
+bool WriteTestResults(const std::string& path)
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr)
+        return false;
+
+    unsigned int passed = 0;
+    unsigned int failed = 0;
+
+    // One test per line, so that results from two runs can be compared with diff
+    fprintf(file, "{\n\"tick_rate\": %u,\n\"groups\": [\n", (u32)SYSCLOCK_ARM11);
+    for (size_t i = 0; i < groups.size(); ++i) {
+        const GroupResult& group = groups[i];
+        fprintf(file, "{\"name\": %s, \"ticks\": %llu, \"tests\": [\n", JsonString(group.name).c_str(), group.ticks);
+
+        for (size_t j = 0; j < group.tests.size(); ++j) {
+            const TestResult& test = group.tests[j];
+            test.passed ? passed++ : failed++;
+
+            fprintf(file, "  {\"group\": %s, \"name\": %s, \"status\": \"%s\", \"ticks\": %llu",
+                    JsonString(test.group).c_str(), JsonString(test.name).c_str(),
+                    test.passed ? "pass" : "fail", test.ticks);
+            if (test.has_location) {
+                const FailureLocation& location = test.location;
+                fprintf(file, ", \"failure\": {\"file\": %s, \"function\": %s, \"line\": %i, \"condition\": %s}",
+                        JsonString(location.file).c_str(), JsonString(location.function).c_str(),
+                        location.line, JsonString(location.condition).c_str());
+            }
+            fprintf(file, "}%s\n", j + 1 < group.tests.size() ? "," : "");
+        }
+
+        fprintf(file, "]}%s\n", i + 1 < groups.size() ? "," : "");
+    }
+    fprintf(file, "],\n\"passed\": %u,\n\"failed\": %u\n}\n", passed, failed);
+
+    const bool ok = !ferror(file);
+    fclose(file);
+    return ok;
 }
@@ -5,13 +5,13 @@
 
 typedef void (*TestCaller)(void);
 
-void SoftAssertLog(const std::string& function, int line, const std::string& condition);
+void SoftAssertLog(const std::string& file, const std::string& function, int line, const std::string& condition);
 
 // If the condition fails, return false
 #define SoftAssert(cond) \
     do { \
         if (!(cond)) { \
-            SoftAssertLog(__PRETTY_FUNCTION__, __LINE__, #cond); \
+            SoftAssertLog(__FILE__, __PRETTY_FUNCTION__, __LINE__, #cond); \
             return false; \
         } \
     } while (0)
@@ -23,13 +23,27 @@ void SoftAssertLog(const std::string& function, int line, const std::string& con
         if (!(var_actual == var_expected)) { \
             std::ostringstream ss; \
             ss << std::hex << #actual << "\nexpected [" << var_expected << "]\ngot [" << var_actual << "]"; \
-            SoftAssertLog(__PRETTY_FUNCTION__, __LINE__, ss.str()); \
+            SoftAssertLog(__FILE__, __PRETTY_FUNCTION__, __LINE__, ss.str()); \
             return false; \
         } \
     } while (0)
 
 void PrintSuccess(const std::string& group, const std::string& name, bool val);
 
+/**
+ * Starts recording the results of a group of tests, as run from main(). Every PrintSuccess() is
+ * recorded, along with how long it took since the previous one and, for failures, where the last
+ * soft assertion failed.
+ */
+void BeginTestGroup(const std::string& name);
+void EndTestGroup();
+
+/// Number of failed tests recorded so far.
+unsigned int FailedTestCount();
+
+/// Writes all recorded results to `path` as JSON. Returns false if the file could not be written.
+bool WriteTestResults(const std::string& path);
+
 template <typename T>
 bool Test(const std::string& group, const std::string& name, T result, T expected)
 {
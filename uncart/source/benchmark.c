@@ -0,0 +1,102 @@
+#include "benchmark.h"
+
+#include "draw.h"
+#include "hid.h"
+#include "timer.h"
+#include "gamecart/protocol.h"
+#include "gamecart/command_ctr.h"
+
+// Bytes read with one command, same as the dump loop in main.c
+#define READ_CHUNK (1u * 1024 * 1024)
+
+// Bytes read back with each setting to check the data against the default one
+#define VERIFY_SIZE (64u * 1024)
+
+static const u32 page_sizes[] = { 0x200, 0x400, 0x800, 0x1000 };
+
+static const struct {
+    u32 latency;
+    const char* name;
+} latencies[] = {
+    { CTR_READ_LATENCY, "data" }, // CTR_CmdReadData
+    { 0x704802Cu, "header" },     // CTR_CmdReadHeader
+};
+
+static const u32 bench_sizes_mb[] = { 1, 4, 16, 64, 256 };
+
+static void read_range(u32 sector, u32 size, u32 page_size, u32 latency, u32 media_unit, void* buffer) {
+    while (size) {
+        const u32 chunk = size < READ_CHUNK ? size : READ_CHUNK;
+        const u32 blocks = chunk / page_size;
+
+        Cart_Dummy();
+        Cart_Dummy();
+        CTR_CmdReadDataLatency(sector, page_size, blocks, latency, buffer);
+
+        // A NULL buffer makes CTR_SendCommand drain the FIFO without storing anything
+        if (buffer)
+            buffer = (u8*)buffer + chunk;
+        sector += chunk / media_unit;
+        size -= chunk;
+    }
+}
+
+static u32 choose_size(u32 max_size) {
+    size_t choice = 1;
+    while (true) {
+        u32 size = bench_sizes_mb[choice] * 1024u * 1024u;
+        if (size > max_size)
+            size = max_size;
+        Debug("Read %u KiB per setting. UP/DOWN: change,", size / 1024);
+        Debug("A: start, B: cancel");
+
+        const u32 input = InputWait();
+        if (input & BUTTON_A)
+            return size;
+        if (input & BUTTON_B)
+            return 0;
+        if ((input & BUTTON_UP) && choice + 1 < sizeof(bench_sizes_mb) / sizeof(bench_sizes_mb[0]))
+            choice++;
+        if ((input & BUTTON_DOWN) && choice > 0)
+            choice--;
+    }
+}
+
+void Benchmark_CartReads(u8* buffer, u32 media_unit, u32 cart_size) {
+    const u64 cart_bytes = (u64)cart_size * media_unit;
+    const u32 size = choose_size(cart_bytes < 0x80000000u ? (u32)cart_bytes : 0x80000000u) & ~(READ_CHUNK - 1);
+    if (size == 0)
+        return;
+
+    Timer_Init();
+
+    // Reference data, read the way the dump loop does
+    u8* const reference = buffer;
+    u8* const readback = buffer + VERIFY_SIZE;
+    read_range(0, VERIFY_SIZE, media_unit, CTR_READ_LATENCY, media_unit, reference);
+
+    Debug("Page  Latency          Data  Time ms   KiB/s");
+    for (size_t l = 0; l < sizeof(latencies) / sizeof(latencies[0]); l++) {
+        for (size_t p = 0; p < sizeof(page_sizes) / sizeof(page_sizes[0]); p++) {
+            const u32 page_size = page_sizes[p];
+            const u32 latency = latencies[l].latency;
+
+            // Pages smaller than a media unit cannot be addressed by the read command
+            if (page_size < media_unit)
+                continue;
+
+            memset(readback, 0, VERIFY_SIZE);
+            read_range(0, VERIFY_SIZE, page_size, latency, media_unit, readback);
+            const bool data_ok = memcmp(reference, readback, VERIFY_SIZE) == 0;
+
+            const u64 start = Timer_GetTicks();
+            read_range(0, size, page_size, latency, media_unit, NULL);
+            const u64 ticks = Timer_GetTicks() - start;
+
+            const u64 us = Timer_TicksToUs(ticks);
+            const u64 kib_per_s = us ? (u64)size * 1000000u / 1024u / us : 0;
+            Debug("%4u  %08X %-6s  %-4s  %7llu %7llu", page_size, latency, latencies[l].name,
+                  data_ok ? "ok" : "BAD", us / 1000, kib_per_s);
+        }
+    }
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "common.h"
+
+// Times cart reads for each page size and latency, without writing to the SD card.
+// buffer must hold at least 128 KiB.
+void Benchmark_CartReads(u8* buffer, u32 media_unit, u32 cart_size);
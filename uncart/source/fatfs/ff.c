@@ -138,6 +138,144 @@ const unsigned short Tbl[] = {  /*  CP437(0x80-0xFF) to Unicode conversion table
     0x00B0, 0x2219, 0x00B7, 0x221A, 0x207F, 0x00B2, 0x25A0, 0x00A0
 };
 
+/* Generated from Tbl[] by mkcvt.py, do not edit */
+static
+const BYTE CvtIdx[] = {  /*  Unicode high byte to CvtPage[] index + 1, 0: no CP437 character */
+    0x01, 0x02, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x04, 0x00, 0x05, 0x06, 0x00, 0x07
+};
+
+static
+const BYTE CvtPage[][256] = {   /*  Unicode low byte to CP437 code, the inverse of Tbl[] */
+    {   /* U+00xx */
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0xFF, 0xAD, 0x9B, 0x9C, 0x00, 0x9D, 0x00, 0x00, 0x00, 0x00, 0xA6, 0xAE, 0xAA, 0x00, 0x00, 0x00,
+        0xF8, 0xF1, 0xFD, 0x00, 0x00, 0xE6, 0x00, 0xFA, 0x00, 0x00, 0xA7, 0xAF, 0xAC, 0xAB, 0x00, 0xA8,
+        0x00, 0x00, 0x00, 0x00, 0x8E, 0x8F, 0x92, 0x80, 0x00, 0x90, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0xA5, 0x00, 0x00, 0x00, 0x00, 0x99, 0x00, 0x00, 0x00, 0x00, 0x00, 0x9A, 0x00, 0x00, 0xE1,
+        0x85, 0xA0, 0x83, 0x00, 0x84, 0x86, 0x91, 0x87, 0x8A, 0x82, 0x88, 0x89, 0x8D, 0xA1, 0x8C, 0x8B,
+        0x00, 0xA4, 0x95, 0xA2, 0x93, 0x00, 0x94, 0xF6, 0x00, 0x97, 0xA3, 0x96, 0x81, 0x00, 0x00, 0x98
+    },
+    {   /* U+01xx */
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x9F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    },
+    {   /* U+03xx */
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0xE2, 0x00, 0x00, 0x00, 0x00, 0xE9, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0xE4, 0x00, 0x00, 0xE8, 0x00, 0x00, 0xEA, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0xE0, 0x00, 0x00, 0xEB, 0xEE, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0xE3, 0x00, 0x00, 0xE5, 0xE7, 0x00, 0xED, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    },
+    {   /* U+20xx */
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFC,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x9E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    },
+    {   /* U+22xx */
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF9, 0xFB, 0x00, 0x00, 0x00, 0xEC, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xEF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0xF0, 0x00, 0x00, 0xF3, 0xF2, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    },
+    {   /* U+23xx */
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0xA9, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0xF4, 0xF5, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    },
+    {   /* U+25xx */
+        0xC4, 0x00, 0xB3, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xDA, 0x00, 0x00, 0x00,
+        0xBF, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xD9, 0x00, 0x00, 0x00, 0xC3, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0xB4, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC2, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0xC1, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC5, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0xCD, 0xBA, 0xD5, 0xD6, 0xC9, 0xB8, 0xB7, 0xBB, 0xD4, 0xD3, 0xC8, 0xBE, 0xBD, 0xBC, 0xC6, 0xC7,
+        0xCC, 0xB5, 0xB6, 0xB9, 0xD1, 0xD2, 0xCB, 0xCF, 0xD0, 0xCA, 0xD8, 0xD7, 0xCE, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0xDF, 0x00, 0x00, 0x00, 0xDC, 0x00, 0x00, 0x00, 0xDB, 0x00, 0x00, 0x00, 0xDD, 0x00, 0x00, 0x00,
+        0xDE, 0xB0, 0xB1, 0xB2, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0xFE, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    }
+};
+
 DWORD get_fattime (void) {
     // fixed valid time of 1980-01-01 00:00:00
     return 0x210000;
@@ -149,6 +287,7 @@ WCHAR ff_convert (  /* Converted character, Returns zero on error */
 )
 {
     WCHAR c;
+    UINT hi;
 
 
     if (src < 0x80) {   /* ASCII */
@@ -159,10 +298,8 @@ WCHAR ff_convert (  /* Converted character, Returns zero on error */
             c = (src >= 0x100) ? 0 : Tbl[src - 0x80];
 
         } else {        /* Unicode to OEMCP */
-            for (c = 0; c < 0x80; c++) {
-                if (src == Tbl[c]) break;
-            }
-            c = (c + 0x80) & 0xFF;
+            hi = (UINT)src >> 8;
+            c = (hi < sizeof CvtIdx && CvtIdx[hi]) ? CvtPage[CvtIdx[hi] - 1][src & 0xFF] : 0;
         }
     }
 
@@ -230,6 +367,26 @@ typedef struct {
 #endif
 
 
+/* Directory name hash index feature */
+#if _USE_DIRHASH
+#if _FS_REENTRANT
+#error Static name hash index cannot be used at thread-safe configuration.
+#endif
+#if _USE_DIRHASH < 64 || (_USE_DIRHASH & (_USE_DIRHASH - 1))
+#error _USE_DIRHASH must be a power of 2 and 64 or larger.
+#endif
+typedef struct {
+    FATFS *fs;              /* Volume of the indexed directory (NULL:no index) */
+    WORD id;                /* Mount ID of the volume */
+    BYTE stat;              /* 1:Index is complete, 2:Directory did not fit in the index */
+    DWORD sclust;           /* Start cluster of the indexed directory */
+    UINT cnt;               /* Number of used slots */
+    WORD slot[_USE_DIRHASH];    /* Entry index + 1, 0:blank, 0xFFFF:deleted */
+    BYTE tag[_USE_DIRHASH];     /* Name hash[31:24] of the slot */
+} DIRHASH;
+#endif
+
+
 
 /* DBCS code ranges and SBCS extend character conversion table */
 
@@ -565,6 +722,11 @@ static
 FILESEM Files[_FS_LOCK];    /* Open object lock semaphores */
 #endif
 
+#if _USE_DIRHASH
+static
+DIRHASH DirHash;            /* Name hash index of the last searched directory */
+#endif
+
 #if _USE_LFN == 0           /* No LFN feature */
 #define DEF_NAMEBUF         BYTE sfn[12]
 #define INIT_BUF(dobj)      (dobj).fn = sfn
@@ -1564,8 +1726,10 @@ BYTE sum_sfn (
 /*-----------------------------------------------------------------------*/
 
 static
-FRESULT dir_find (
-    DIR* dp         /* Pointer to the directory object linked to the file name */
+FRESULT dir_match ( /* FR_OK:Matched, FR_NO_FILE:Not found, others:Error */
+    DIR* dp,        /* Pointer to the directory object linked to the file name */
+    UINT idx,       /* Index to start the search at */
+    int single      /* 0:Search to the end of the table, 1:Check only the object at idx */
 )
 {
     FRESULT res;
@@ -1574,7 +1738,7 @@ FRESULT dir_find (
     BYTE a, ord, sum;
 #endif
 
-    res = dir_sdi(dp, 0);           /* Rewind directory object */
+    res = dir_sdi(dp, idx);         /* Rewind directory object */
     if (res != FR_OK) return res;
 
 #if _USE_LFN
@@ -1593,12 +1757,16 @@ FRESULT dir_find (
         a = dir[DIR_Attr] & AM_MASK;
         if (c == DDE || ((a & AM_VOL) && a != AM_LFN)) {    /* An entry without valid data */
             ord = 0xFF;
+            if (single) {
+                res = FR_NO_FILE;
+                break;
+            }
         } else {
             if (a == AM_LFN) {          /* An LFN entry is found */
                 if (dp->lfn) {
                     if (c & LLE) {      /* Is it start of LFN sequence? */
                         sum = dir[LDIR_Chksum];
-                        c &= ~LLE;
+                        c = (BYTE)(c & ~LLE);
                         ord = c; /* LFN start order */
                         dp->lfn_idx = dp->index;
                     }
@@ -1610,11 +1778,19 @@ FRESULT dir_find (
                 ord = 0xFF;
                 dp->lfn_idx = 0xFFFF;   /* Reset LFN sequence */
                 if (!(dp->fn[NS] & NS_LOSS) && !mem_cmp(dir, dp->fn, 11)) break;    /* SFN matched? */
+                if (single) {
+                    res = FR_NO_FILE;
+                    break;
+                }
             }
         }
 #else       /* Non LFN configuration */
         if (!(dir[DIR_Attr] & AM_VOL) && !mem_cmp(dir, dp->fn, 11)) /* Is it a valid entry? */
             break;
+        if (single) {
+            res = FR_NO_FILE;
+            break;
+        }
 #endif
         res = dir_next(dp, 0);      /* Next entry */
     } while (res == FR_OK);
@@ -1625,6 +1801,297 @@ FRESULT dir_find (
 
 
 
+#if _USE_DIRHASH
+/*-----------------------------------------------------------------------*/
+/* Directory name hash index - Hash functions                            */
+/*-----------------------------------------------------------------------*/
+
+#define HASH_INIT   0x811C9DC5      /* FNV-1a offset basis */
+#define HASH_STEP(h, c) (((h) ^ (c)) * 0x01000193)
+
+static
+DWORD hash_mix (    /* Spread all bits of a hash value over the result */
+    DWORD h
+)
+{
+    h ^= h >> 16; h *= 0x85EBCA6B;
+    h ^= h >> 13; h *= 0xC2B2AE35;
+    h ^= h >> 16;
+    return h;
+}
+
+
+static
+DWORD hash_sfn (    /* Hash value of an SFN */
+    const BYTE* sfn /* Pointer to the SFN (dir entry or fn[]) */
+)
+{
+    DWORD h = HASH_INIT;
+    UINT n = 11;
+
+    do h = HASH_STEP(h, *sfn++);
+    while (--n);
+    return hash_mix(h);
+}
+
+
+#if _USE_LFN
+/* The hash of an LFN is the XOR of the hashes of its 13 character parts so that
+/  it can be built from the LFN entries, which are stored in reverse order. The
+/  characters are converted to upper case the same way cmp_lfn() compares them. */
+
+static
+DWORD hash_lfn_ent (    /* Hash value of the LFN part in an LFN entry */
+    const BYTE* dir     /* Pointer to the LFN entry */
+)
+{
+    DWORD h = HASH_INIT ^ (DWORD)(dir[LDIR_Ord] & ~LLE);
+    UINT s = 0;
+    WCHAR uc;
+
+    do {
+        uc = (WCHAR)(dir[LfnOfs[s] + 1] << 8 | dir[LfnOfs[s]]);   /* LD_WORD() would cast away const */
+        if (!uc) break;
+        h = HASH_STEP(h, ff_wtoupper(uc));
+    } while (++s < 13);
+    return hash_mix(h);
+}
+
+
+static
+DWORD hash_lfn (        /* Hash value of an LFN, same as the XOR of hash_lfn_ent() over its entries */
+    const WCHAR* lfn    /* Pointer to the LFN */
+)
+{
+    DWORD h = 0, hp;
+    UINT ord = 1, s;
+
+    while (*lfn) {
+        hp = HASH_INIT ^ ord++;
+        s = 0;
+        do hp = HASH_STEP(hp, ff_wtoupper(*lfn++));
+        while (++s < 13 && *lfn);
+        h ^= hash_mix(hp);
+    }
+    return h;
+}
+#endif
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Directory name hash index - Build/Update/Search                       */
+/*-----------------------------------------------------------------------*/
+
+#define DIRHASH_MIN     64          /* Directories found in fewer entries than this are not indexed */
+#define DIRHASH_DEL     0xFFFF      /* Slot of a removed object */
+#define DIRHASH_TAG(h)  ((BYTE)((h) >> 24))     /* The slot is chosen by the low bits of the hash */
+
+static
+DWORD dir_hash_clust (  /* Start cluster identifying the directory in the index */
+    DIR* dp
+)
+{
+    return (dp->fs->fs_type == FS_FAT32 && dp->sclust == dp->fs->dirbase) ? 0 : dp->sclust;
+}
+
+
+static
+int dir_hash_hit (  /* 1:The index belongs to the directory, 0:Not */
+    DIR* dp         /* Pointer to the directory object */
+)
+{
+    return DirHash.fs == dp->fs && DirHash.id == dp->fs->id && DirHash.sclust == dir_hash_clust(dp);
+}
+
+
+static
+int dir_hash_put (  /* 1:Added, 0:The index is full */
+    DWORD h,        /* Hash value of the name */
+    UINT idx        /* Index of the first directory entry of the object */
+)
+{
+    UINT i;
+
+    if (DirHash.cnt >= _USE_DIRHASH / 4 * 3) return 0;    /* Keep the load factor below 3/4 */
+    if (idx + 1 >= DIRHASH_DEL) return 0;                   /* Does not fit in a slot */
+    DirHash.cnt++;
+    for (i = h; DirHash.slot[i & (_USE_DIRHASH - 1)]; i++) ;   /* Linear probing */
+    i &= _USE_DIRHASH - 1;
+    DirHash.slot[i] = (WORD)(idx + 1);
+    DirHash.tag[i] = DIRHASH_TAG(h);
+    return 1;
+}
+
+
+static
+FRESULT dir_hash_build (    /* Scan the whole directory and index every name in it */
+    DIR* dp                 /* Pointer to the directory object */
+)
+{
+    FRESULT res;
+    BYTE c, *dir;
+#if _USE_LFN
+    BYTE a, ord, sum;
+    UINT lfn_idx = 0;
+    DWORD h = 0;
+#endif
+
+    DirHash.fs = dp->fs;
+    DirHash.id = dp->fs->id;
+    DirHash.sclust = dir_hash_clust(dp);
+    DirHash.stat = 1;
+    DirHash.cnt = 0;
+    mem_set(DirHash.slot, 0, sizeof DirHash.slot);
+    mem_set(DirHash.tag, 0, sizeof DirHash.tag);
+
+    res = dir_sdi(dp, 0);
+#if _USE_LFN
+    ord = sum = 0xFF;
+#endif
+    while (res == FR_OK) {
+        res = move_window(dp->fs, dp->sect);
+        if (res != FR_OK) break;
+        dir = dp->dir;
+        c = dir[DIR_Name];
+        if (c == 0) {
+            res = FR_NO_FILE;   /* Reached to end of table */
+            break;
+        }
+#if _USE_LFN    /* LFN configuration, follows the same sequence checks as dir_match() */
+        a = dir[DIR_Attr] & AM_MASK;
+        if (c == DDE || ((a & AM_VOL) && a != AM_LFN)) {    /* An entry without valid data */
+            ord = 0xFF;
+        } else if (a == AM_LFN) {       /* An LFN entry is found */
+            if (c & LLE) {              /* Is it start of LFN sequence? */
+                sum = dir[LDIR_Chksum];
+                c = (BYTE)(c & ~LLE);
+                ord = c;
+                lfn_idx = dp->index;
+                h = 0;
+            }
+            if (c == ord && sum == dir[LDIR_Chksum]) {
+                h ^= hash_lfn_ent(dir);
+                ord--;
+            } else {
+                ord = 0xFF;
+            }
+        } else {                        /* An SFN entry is found */
+            if (!ord && sum == sum_sfn(dir) && !dir_hash_put(h, lfn_idx)) break;
+            ord = 0xFF;
+            if (!dir_hash_put(hash_sfn(dir), dp->index)) break;
+        }
+#else           /* Non LFN configuration */
+        if (c != DDE && !(dir[DIR_Attr] & AM_VOL) && !dir_hash_put(hash_sfn(dir), dp->index)) break;
+#endif
+        res = dir_next(dp, 0);
+    }
+
+    if (res == FR_NO_FILE) return FR_OK;    /* The whole directory has been indexed */
+    if (res == FR_OK) {
+        DirHash.stat = 2;   /* Too many names, search this directory without the index */
+    } else {
+        DirHash.fs = 0;     /* Disk error, discard the index */
+    }
+    return res;
+}
+
+
+static
+FRESULT dir_hash_find ( /* FR_OK:Matched, FR_NO_FILE:Not found, others:Error */
+    DIR* dp             /* Pointer to the directory object linked to the file name */
+)
+{
+    FRESULT res;
+    DWORD h[2];
+    UINT n = 0, i, s, idx, best = 0x10000;
+
+#if _USE_LFN
+    if (dp->lfn) h[n++] = hash_lfn(dp->lfn);
+    if (!(dp->fn[NS] & NS_LOSS))
+#endif
+    h[n++] = hash_sfn(dp->fn);
+
+    /* Check every object with a matching hash and take the first one in the table,
+    /  as the linear search does */
+    while (n--) {
+        for (i = h[n]; (s = DirHash.slot[i & (_USE_DIRHASH - 1)]) != 0; i++) {
+            if (s == DIRHASH_DEL || DirHash.tag[i & (_USE_DIRHASH - 1)] != DIRHASH_TAG(h[n])) continue;   /* Deleted or name hash mismatch */
+            idx = s - 1;
+            if (idx >= best) continue;
+            res = dir_match(dp, idx, 1);
+            if (res == FR_OK) best = idx;
+            else if (res != FR_NO_FILE) return res;
+        }
+    }
+    if (best == 0x10000) return FR_NO_FILE;
+
+    return dir_match(dp, best, 1);  /* Point the directory object to the matched object */
+}
+
+
+#if !_FS_READONLY && !_FS_MINIMIZE
+static
+void dir_hash_del (     /* Remove an object from the index */
+    DIR* dp             /* Directory object pointing the object to be removed */
+)
+{
+    UINT i, s;
+
+
+    if (!dir_hash_hit(dp)) {
+        /* The object may be the indexed directory itself, whose clusters can be reused */
+        if (DirHash.fs == dp->fs) DirHash.fs = 0;
+        return;
+    }
+    for (i = 0; i < _USE_DIRHASH; i++) {
+        s = DirHash.slot[i];
+        if (s && s != DIRHASH_DEL && (s - 1 == dp->index
+#if _USE_LFN
+            || s - 1 == dp->lfn_idx
+#endif
+            )) DirHash.slot[i] = DIRHASH_DEL;   /* Leave a deleted mark to keep the probe chains */
+    }
+}
+#endif
+#endif /* _USE_DIRHASH */
+
+
+
+
+static
+FRESULT dir_find (
+    DIR* dp         /* Pointer to the directory object linked to the file name */
+)
+{
+    FRESULT res;
+#if _USE_DIRHASH
+    UINT idx;
+
+
+    if (dir_hash_hit(dp) && DirHash.stat == 1) return dir_hash_find(dp);
+#endif
+    res = dir_match(dp, 0, 0);
+#if _USE_DIRHASH
+    /* Index the directory when the search had to go through many entries.
+    /  Small directories, such as the ones on the way of a path, keep the index of a large one. */
+    if ((res == FR_OK || res == FR_NO_FILE) && !dir_hash_hit(dp) && dp->index >= DIRHASH_MIN) {
+#if _USE_LFN
+        idx = (dp->lfn_idx != 0xFFFF) ? dp->lfn_idx : dp->index;
+#else
+        idx = dp->index;
+#endif
+        if (dir_hash_build(dp) != FR_OK) return FR_DISK_ERR;
+        if (res == FR_OK) res = dir_match(dp, idx, 1);  /* Point the directory object to the matched object again */
+    }
+#endif
+    return res;
+}
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Read an object from the directory                                     */
 /*-----------------------------------------------------------------------*/
@@ -1762,6 +2229,19 @@ FRESULT dir_register (  /* FR_OK:Successful, FR_DENIED:No free entry or too many
         }
     }
 
+#if _USE_DIRHASH
+    if (res == FR_OK && dir_hash_hit(dp) && DirHash.stat == 1) {    /* Add the new object to the index */
+#if _USE_LFN
+        if (sn[NS] & NS_LFN) {
+            for (n = 0; lfn[n]; n++) ;
+            if (!dir_hash_put(hash_lfn(lfn), dp->index - (n + 12) / 13)) DirHash.fs = 0;
+        }
+#endif
+        if (!dir_hash_put(hash_sfn(dp->fn), dp->index))
+            DirHash.fs = 0;     /* Full, build it again on the next search */
+    }
+#endif
+
     return res;
 }
 #endif /* !_FS_READONLY */
@@ -1779,9 +2259,14 @@ FRESULT dir_remove (    /* FR_OK: Successful, FR_DISK_ERR: A disk error */
 )
 {
     FRESULT res;
-#if _USE_LFN    /* LFN configuration */
+#if _USE_LFN
     UINT i;
+#endif
 
+#if _USE_DIRHASH
+    dir_hash_del(dp);
+#endif
+#if _USE_LFN    /* LFN configuration */
     i = dp->index;  /* SFN index */
     res = dir_sdi(dp, (dp->lfn_idx == 0xFFFF) ? i : dp->lfn_idx);   /* Goto the SFN or top of the LFN entries */
     if (res == FR_OK) {
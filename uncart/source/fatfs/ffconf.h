@@ -203,6 +203,19 @@
 /  This feature consumes _FS_LOCK * 12 bytes of bss area. */
 
 
+#ifndef _USE_DIRHASH   /* tools/fatbench builds with it set on the command line */
+#define _USE_DIRHASH    8192    /* 0:Disable or >=64:Enable */
+#endif
+/* To enable name hash index of directory, set _USE_DIRHASH to a power of 2 of 64
+/  or larger. When a search has to go through 64 or more entries of a directory,
+/  the names in it are indexed and the following searches in that directory look up
+/  the index instead of scanning the directory table. Only one directory is indexed
+/  at a time. The value defines the number of index slots, an object takes one slot
+/  for the SFN and one more for the LFN, and a directory that does not fit in 3/4 of
+/  the slots is searched without the index. This feature consumes _USE_DIRHASH * 3
+/  bytes of bss area and cannot be used with _FS_REENTRANT. */
+
+
 #define _FS_REENTRANT   0       /* 0:Disable or 1:Enable */
 #define _FS_TIMEOUT     1000    /* Timeout period in unit of time ticks */
 #define _SYNC_t         HANDLE  /* O/S dependent sync object type. e.g. HANDLE, OS_EVENT*, ID and etc.. */
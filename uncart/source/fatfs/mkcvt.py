@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""Generates the CvtIdx[] and CvtPage[] tables of ff_convert() in ff.c from Tbl[].
+
+Tbl[] maps CP437 codes 0x80-0xFF to Unicode. The generated tables are its inverse, indexed by the
+high and then the low byte of a Unicode character, so that ff_convert() does not have to search
+Tbl[]. Run this after editing Tbl[]. With --check, ff.c is left alone and the exit status tells
+whether its tables are up to date.
+
+Usage: python3 mkcvt.py [--check] [ff.c]
+"""
+
+import os
+import re
+import sys
+
+BEGIN = "/* Generated from Tbl[] by mkcvt.py, do not edit */"
+END_RE = re.compile(r"const BYTE CvtPage\[\]\[256\] = \{.*?\n\};\r?\n", re.S)
+
+
+def read_tbl(source):
+    match = re.search(r"const unsigned short Tbl\[\] = \{[^\n]*\n(.*?)\n\};", source, re.S)
+    if not match:
+        sys.exit("mkcvt.py: Tbl[] not found")
+    tbl = [int(value, 16) for value in re.findall(r"0x[0-9A-Fa-f]{4}", match.group(1))]
+    if len(tbl) != 0x80:
+        sys.exit("mkcvt.py: Tbl[] has %d entries, not 128" % len(tbl))
+    return tbl
+
+
+def row(values, indent):
+    return indent + " ".join("0x%02X," % value for value in values)
+
+
+def generate(tbl, newline):
+    pages = []  # High bytes that have a page, in order
+    page_of = {}
+    for code, char in enumerate(tbl, 0x80):
+        high = char >> 8
+        if high not in page_of:
+            page_of[high] = [0] * 256
+            pages.append(high)
+        # The first code wins, as with the search this replaces
+        if not page_of[high][char & 0xFF]:
+            page_of[high][char & 0xFF] = code
+    pages.sort()
+
+    index = [0] * (pages[-1] + 1)
+    for number, high in enumerate(pages, 1):
+        index[high] = number
+
+    lines = [BEGIN, "static",
+             "const BYTE CvtIdx[] = {  /*  Unicode high byte to CvtPage[] index + 1, 0: no CP437 character */"]
+    lines += [row(index[i:i + 16], "    ") for i in range(0, len(index), 16)]
+    lines[-1] = lines[-1].rstrip(",")
+    lines += ["};", "", "static",
+              "const BYTE CvtPage[][256] = {   /*  Unicode low byte to CP437 code, the inverse of Tbl[] */"]
+    for number, high in enumerate(pages):
+        lines.append("    {   /* U+%02Xxx */" % high)
+        lines += [row(page_of[high][i:i + 16], "        ") for i in range(0, 256, 16)]
+        lines[-1] = lines[-1].rstrip(",")
+        lines.append("    }," if number < len(pages) - 1 else "    }")
+    lines.append("};")
+    return newline.join(lines) + newline
+
+
+def main(args):
+    check = "--check" in args
+    args = [arg for arg in args if arg != "--check"]
+    path = args[0] if args else os.path.join(os.path.dirname(os.path.abspath(__file__)), "ff.c")
+
+    with open(path, newline="") as f:
+        source = f.read()
+    newline = "\r\n" if "\r\n" in source else "\n"
+
+    begin = source.find(BEGIN)
+    end = END_RE.search(source, begin) if begin >= 0 else None
+    if not end:
+        sys.exit("mkcvt.py: generated tables not found in " + path)
+
+    tables = generate(read_tbl(source), newline)
+    if source[begin:end.end()] == tables:
+        return 0
+    if check:
+        print("mkcvt.py: the tables in %s do not match Tbl[], run mkcvt.py" % path)
+        return 1
+
+    with open(path, "w", newline="") as f:
+        f.write(source[:begin] + tables + source[end.end():])
+    print("mkcvt.py: updated " + path)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -16,6 +16,11 @@ static void CTR_CmdC5()
 }
 
 void CTR_CmdReadData(u32 sector, u32 length, u32 blocks, void* buffer)
+{
+    CTR_CmdReadDataLatency(sector, length, blocks, CTR_READ_LATENCY, buffer);
+}
+
+void CTR_CmdReadDataLatency(u32 sector, u32 length, u32 blocks, u32 latency, void* buffer)
 {
     if(read_count++ > 10000)
     {
@@ -28,7 +33,7 @@ void CTR_CmdReadData(u32 sector, u32 length, u32 blocks, void* buffer)
         (u32)((sector << 9) & 0xFFFFFFFF),
         0x00000000, 0x00000000
     };
-    CTR_SendCommand(read_cmd, length, blocks, 0x704822C, buffer);
+    CTR_SendCommand(read_cmd, length, blocks, latency, buffer);
 }
 
 void CTR_CmdReadHeader(void* buffer)
@@ -6,8 +6,12 @@
 
 #include "common.h"
 
+// Latency CTR_CmdReadData uses
+#define CTR_READ_LATENCY 0x704822Cu
+
 void CTR_CmdReadSectorSD(u8* aBuffer, u32 aSector);
 void CTR_CmdReadData(u32 sector, u32 length, u32 blocks, void* buffer);
+void CTR_CmdReadDataLatency(u32 sector, u32 length, u32 blocks, u32 latency, void* buffer);
 void CTR_CmdReadHeader(void* buffer);
 u32 CTR_CmdGetSecureId(u32 rand1, u32 rand2);
 void CTR_CmdSeed(u32 rand1, u32 rand2);
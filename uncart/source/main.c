@@ -5,6 +5,7 @@
 #include "gamecart/protocol.h"
 #include "gamecart/command_ctr.h"
 #include "headers.h"
+#include "benchmark.h"
 
 #include <string.h>
 #include <stdio.h>
@@ -151,14 +152,20 @@ restart_program:
     u32 input;
     do {
         Debug("Press A to dump all of ROM, B for only the");
-        Debug("trimmed version.");
+        Debug("trimmed version, X to benchmark cart reads.");
         input = InputWait();
     }
-    while (!(input & BUTTON_A) && !(input & BUTTON_B));
+    while (!(input & BUTTON_A) && !(input & BUTTON_B) && !(input & BUTTON_X));
 
 
     const u32 mediaUnit = 0x200 * (1u << ncsdHeader->partition_flags[MEDIA_UNIT_SIZE]); //Correctly set the media unit size
 
+    if (input & BUTTON_X) {
+        // Overwrites the NCSD header in the buffer, which is read again on restart
+        Benchmark_CartReads((u8*)target, mediaUnit, ncsdHeader->media_size);
+        goto restart_prompt;
+    }
+
     u32 cartSize;
     // Maximum number of blocks in a single file
     u32 file_max_blocks;
@@ -0,0 +1,40 @@
+#include "timer.h"
+
+#define REG_TIMER_VAL(n) (*(vu16*)(0x10003000 + 4 * (n)))
+#define REG_TIMER_CNT(n) (*(vu16*)(0x10003002 + 4 * (n)))
+
+#define TIMER_CASCADE (1u << 2) // Count up when the previous timer overflows
+#define TIMER_ENABLE  (1u << 7)
+
+void Timer_Init(void)
+{
+    for (int i = 0; i < 4; i++) {
+        REG_TIMER_CNT(i) = 0;
+        REG_TIMER_VAL(i) = 0;
+    }
+
+    // Start the upper timers first, so that they see the first overflow of timer 0
+    for (int i = 3; i > 0; i--)
+        REG_TIMER_CNT(i) = TIMER_ENABLE | TIMER_CASCADE;
+    REG_TIMER_CNT(0) = TIMER_ENABLE;
+}
+
+u64 Timer_GetTicks(void)
+{
+    u16 t0, t1, t2, t3;
+
+    // Read again if a lower timer carried into an upper one in between
+    do {
+        t3 = REG_TIMER_VAL(3);
+        t2 = REG_TIMER_VAL(2);
+        t1 = REG_TIMER_VAL(1);
+        t0 = REG_TIMER_VAL(0);
+    } while (t1 != REG_TIMER_VAL(1) || t2 != REG_TIMER_VAL(2) || t3 != REG_TIMER_VAL(3));
+
+    return (u64)t3 << 48 | (u64)t2 << 32 | (u64)t1 << 16 | t0;
+}
+
+u64 Timer_TicksToUs(u64 ticks)
+{
+    return ticks * 1000000u / TIMER_FREQ;
+}
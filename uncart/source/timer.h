@@ -0,0 +1,11 @@
+#pragma once
+
+#include "common.h"
+
+// ARM9 timers count at the bus clock when not prescaled
+#define TIMER_FREQ 67027964u
+
+// Starts timers 0-3 as one cascaded, free running 64 bit counter
+void Timer_Init(void);
+u64 Timer_GetTicks(void);
+u64 Timer_TicksToUs(u64 ticks);
@@ -0,0 +1,196 @@
+// fatbench - measures file lookups in large directories with uncart's FatFs, on a FAT32 RAM disk.
+//
+// For each file count, a freshly formatted volume gets one directory with that many files, half of
+// them with long names as dumps named after their titles have. Then every file is looked up with
+// f_stat() in random order, together with as many names that do not exist. The disk counts the
+// sectors FatFs reads, which is what a search costs on an SD card. Every lookup is checked against
+// the files that were created.
+//
+// make builds it twice from uncart's ff.c and ffconf.h: fatbench with the name hash index as
+// configured, and fatbench-linear with _USE_DIRHASH 0, which searches by scanning the directory.
+// Directories that do not fit in the index are scanned by both, which shows where it stops.
+//
+// Usage: fatbench [FILES...]
+//
+//   FILES  Numbers of files to put in the directory, 250 to 8000 by default.
+
+#include "ff.h"
+#include "diskio.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+static constexpr UINT SectorSize = 512;
+// 64 MiB. With clusters of one sector that is well over the 65525 clusters FAT32 needs.
+static constexpr DWORD SectorCount = 128 * 1024;
+static constexpr DWORD ReservedSectors = 32;
+static constexpr DWORD FatSectors = 1024;
+
+static std::vector<BYTE> disk;
+static unsigned long sector_reads = 0;
+
+DSTATUS disk_initialize(BYTE) {
+    return 0;
+}
+
+DSTATUS disk_status(BYTE) {
+    return 0;
+}
+
+DRESULT disk_read(BYTE, BYTE* buff, DWORD sector, UINT count) {
+    if (sector + count > SectorCount)
+        return RES_PARERR;
+    std::memcpy(buff, &disk[sector * SectorSize], count * SectorSize);
+    sector_reads += count;
+    return RES_OK;
+}
+
+DRESULT disk_write(BYTE, const BYTE* buff, DWORD sector, UINT count) {
+    if (sector + count > SectorCount)
+        return RES_PARERR;
+    std::memcpy(&disk[sector * SectorSize], buff, count * SectorSize);
+    return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE, BYTE cmd, void* buff) {
+    switch (cmd) {
+    case CTRL_SYNC:
+        return RES_OK;
+    case GET_SECTOR_COUNT:
+        *(DWORD*)buff = SectorCount;
+        return RES_OK;
+    case GET_SECTOR_SIZE:
+        *(WORD*)buff = SectorSize;
+        return RES_OK;
+    case GET_BLOCK_SIZE:
+        *(DWORD*)buff = 1;
+        return RES_OK;
+    default:
+        return RES_PARERR;
+    }
+}
+
+static void put16(BYTE* p, WORD value) {
+    p[0] = (BYTE)value;
+    p[1] = (BYTE)(value >> 8);
+}
+
+static void put32(BYTE* p, DWORD value) {
+    put16(p, (WORD)value);
+    put16(p + 2, (WORD)(value >> 16));
+}
+
+// An empty FAT32 volume without a partition table: one FAT, clusters of one sector, and the root
+// directory in cluster 2. uncart's ff.c is built without f_mkfs().
+static void format() {
+    disk.assign((size_t)SectorCount * SectorSize, 0);
+
+    BYTE* boot = &disk[0];
+    std::memcpy(boot, "\xEB\x58\x90" "MSWIN4.1", 11);
+    put16(boot + 11, SectorSize);
+    boot[13] = 1;                       // Sectors per cluster
+    put16(boot + 14, ReservedSectors);
+    boot[16] = 1;                       // Number of FATs
+    boot[21] = 0xF8;                    // Media
+    put32(boot + 32, SectorCount);
+    put32(boot + 36, FatSectors);
+    put32(boot + 44, 2);                // Root directory cluster
+    put16(boot + 48, 1);                // FSInfo sector
+    boot[66] = 0x29;                    // Extended boot signature
+    std::memcpy(boot + 82, "FAT32   ", 8);
+    put16(boot + 510, 0xAA55);
+
+    BYTE* fat = &disk[ReservedSectors * SectorSize];
+    put32(fat, 0x0FFFFFF8);
+    put32(fat + 4, 0x0FFFFFFF);
+    put32(fat + 8, 0x0FFFFFFF);         // End of the root directory
+}
+
+static std::string file_name(unsigned i) {
+    char name[40];
+    if (i % 2)
+        snprintf(name, sizeof(name), "DUMPS/Game title %05u.3ds", i);
+    else
+        snprintf(name, sizeof(name), "DUMPS/D%06u.BIN", i);
+    return name;
+}
+
+// Returns false if FatFs failed or a lookup gave the wrong answer
+static bool run(unsigned files) {
+    static FATFS fs;
+    format();
+    if (f_mount(&fs, "", 1) != FR_OK || f_mkdir("DUMPS") != FR_OK) {
+        fprintf(stderr, "fatbench: failed to set up the RAM disk\n");
+        return false;
+    }
+
+    sector_reads = 0;
+    for (unsigned i = 0; i < files; ++i) {
+        FIL file;
+        const FRESULT res = f_open(&file, file_name(i).c_str(), FA_CREATE_NEW | FA_WRITE);
+        if (res != FR_OK) {
+            fprintf(stderr, "fatbench: failed to create file %u: error %d\n", i, res);
+            return false;
+        }
+        f_close(&file);
+    }
+    const unsigned long create_reads = sector_reads;
+
+    // Every file and as many missing ones, in an order that does not follow the directory
+    std::vector<unsigned> lookups(2 * files);
+    for (unsigned i = 0; i < lookups.size(); ++i)
+        lookups[i] = i;
+    std::shuffle(lookups.begin(), lookups.end(), std::mt19937(files));
+
+    unsigned wrong = 0;
+    sector_reads = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned i : lookups) {
+        FILINFO info;
+        TCHAR long_name[_MAX_LFN + 1];
+        info.lfname = long_name;
+        info.lfsize = sizeof(long_name);
+        if (f_stat(file_name(i).c_str(), &info) != (i < files ? FR_OK : FR_NO_FILE))
+            wrong++;
+    }
+    const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+
+    printf("%7u %14.1f %14.1f %12.2f\n", files, (double)create_reads / files,
+           (double)sector_reads / lookups.size(), elapsed.count() / lookups.size());
+    f_mount(nullptr, "", 0);
+
+    if (wrong) {
+        fprintf(stderr, "fatbench: %u of %zu lookups in %u files were wrong\n", wrong, lookups.size(), files);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::vector<unsigned> counts;
+    for (int i = 1; i < argc; ++i) {
+        char* end;
+        const unsigned long count = strtoul(argv[i], &end, 10);
+        if (*end || count == 0 || count > 20000) {
+            fprintf(stderr, "Usage: fatbench [FILES...], with 1 to 20000 files\n");
+            return 2;
+        }
+        counts.push_back((unsigned)count);
+    }
+    if (counts.empty())
+        counts = { 250, 500, 1000, 2000, 3000, 4000, 8000 };
+
+    printf("_USE_DIRHASH %d\n", _USE_DIRHASH);
+    printf("%7s %14s %14s %12s\n", "files", "reads/create", "reads/lookup", "us/lookup");
+    for (unsigned files : counts) {
+        if (!run(files))
+            return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,292 @@
+// ncsdmerge - joins, trims and re-pads the dumps written by uncart on the PC.
+//
+// Dumps bigger than one file are split into NAME.3d0, NAME.3d1, ... and need to be joined before
+// use. The data never passes through this program: parts are reflinked where the file system
+// supports it (btrfs, XFS), and copied in the kernel with copy_file_range/sendfile otherwise.
+// Trimming and re-padding only change the file size or deallocate the padding.
+//
+// Usage: ncsdmerge [--trim | --pad | --sparse] [-o OUTPUT] INPUT [INPUT...]
+//
+//   INPUT     The parts in order. A single NAME.3d0 picks up NAME.3d1, NAME.3d2, ... by itself.
+//   -o        Output file, NAME.3ds by default. A single input without -o is changed in place.
+//   --trim    Cut the image after the last NCSD partition.
+//   --pad     Extend the image to the full cart size. The padding is a hole and reads as zeroes,
+//             where a full dump from the cart has 0xFF bytes.
+//   --sparse  Keep the size, but deallocate everything after the last NCSD partition.
+
+#ifndef __linux__
+#error ncsdmerge uses Linux file range APIs
+#endif
+
+#include "headers.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(NCSD_HEADER) == 0x200, "NCSD_HEADER layout mismatch");
+
+enum class Mode { Join, Trim, Pad, Sparse };
+
+struct Part {
+    std::string path;
+    int fd;
+    u64 size;
+};
+
+struct Layout {
+    u64 media_unit;
+    u64 full_size;     // media_size from the header
+    u64 trimmed_size;  // end of the last partition
+};
+
+static const char* copy_method = "nothing";
+
+static bool error(const char* what, const std::string& path) {
+    fprintf(stderr, "ncsdmerge: %s %s: %s\n", what, path.c_str(), strerror(errno));
+    return false;
+}
+
+static bool read_layout(const Part& part, Layout* layout) {
+    NCSD_HEADER header;
+    if (pread(part.fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header))
+        return error("failed to read the NCSD header of", part.path);
+
+    if (strncmp((const char*)header.magic, "NCSD", 4)) {
+        fprintf(stderr, "ncsdmerge: NCSD magic not found in %s\n", part.path.c_str());
+        return false;
+    }
+
+    const u8 unit_shift = header.partition_flags[MEDIA_UNIT_SIZE];
+    if (unit_shift > 22) {
+        fprintf(stderr, "ncsdmerge: bad media unit size %u in %s\n", unit_shift, part.path.c_str());
+        return false;
+    }
+
+    // Same as uncart's trimmed size, but robust against partitions that are not in order
+    u64 end = 0;
+    for (const partition_offsetsize& partition : header.offsetsize_table) {
+        if (partition.size != 0 && (u64)partition.offset + partition.size > end)
+            end = (u64)partition.offset + partition.size;
+    }
+
+    layout->media_unit = 0x200ull << unit_shift;
+    layout->full_size = header.media_size * layout->media_unit;
+    layout->trimmed_size = end * layout->media_unit;
+    return true;
+}
+
+// Copies len bytes from the start of src to dst_offset in dst, without reading them into this
+// process. Tries the cheapest method first: sharing the extents, an in-kernel copy, then sendfile.
+static bool copy_range(const Part& src, int dst, u64 dst_offset, u64 len, const std::string& dst_path) {
+    if (len == 0)
+        return true;
+
+    // Reflinks need block aligned lengths, except for a range that reaches the end of the source
+    struct stat st;
+    if (fstat(dst, &st) == 0 && st.st_blksize > 0) {
+        const u64 block = (u64)st.st_blksize;
+        file_clone_range clone = {};
+        clone.src_fd = src.fd;
+        clone.src_length = (len == src.size) ? 0 : (len + block - 1) / block * block;
+        clone.dest_offset = dst_offset;
+        if (clone.src_length <= src.size && ioctl(dst, FICLONERANGE, &clone) == 0) {
+            copy_method = "reflink";
+            return true;
+        }
+    }
+
+    loff_t in = 0, out = (loff_t)dst_offset;
+    while ((u64)in < len) {
+        const ssize_t done = copy_file_range(src.fd, &in, dst, &out, len - (u64)in, 0);
+        if (done > 0) {
+            copy_method = "copy_file_range";
+            continue;
+        }
+        if (done == 0) {
+            errno = EIO;  // Source is shorter than its size said
+            return error("unexpected end of", src.path);
+        }
+        if (errno == EINTR)
+            continue;
+        if (in == 0 && (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP))
+            break;  // Not supported between these files, fall back to sendfile
+        return error("failed to copy to", dst_path);
+    }
+
+    if (lseek(dst, (off_t)dst_offset + in, SEEK_SET) < 0)
+        return error("failed to seek in", dst_path);
+    while ((u64)in < len) {
+        const ssize_t done = sendfile(dst, src.fd, &in, len - (u64)in);
+        if (done > 0) {
+            copy_method = "sendfile";
+            continue;
+        }
+        if (done < 0 && errno == EINTR)
+            continue;
+        if (done == 0)
+            errno = EIO;
+        return error("failed to copy to", dst_path);
+    }
+    return true;
+}
+
+static bool open_part(const std::string& path, int flags, std::vector<Part>* parts) {
+    const int fd = open(path.c_str(), flags | O_CLOEXEC);
+    if (fd < 0)
+        return error("failed to open", path);
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return error("failed to stat", path);
+    }
+    parts->push_back({ path, fd, (u64)st.st_size });
+    return true;
+}
+
+static bool ends_with(const std::string& str, const char* suffix) {
+    const size_t len = strlen(suffix);
+    return str.size() >= len && str.compare(str.size() - len, len, suffix) == 0;
+}
+
+static bool same_file(int fd, const std::string& path) {
+    struct stat a, b;
+    return fstat(fd, &a) == 0 && stat(path.c_str(), &b) == 0 && a.st_dev == b.st_dev && a.st_ino == b.st_ino;
+}
+
+static int usage() {
+    fprintf(stderr, "Usage: ncsdmerge [--trim | --pad | --sparse] [-o OUTPUT] INPUT [INPUT...]\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    Mode mode = Mode::Join;
+    std::string output;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--trim")
+            mode = Mode::Trim;
+        else if (arg == "--pad")
+            mode = Mode::Pad;
+        else if (arg == "--sparse")
+            mode = Mode::Sparse;
+        else if (arg == "-o" && i + 1 < argc)
+            output = argv[++i];
+        else if (!arg.empty() && arg[0] == '-')
+            return usage();
+        else
+            inputs.push_back(arg);
+    }
+    if (inputs.empty())
+        return usage();
+
+    // uncart numbers the parts of a split dump .3d0 to .3d9
+    if (inputs.size() == 1 && ends_with(inputs[0], ".3d0")) {
+        const std::string base = inputs[0].substr(0, inputs[0].size() - 1);
+        for (char n = '1'; n <= '9' && access((base + n).c_str(), F_OK) == 0; ++n)
+            inputs.push_back(base + n);
+        if (output.empty())
+            output = base + 's';
+    }
+
+    const bool in_place = inputs.size() == 1 && (output.empty() || output == inputs[0]);
+    std::vector<Part> parts;
+    for (const std::string& input : inputs) {
+        if (!open_part(input, (in_place ? O_RDWR : O_RDONLY), &parts))
+            return 1;
+    }
+    if (!in_place && output.empty()) {
+        fprintf(stderr, "ncsdmerge: no output file given\n");
+        return usage();
+    }
+
+    Layout layout = {};
+    if (!read_layout(parts[0], &layout))
+        return 1;
+
+    u64 data_size = 0;
+    for (const Part& part : parts)
+        data_size += part.size;
+    if (data_size < layout.trimmed_size) {
+        fprintf(stderr, "ncsdmerge: warning: the parts hold 0x%llx bytes, the partitions end at 0x%llx\n",
+                (unsigned long long)data_size, (unsigned long long)layout.trimmed_size);
+    }
+
+    // Data after this point is padding and is not copied
+    u64 keep = data_size;
+    if (mode == Mode::Trim || mode == Mode::Sparse)
+        keep = std::min(keep, layout.trimmed_size);
+    else if (mode == Mode::Pad)
+        keep = std::min(keep, layout.full_size);
+
+    u64 final_size = keep;
+    if (mode == Mode::Pad)
+        final_size = layout.full_size;
+    else if (mode == Mode::Sparse)
+        final_size = data_size;
+
+    int out_fd = parts[0].fd;
+    if (!in_place) {
+        for (const Part& part : parts) {
+            if (same_file(part.fd, output)) {
+                fprintf(stderr, "ncsdmerge: output %s is also an input\n", output.c_str());
+                return 1;
+            }
+        }
+        out_fd = open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (out_fd < 0) {
+            error("failed to create", output);
+            return 1;
+        }
+
+        u64 offset = 0;
+        for (const Part& part : parts) {
+            const u64 len = std::min(part.size, keep - offset);
+            if (!copy_range(part, out_fd, offset, len, output))
+                return 1;
+            offset += len;
+        }
+        // A reflink rounds up to a whole block, so it can bring along source data past `keep`.
+        // Cut it off so that what --sparse extends the file with reads as zeros.
+        if (ftruncate(out_fd, (off_t)keep) < 0) {
+            error("failed to truncate", output);
+            return 1;
+        }
+    } else {
+        output = inputs[0];
+        if (mode == Mode::Sparse && data_size > keep) {
+            // Give the padding back to the file system, the file keeps its size
+            if (fallocate(out_fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, (off_t)keep, (off_t)(data_size - keep)) < 0) {
+                error("failed to punch a hole into", output);
+                return 1;
+            }
+        }
+    }
+
+    if (ftruncate(out_fd, (off_t)final_size) < 0 || fsync(out_fd) < 0) {
+        error("failed to finish", output);
+        return 1;
+    }
+
+    printf("%s: 0x%llx bytes (%llu MiB data, %s)\n", output.c_str(), (unsigned long long)final_size,
+           (unsigned long long)(keep >> 20), in_place ? "in place" : copy_method);
+
+    if (!in_place)
+        close(out_fd);
+    for (const Part& part : parts)
+        close(part.fd);
+    return 0;
+}
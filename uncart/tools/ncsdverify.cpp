@@ -0,0 +1,438 @@
+// ncsdverify - checks a dump against the SHA-256 hashes in its NCSD and NCCH headers.
+//
+// Checked for every NCCH partition: the exheader, logo, ExeFS header and files, the RomFS
+// header and every block of the RomFS hash tree (IVFC levels 1 to 3). The hashes cover the
+// decrypted contents, so partitions that are still encrypted, as uncart writes them, are skipped.
+//
+// The image is mapped into memory and the regions are split into tasks, which a pool of threads
+// hashes in parallel. Idle threads take work from the others, so a large RomFS level does not
+// leave the rest of the pool waiting.
+//
+// Usage: ncsdverify [-j THREADS] [--portable] IMAGE
+//
+//   -j          Number of threads, all CPUs by default.
+//   --portable  Do not use the SHA instructions of the CPU.
+
+#include "headers.h"
+#include "sha256.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(NCSD_HEADER) == 0x200, "NCSD_HEADER layout mismatch");
+static_assert(sizeof(NCCH_HEADER) == 0x200, "NCCH_HEADER layout mismatch");
+
+// Bytes hashed by one task, small enough to keep all threads busy until the end
+static constexpr u64 TaskSize = 4 * 1024 * 1024;
+
+/// One region to check, either hashed as a whole or as blocks with one hash each (IVFC levels).
+struct Check {
+    std::string name;
+    const u8* data = nullptr;
+    u64 size = 0;
+    u64 block_size = 0;       // 0: the region has one hash
+    const u8* hashes = nullptr;
+    const char* skipped = nullptr;
+    bool missing = false;     // The region or its hashes are outside of the image
+
+    std::atomic<u64> bad_blocks{0};
+    std::atomic<u64> first_bad{~0ull};
+
+    u64 Blocks() const {
+        return block_size ? (size + block_size - 1) / block_size : 1;
+    }
+};
+
+struct Task {
+    Check* check;
+    u64 first_block;
+    u64 end_block;
+};
+
+struct Image {
+    const u8* data;
+    u64 size;
+
+    bool Contains(const u8* ptr, u64 len) const {
+        return ptr >= data && (u64)(ptr - data) <= size && len <= size - (u64)(ptr - data);
+    }
+};
+
+static u32 Read32(const u8* bytes) {
+    return bytes[0] | (u32)bytes[1] << 8 | (u32)bytes[2] << 16 | (u32)bytes[3] << 24;
+}
+
+static u64 Read64(const u8* bytes) {
+    return Read32(bytes) | (u64)Read32(bytes + 4) << 32;
+}
+
+static u64 AlignUp(u64 value, u64 align) {
+    return (value + align - 1) / align * align;
+}
+
+static void RunTask(const Task& task, std::vector<u8>* block_buffer) {
+    Check& check = *task.check;
+    u8 digest[Sha256::DigestSize];
+
+    for (u64 block = task.first_block; block < task.end_block; ++block) {
+        const u8* data = check.data;
+        u64 size = check.size;
+        if (check.block_size) {
+            data += block * check.block_size;
+            size = std::min(check.block_size, check.size - block * check.block_size);
+            if (size < check.block_size) {
+                // The last block is hashed zero-padded to the full block size
+                block_buffer->assign(check.block_size, 0);
+                memcpy(block_buffer->data(), data, size);
+                data = block_buffer->data();
+                size = check.block_size;
+            }
+        }
+
+        Sha256::Hash(data, size, digest);
+        if (memcmp(digest, check.hashes + block * Sha256::DigestSize, Sha256::DigestSize)) {
+            check.bad_blocks++;
+            u64 first = check.first_bad.load();
+            while (block < first && !check.first_bad.compare_exchange_weak(first, block)) {
+            }
+        }
+    }
+}
+
+/// Runs tasks on a fixed set of threads. Each thread works off its own queue from the back and
+/// steals from the front of the other queues when its own one runs dry.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned num_threads) : queues(num_threads) {}
+
+    void Add(const Task& task) {
+        Queue& queue = queues[next_queue++ % queues.size()];
+        queue.tasks.push_back(task);
+    }
+
+    void Run() {
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < queues.size(); ++i)
+            threads.emplace_back(&WorkStealingPool::Work, this, i);
+        Work(0);
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool Pop(size_t index, Task* task) {
+        Queue& own = queues[index];
+        {
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                *task = own.tasks.back();
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < queues.size(); ++i) {
+            Queue& victim = queues[(index + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                *task = victim.tasks.front();
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Work(size_t index) {
+        std::vector<u8> block_buffer;
+        Task task;
+        // No task adds new ones, so all queues being empty means the work is done
+        while (Pop(index, &task))
+            RunTask(task, &block_buffer);
+    }
+
+    std::deque<Queue> queues;
+    size_t next_queue = 0;
+};
+
+class Verifier {
+public:
+    explicit Verifier(const Image& image) : image(image) {}
+
+    void AddNcsd() {
+        const NCSD_HEADER* ncsd = (const NCSD_HEADER*)image.data;
+        const u64 media_unit = 0x200ull << std::min<u8>(ncsd->partition_flags[MEDIA_UNIT_SIZE], 22);
+
+        for (int i = 0; i < 8; ++i) {
+            const partition_offsetsize& partition = ncsd->offsetsize_table[i];
+            if (partition.size == 0)
+                continue;
+
+            const std::string name = "partition " + std::to_string(i);
+            const u8* ncch = image.data + partition.offset * media_unit;
+            const u8* exheader = AddNcch(name, ncch, partition.size * media_unit);
+
+            // The card header repeats the exheader hash of the first partition
+            static const u8 zero[Sha256::DigestSize] = {};
+            if (i == 0 && exheader && memcmp(ncsd->exheader_hash, zero, sizeof(zero)))
+                Add(name + " exheader (NCSD hash)", exheader, 0x400, ncsd->exheader_hash);
+        }
+    }
+
+    void Run(unsigned num_threads) {
+        WorkStealingPool pool(num_threads);
+        for (Check& check : checks) {
+            if (check.skipped || check.missing)
+                continue;
+            const u64 blocks = check.Blocks();
+            const u64 step = check.block_size ? std::max<u64>(1, TaskSize / check.block_size) : 1;
+            for (u64 block = 0; block < blocks; block += step)
+                pool.Add({ &check, block, std::min(blocks, block + step) });
+            hashed_bytes += check.block_size ? blocks * check.block_size : check.size;
+        }
+        pool.Run();
+    }
+
+    /// Prints one line per check, returns whether everything that could be checked is fine.
+    bool Report() const {
+        bool good = true;
+        for (const Check& check : checks) {
+            printf("%-40s ", check.name.c_str());
+            if (check.skipped) {
+                printf("SKIPPED (%s)\n", check.skipped);
+            } else if (check.missing) {
+                printf("MISSING (outside of the image)\n");
+                good = false;
+            } else if (check.bad_blocks == 0) {
+                if (check.block_size)
+                    printf("OK (%llu blocks)\n", (unsigned long long)check.Blocks());
+                else
+                    printf("OK\n");
+            } else {
+                if (check.block_size) {
+                    printf("BAD (%llu of %llu blocks, first at image offset 0x%llx)\n",
+                           (unsigned long long)check.bad_blocks.load(), (unsigned long long)check.Blocks(),
+                           (unsigned long long)(check.data - image.data + check.first_bad * check.block_size));
+                } else {
+                    printf("BAD\n");
+                }
+                good = false;
+            }
+        }
+        return good;
+    }
+
+    u64 HashedBytes() const {
+        return hashed_bytes;
+    }
+
+private:
+    Check& Add(const std::string& name, const u8* data, u64 size, const u8* hashes, u64 block_size = 0) {
+        checks.emplace_back();
+        Check& check = checks.back();
+        check.name = name;
+        check.data = data;
+        check.size = size;
+        check.hashes = hashes;
+        check.block_size = block_size;
+        const u64 hashes_size = check.Blocks() * Sha256::DigestSize;
+        check.missing = !image.Contains(data, size) || !image.Contains(hashes, hashes_size);
+        return check;
+    }
+
+    void Skip(const std::string& name, const char* reason) {
+        checks.emplace_back();
+        checks.back().name = name;
+        checks.back().skipped = reason;
+    }
+
+    /// Queues the checks of one NCCH, returns its exheader if it has one.
+    const u8* AddNcch(const std::string& name, const u8* ncch, u64 size) {
+        if (!image.Contains(ncch, sizeof(NCCH_HEADER))) {
+            Add(name + " header", ncch, sizeof(NCCH_HEADER), ncch).missing = true;
+            return nullptr;
+        }
+
+        const NCCH_HEADER* header = (const NCCH_HEADER*)ncch;
+        if (strncmp((const char*)header->magic, "NCCH", 4)) {
+            Skip(name, "no NCCH magic");
+            return nullptr;
+        }
+
+        const u8 crypto_flags = header->flags[7];
+        if (!(crypto_flags & 0x4)) {
+            Skip(name, "encrypted");
+            return nullptr;
+        }
+
+        const u64 media_unit = 0x200ull << std::min<u8>(header->flags[6], 22);
+        const u8* const end = ncch + size;
+
+        const u8* exheader = nullptr;
+        if (Read32(header->extended_header_size)) {
+            // The hash covers the exheader proper, not the access descriptor after it
+            exheader = ncch + sizeof(NCCH_HEADER);
+            Add(name + " exheader", exheader, 0x400, header->extended_header_sha_256_hash);
+        }
+
+        if (Read32(header->logo_region_size)) {
+            Add(name + " logo", ncch + Read32(header->logo_region_offset) * media_unit,
+                Read32(header->logo_region_size) * media_unit, header->logo_sha_256_hash);
+        }
+
+        if (Read32(header->exefs_size))
+            AddExefs(name, ncch + Read32(header->exefs_offset) * media_unit,
+                     Read32(header->exefs_hash_size) * media_unit, header->exefs_sha_256_hash);
+
+        if (Read32(header->romfs_size))
+            AddRomfs(name, ncch + Read32(header->romfs_offset) * media_unit,
+                     Read32(header->romfs_hash_size) * media_unit, header->romfs_sha_256_hash, end);
+
+        return exheader;
+    }
+
+    void AddExefs(const std::string& name, const u8* exefs, u64 hash_size, const u8* hash) {
+        if (Add(name + " exefs header", exefs, hash_size, hash).missing)
+            return;
+
+        // Up to 10 files, their hashes are stored in reverse order at the end of the header
+        for (int i = 0; i < 10; ++i) {
+            const u8* entry = exefs + i * 0x10;
+            if (entry[0] == 0)
+                continue;
+            const std::string file(reinterpret_cast<const char*>(entry), strnlen((const char*)entry, 8));
+            Add(name + " exefs " + file, exefs + 0x200 + Read32(entry + 8), Read32(entry + 12),
+                exefs + 0x200 - (i + 1) * Sha256::DigestSize);
+        }
+    }
+
+    void AddRomfs(const std::string& name, const u8* romfs, u64 hash_size, const u8* hash, const u8* ncch_end) {
+        if (Add(name + " romfs header", romfs, hash_size, hash).missing)
+            return;
+
+        if (!image.Contains(romfs, 0x60) || memcmp(romfs, "IVFC", 4) || Read32(romfs + 4) != 0x10000) {
+            Skip(name + " romfs", "no IVFC header");
+            return;
+        }
+
+        // Level 3 holds the data and follows the master hash, levels 1 and 2 follow level 3.
+        // The master hash covers level 1, level 1 covers level 2 and level 2 covers level 3.
+        struct Level {
+            u64 size;
+            u64 block_size;
+            u64 offset;
+        } levels[3];
+        for (int i = 0; i < 3; ++i) {
+            const u8* info = romfs + 0x0C + i * 0x18;
+            const u32 block_shift = Read32(info + 0x10);
+            if (block_shift < 6 || block_shift > 24) {
+                Skip(name + " romfs", "bad IVFC block size");
+                return;
+            }
+            levels[i].size = Read64(info + 0x08);
+            levels[i].block_size = 1ull << block_shift;
+        }
+        const u64 master_hash_size = Read32(romfs + 0x08);
+        levels[2].offset = AlignUp(0x60 + master_hash_size, levels[2].block_size);
+        levels[0].offset = AlignUp(levels[2].offset + levels[2].size, levels[0].block_size);
+        levels[1].offset = AlignUp(levels[0].offset + levels[0].size, levels[1].block_size);
+
+        const u8* parent_hashes = romfs + 0x60;
+        for (int i = 0; i < 3; ++i) {
+            const u8* data = romfs + levels[i].offset;
+            Check& check = Add(name + " romfs level " + std::to_string(i + 1), data, levels[i].size,
+                               parent_hashes, levels[i].block_size);
+            // Levels must also stay within their own NCCH
+            if (!check.missing && (data + levels[i].size > ncch_end))
+                check.missing = true;
+            parent_hashes = data;
+        }
+    }
+
+    const Image& image;
+    std::deque<Check> checks;
+    u64 hashed_bytes = 0;
+};
+
+static int Usage() {
+    fprintf(stderr, "Usage: ncsdverify [-j THREADS] [--portable] IMAGE\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    unsigned num_threads = std::max(1u, std::thread::hardware_concurrency());
+    const char* path = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc)
+            num_threads = std::max(1, atoi(argv[++i]));
+        else if (arg == "--portable")
+            Sha256::UsePortable();
+        else if (arg[0] == '-' || path)
+            return Usage();
+        else
+            path = argv[i];
+    }
+    if (!path)
+        return Usage();
+
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        fprintf(stderr, "ncsdverify: failed to open %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    if ((u64)st.st_size < sizeof(NCSD_HEADER)) {
+        fprintf(stderr, "ncsdverify: %s is too small for an NCSD image\n", path);
+        return 1;
+    }
+
+    void* const map = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "ncsdverify: failed to map %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    madvise(map, (size_t)st.st_size, MADV_WILLNEED);
+
+    const Image image = { (const u8*)map, (u64)st.st_size };
+    if (memcmp(((const NCSD_HEADER*)image.data)->magic, "NCSD", 4)) {
+        fprintf(stderr, "ncsdverify: NCSD magic not found in %s\n", path);
+        return 1;
+    }
+
+    Verifier verifier(image);
+    verifier.AddNcsd();
+
+    const auto start = std::chrono::steady_clock::now();
+    verifier.Run(num_threads);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const bool good = verifier.Report();
+    printf("%llu MiB hashed in %.2f s (%.0f MiB/s, %u threads, %s)\n",
+           (unsigned long long)(verifier.HashedBytes() >> 20), seconds,
+           (double)verifier.HashedBytes() / (1024 * 1024) / std::max(seconds, 1e-9), num_threads,
+           Sha256::Backend());
+
+    munmap(map, (size_t)st.st_size);
+    close(fd);
+    return good ? 0 : 1;
+}
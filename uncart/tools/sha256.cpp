@@ -0,0 +1,206 @@
+#include "sha256.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define SHA256_X86 1
+#elif defined(__aarch64__) && defined(__linux__)
+#include <arm_neon.h>
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#define SHA256_ARM 1
+#endif
+
+namespace Sha256 {
+
+alignas(16) static const u32 K[64] = {
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+static const u32 InitialState[8] = {
+    0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19,
+};
+
+/// Runs the compression function over count 64 byte blocks.
+using CompressFunc = void (*)(u32 state[8], const u8* data, size_t count);
+
+static inline u32 Rotr(u32 x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+static void CompressPortable(u32 state[8], const u8* data, size_t count) {
+    for (; count != 0; --count, data += 64) {
+        u32 w[64];
+        for (int i = 0; i < 16; ++i)
+            w[i] = (u32)data[i * 4] << 24 | (u32)data[i * 4 + 1] << 16 | (u32)data[i * 4 + 2] << 8 | data[i * 4 + 3];
+        for (int i = 16; i < 64; ++i) {
+            const u32 s0 = Rotr(w[i - 15], 7) ^ Rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const u32 s1 = Rotr(w[i - 2], 17) ^ Rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        u32 a = state[0], b = state[1], c = state[2], d = state[3];
+        u32 e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i) {
+            const u32 t1 = h + (Rotr(e, 6) ^ Rotr(e, 11) ^ Rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+            const u32 t2 = (Rotr(a, 2) ^ Rotr(a, 13) ^ Rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+}
+
+#if SHA256_X86
+// SHA extensions: SHA256RNDS2 does two rounds on the state kept as ABEF/CDGH, SHA256MSG1/2 compute
+// the message schedule four words at a time.
+__attribute__((target("sha,sse4.1")))
+static void CompressShaNi(u32 state[8], const u8* data, size_t count) {
+    const __m128i byteswap = _mm_set_epi64x(0x0C0D0E0F08090A0BULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[0]), 0xB1); // CDAB
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[4]), 0x1B); // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8); // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0); // CDGH
+
+    for (; count != 0; --count, data += 64) {
+        const __m128i abef = state0;
+        const __m128i cdgh = state1;
+        __m128i msg[4];
+
+        for (int g = 0; g < 16; ++g) {
+            if (g < 4)
+                msg[g] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + g * 16)), byteswap);
+
+            __m128i wk = _mm_add_epi32(msg[g % 4], _mm_load_si128((const __m128i*)&K[g * 4]));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, wk);
+            if (g >= 3 && g <= 14) {
+                __m128i& next = msg[(g + 1) % 4];
+                next = _mm_add_epi32(next, _mm_alignr_epi8(msg[g % 4], msg[(g + 3) % 4], 4));
+                next = _mm_sha256msg2_epu32(next, msg[g % 4]);
+            }
+            wk = _mm_shuffle_epi32(wk, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, wk);
+            if (g >= 1 && g <= 12)
+                msg[(g + 3) % 4] = _mm_sha256msg1_epu32(msg[(g + 3) % 4], msg[g % 4]);
+        }
+
+        state0 = _mm_add_epi32(state0, abef);
+        state1 = _mm_add_epi32(state1, cdgh);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B); // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1); // DCHG
+    _mm_storeu_si128((__m128i*)&state[0], _mm_blend_epi16(tmp, state1, 0xF0)); // DCBA
+    _mm_storeu_si128((__m128i*)&state[4], _mm_alignr_epi8(state1, tmp, 8)); // HGFE
+}
+
+static bool HasShaNi() {
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_SSE4_1))
+        return false;
+    return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_SHA);
+}
+#endif
+
+#if SHA256_ARM
+// ARMv8 crypto extensions: SHA256H/SHA256H2 do four rounds, SHA256SU0/SU1 the message schedule.
+__attribute__((target("+crypto")))
+static void CompressArmv8(u32 state[8], const u8* data, size_t count) {
+    uint32x4_t state0 = vld1q_u32(&state[0]);
+    uint32x4_t state1 = vld1q_u32(&state[4]);
+
+    for (; count != 0; --count, data += 64) {
+        const uint32x4_t abcd = state0;
+        const uint32x4_t efgh = state1;
+        uint32x4_t msg[4];
+        for (int i = 0; i < 4; ++i)
+            msg[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + i * 16)));
+
+        for (int g = 0; g < 16; ++g) {
+            const uint32x4_t wk = vaddq_u32(msg[g % 4], vld1q_u32(&K[g * 4]));
+            if (g < 12)
+                msg[g % 4] = vsha256su0q_u32(msg[g % 4], msg[(g + 1) % 4]);
+            const uint32x4_t prev = state0;
+            state0 = vsha256hq_u32(state0, state1, wk);
+            state1 = vsha256h2q_u32(state1, prev, wk);
+            if (g < 12)
+                msg[g % 4] = vsha256su1q_u32(msg[g % 4], msg[(g + 2) % 4], msg[(g + 3) % 4]);
+        }
+
+        state0 = vaddq_u32(state0, abcd);
+        state1 = vaddq_u32(state1, efgh);
+    }
+
+    vst1q_u32(&state[0], state0);
+    vst1q_u32(&state[4], state1);
+}
+#endif
+
+static CompressFunc compress = CompressPortable;
+static const char* backend = "portable";
+
+namespace {
+struct SelectBackend {
+    SelectBackend() {
+#if SHA256_X86
+        if (HasShaNi()) {
+            compress = CompressShaNi;
+            backend = "SHA-NI";
+        }
+#elif SHA256_ARM
+        if (getauxval(AT_HWCAP) & HWCAP_SHA2) {
+            compress = CompressArmv8;
+            backend = "ARMv8 SHA2";
+        }
+#endif
+    }
+} select_backend;
+} // namespace
+
+void Hash(const void* data, size_t size, u8* digest) {
+    u32 state[8];
+    memcpy(state, InitialState, sizeof(state));
+
+    const u8* bytes = (const u8*)data;
+    compress(state, bytes, size / 64);
+
+    // Padding: 0x80, zeroes, then the length in bits as a big endian 64 bit number
+    u8 tail[128] = {};
+    const size_t rest = size % 64;
+    memcpy(tail, bytes + size - rest, rest);
+    tail[rest] = 0x80;
+    const size_t tail_size = (rest < 56) ? 64 : 128;
+    const u64 bits = (u64)size * 8;
+    for (int i = 0; i < 8; ++i)
+        tail[tail_size - 1 - i] = (u8)(bits >> (i * 8));
+    compress(state, tail, tail_size / 64);
+
+    for (int i = 0; i < 8; ++i) {
+        digest[i * 4 + 0] = (u8)(state[i] >> 24);
+        digest[i * 4 + 1] = (u8)(state[i] >> 16);
+        digest[i * 4 + 2] = (u8)(state[i] >> 8);
+        digest[i * 4 + 3] = (u8)state[i];
+    }
+}
+
+const char* Backend() {
+    return backend;
+}
+
+void UsePortable() {
+    compress = CompressPortable;
+    backend = "portable";
+}
+
+} // namespace
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+
+#include "common.h"
+
+namespace Sha256 {
+
+constexpr size_t DigestSize = 32;
+
+/// Hashes size bytes at data into digest. Uses the SHA instructions of the CPU when present.
+void Hash(const void* data, size_t size, u8* digest);
+
+/// Name of the implementation Hash() uses.
+const char* Backend();
+
+/// Makes Hash() use the portable implementation, for comparing against the CPU extensions.
+void UsePortable();
+
+} // namespace